@@ -0,0 +1,177 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../include/backing_store.h"
+
+/**
+  * Benchmark of page fault throughput for each backing store mode. A backing store of the size
+  * given on the command line, in MB, is written out once, and then the same sequence of random
+  * page faults is served by each mode into a small set of frames, reading one value from each
+  * page as print_for_address would. Every mode is run once untimed first so that they all see the
+  * backing store already in the page cache, which measures the cost of the access path itself
+  * rather than of the disk
+  */
+
+#define DEFAULT_MB     2048
+#define PAGE_BYTES     256
+#define NUMBER_FRAMES  128
+#define FAULTS         (1 << 22)
+
+static const char *modes[] = { "stdio", "mmap", "zero-copy" };
+
+/**
+  * Returns the current monotonic time in nanoseconds
+  */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+  * Returns the next value of a xorshift generator, so that every mode sees the same sequence
+  */
+static uint64_t next_random(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/**
+  * Writes a backing store of the given size, unless one of that size is already there
+  * @param path  the path of the backing store
+  * @param bytes the size of the backing store
+  * @return an indication of whether an error occurred
+  */
+static status_t create_store(const char *path, size_t bytes)
+{
+	FILE *file;
+	if ((file = fopen(path, "r")) != NULL)
+	{
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fclose(file);
+		if (size >= 0 && (size_t) size == bytes)
+		{
+			return SUCCESS;
+		}
+	}
+
+	if ((file = fopen(path, "w")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+
+	int8_t block[1 << 16];
+	uint64_t state = 88172645463325252ull;
+	size_t written;
+	for (written = 0; written < bytes; written += sizeof block)
+	{
+		size_t i;
+		for (i = 0; i < sizeof block; i++)
+		{
+			block[i] = next_random(&state);
+		}
+		fwrite(block, sizeof block, 1, file);
+	}
+
+	fclose(file);
+	return SUCCESS;
+}
+
+/**
+  * Serves FAULTS random page faults from the backing store in the given mode, returning the ns per
+  * fault, or a negative number on an error
+  */
+static double bench_mode(const char *path, backing_mode_t mode, uint64_t pages, int8_t *frames, long *checksum)
+{
+	backing_store_t store;
+	if (backing_store_open(&store, path, PAGE_BYTES, mode) != SUCCESS)
+	{
+		return -1;
+	}
+
+	uint64_t state = 2463534242ull;
+	long sum = 0;
+	uint64_t start = now_ns();
+	size_t fault;
+	for (fault = 0; fault < FAULTS; fault++)
+	{
+		uint64_t random = next_random(&state);
+		uint64_t page = random % pages;
+		int8_t *contents = backing_store_page(&store, page);
+		if (contents == NULL)
+		{
+			contents = frames + (fault % NUMBER_FRAMES) * PAGE_BYTES;
+			if (backing_store_read(&store, page, contents) != SUCCESS)
+			{
+				backing_store_close(&store);
+				return -1;
+			}
+		}
+		sum += contents[(random >> 40) % PAGE_BYTES];
+	}
+	uint64_t elapsed = now_ns() - start;
+
+	backing_store_close(&store);
+	*checksum = sum;
+	return (double) elapsed / FAULTS;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t mb = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_MB;
+	const char *path = argc > 2 ? argv[2] : "build/backing_bench.bin";
+	if (mb == 0)
+	{
+		fprintf(stderr, "Usage: %s [MB] [path]\n", argv[0]);
+		return ARGS_ERROR;
+	}
+
+	size_t bytes = mb << 20;
+	if (create_store(path, bytes) != SUCCESS)
+	{
+		fprintf(stderr, "Could not create %s\n", path);
+		return OPEN_ERROR;
+	}
+
+	int8_t *frames = malloc(NUMBER_FRAMES * PAGE_BYTES);
+	if (frames == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	fprintf(stdout, "%zu MB backing store, %d random faults of %d bytes\n", mb, FAULTS, PAGE_BYTES);
+	fprintf(stdout, "%10s %14s %14s %10s\n", "mode", "ns/fault", "faults/s", "speedup");
+
+	double stdio = 0;
+	size_t i;
+	for (i = 0; i < sizeof modes / sizeof *modes; i++)
+	{
+		backing_mode_t mode;
+		backing_mode_find(modes[i], &mode);
+		long checksum;
+		bench_mode(path, mode, bytes / PAGE_BYTES, frames, &checksum);
+		double ns = bench_mode(path, mode, bytes / PAGE_BYTES, frames, &checksum);
+		if (ns < 0)
+		{
+			fprintf(stderr, "Could not read %s in %s mode\n", path, modes[i]);
+			free(frames);
+			return READ_ERROR;
+		}
+
+		if (i == 0)
+		{
+			stdio = ns;
+		}
+		fprintf(stdout, "%10s %14.1f %14.0f %9.1fx\n", modes[i], ns, 1e9 / ns, stdio / ns);
+	}
+
+	free(frames);
+	return 0;
+}
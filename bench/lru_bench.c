@@ -0,0 +1,202 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../include/lru_queue.h"
+
+/**
+  * Microbenchmark comparing the pooled, index-linked lru_queue_t against the original malloc'd
+  * doubly linked list, whose update walked the list backwards to find the matching data value.
+  * Each round mimics the simulator: most operations touch a random resident entry (as
+  * print_for_address does on every reference) and the rest evict the least recently used entry and
+  * insert it again (as load_if_necessary does on a page fault)
+  */
+
+#define FAULT_EVERY 8
+
+static const int sizes[] = { 128, 4096, 65536 };
+
+typedef struct list_node_t
+{
+	int data;
+	struct list_node_t *next;
+	struct list_node_t *prev;
+} list_node_t;
+
+typedef struct
+{
+	list_node_t *head;
+	list_node_t *tail;
+} list_queue_t;
+
+static void list_queue_initialize(list_queue_t *queue)
+{
+	queue->head = malloc(sizeof *queue->head);
+	queue->head->next = NULL;
+	queue->head->prev = NULL;
+	queue->tail = queue->head;
+}
+
+static void list_queue_insert_new(list_queue_t *queue, int data)
+{
+	list_node_t *node = malloc(sizeof *node);
+	node->data = data;
+	node->next = NULL;
+	node->prev = queue->head;
+	queue->head->next = node;
+	queue->head = node;
+}
+
+static void list_queue_update_existing(list_queue_t *queue, int data)
+{
+	if (queue->head->data == data)
+	{
+		return;
+	}
+
+	list_node_t *curr = queue->head->prev;
+	while (curr->data != data)
+	{
+		curr = curr->prev;
+	}
+
+	curr->prev->next = curr->next;
+	curr->next->prev = curr->prev;
+	curr->prev = queue->head;
+	queue->head->next = curr;
+	curr->next = NULL;
+	queue->head = curr;
+}
+
+static int list_queue_poll(list_queue_t *queue)
+{
+	list_node_t *node = queue->tail;
+	queue->tail = node->next;
+	queue->tail->prev = NULL;
+	free(node);
+	return queue->tail->data;
+}
+
+static void list_queue_uninitialize(list_queue_t *queue)
+{
+	while (queue->head != queue->tail)
+	{
+		list_node_t *node = queue->tail;
+		queue->tail = node->next;
+		free(node);
+	}
+	free(queue->head);
+}
+
+/**
+  * Returns the current monotonic time in nanoseconds
+  */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+  * Returns the next value of a xorshift generator, so that both queues see the same sequence
+  */
+static uint32_t next_random(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+/**
+  * Runs the given number of operations against the pooled queue, returning the ns per operation
+  */
+static double bench_pool(int size, size_t ops)
+{
+	lru_queue_t queue;
+	if (lru_queue_initialize(&queue, size) != SUCCESS)
+	{
+		return -1;
+	}
+	int i;
+	for (i = 0; i < size; i++)
+	{
+		lru_queue_insert_new(&queue, i);
+	}
+
+	uint32_t state = 2463534242u;
+	uint64_t start = now_ns();
+	size_t op;
+	for (op = 0; op < ops; op++)
+	{
+		if (op % FAULT_EVERY == 0)
+		{
+			lru_queue_insert_new(&queue, lru_queue_poll(&queue));
+		}
+		else
+		{
+			lru_queue_update_existing(&queue, next_random(&state) % size);
+		}
+	}
+	uint64_t elapsed = now_ns() - start;
+
+	lru_queue_uninitialize(&queue);
+	return (double) elapsed / ops;
+}
+
+/**
+  * Runs the given number of operations against the original list queue, returning the ns per
+  * operation
+  */
+static double bench_list(int size, size_t ops)
+{
+	list_queue_t queue;
+	list_queue_initialize(&queue);
+	int i;
+	for (i = 0; i < size; i++)
+	{
+		list_queue_insert_new(&queue, i);
+	}
+
+	uint32_t state = 2463534242u;
+	uint64_t start = now_ns();
+	size_t op;
+	for (op = 0; op < ops; op++)
+	{
+		if (op % FAULT_EVERY == 0)
+		{
+			list_queue_insert_new(&queue, list_queue_poll(&queue));
+		}
+		else
+		{
+			list_queue_update_existing(&queue, next_random(&state) % size);
+		}
+	}
+	uint64_t elapsed = now_ns() - start;
+
+	list_queue_uninitialize(&queue);
+	return (double) elapsed / ops;
+}
+
+int main(void)
+{
+	fprintf(stdout, "%8s %14s %14s %10s\n", "entries", "list ns/op", "pool ns/op", "speedup");
+
+	size_t i;
+	for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+	{
+		//the list walk is O(entries), so scale its operation count down to keep the run short
+		size_t list_ops = (1 << 24) / sizes[i];
+		if (list_ops < 4096)
+		{
+			list_ops = 4096;
+		}
+		double list = bench_list(sizes[i], list_ops);
+		double pool = bench_pool(sizes[i], 1 << 24);
+		fprintf(stdout, "%8d %14.1f %14.1f %9.1fx\n", sizes[i], list, pool, list / pool);
+	}
+
+	return 0;
+}
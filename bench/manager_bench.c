@@ -0,0 +1,156 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+  * Benchmark of the whole simulator. manager is run with --stats-only on every trace given for
+  * every geometry of a fixed matrix, and the wall time of each run, its throughput and the peak
+  * resident set size of the process are reported. The traces are meant to be written by trace_gen
+  * with 32 bit addresses, which every geometry below is sized for
+  */
+
+#define MAX_ARGUMENTS 16
+
+/**
+  * The geometries run, each a name and the options passed to manager for it
+  */
+typedef struct
+{
+	const char *name;
+	const char *arguments[MAX_ARGUMENTS];
+} geometry_t;
+
+static const geometry_t geometries[] =
+{
+	{ "4K/1024/lru",        { "-a", "32", "-p", "4096", "-f", "1024", "-t", "64", NULL } },
+	{ "4K/4096/lru",        { "-a", "32", "-p", "4096", "-f", "4096", "-t", "64", NULL } },
+	{ "4K/1024/clock",      { "-a", "32", "-p", "4096", "-f", "1024", "-t", "64", "-r", "clock", NULL } },
+	{ "4K/1024/arc",        { "-a", "32", "-p", "4096", "-f", "1024", "-t", "64", "-r", "arc", NULL } },
+	{ "4K/1024/4way",       { "-a", "32", "-p", "4096", "-f", "1024", "-t", "64", "--tlb-ways", "4", NULL } },
+	{ "4K/1024/radix",      { "-a", "32", "-p", "4096", "-f", "1024", "-t", "64", "--page-table", "radix", NULL } },
+	{ "4K/1024/hashed",     { "-a", "32", "-p", "4096", "-f", "1024", "-t", "64", "--page-table", "hashed", NULL } },
+	{ "256/16384/lru",      { "-a", "32", "-p", "256", "-f", "16384", "-t", "64", NULL } }
+};
+
+#define NUMBER_GEOMETRIES (sizeof geometries / sizeof *geometries)
+
+#define COUNT_PREFIX "Number of Translated Addresses = "
+
+/**
+  * Returns the current monotonic time in nanoseconds
+  */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+  * Runs manager once on a trace, returning the references it translated or 0 if it failed, with
+  * the wall time and the peak resident set size in KB
+  */
+static size_t run(const char *manager, const char *store, const char *trace, const geometry_t *geometry, uint64_t *elapsed, long *peak_kb)
+{
+	const char *argv[MAX_ARGUMENTS + 5];
+	size_t argc = 0;
+	argv[argc++] = manager;
+	argv[argc++] = "--stats-only";
+	size_t i;
+	for (i = 0; geometry->arguments[i] != NULL; i++)
+	{
+		argv[argc++] = geometry->arguments[i];
+	}
+	argv[argc++] = trace;
+	argv[argc++] = store;
+	argv[argc] = NULL;
+
+	int fds[2];
+	if (pipe(fds) < 0)
+	{
+		return 0;
+	}
+
+	uint64_t start = now_ns();
+	pid_t pid = fork();
+	if (pid < 0)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return 0;
+	}
+	if (pid == 0)
+	{
+		dup2(fds[1], STDOUT_FILENO);
+		close(fds[0]);
+		close(fds[1]);
+		execv(manager, (char **) argv);
+		_exit(127);
+	}
+
+	//the statistics are only a few lines, so they are read once manager has exited
+	close(fds[1]);
+	FILE *fin = fdopen(fds[0], "r");
+	size_t count = 0;
+	char line[256];
+	while (fgets(line, sizeof line, fin) != NULL)
+	{
+		if (strncmp(line, COUNT_PREFIX, strlen(COUNT_PREFIX)) == 0)
+		{
+			count = strtoull(line + strlen(COUNT_PREFIX), NULL, 10);
+		}
+	}
+	fclose(fin);
+
+	int status;
+	struct rusage usage;
+	if (wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	{
+		return 0;
+	}
+	*elapsed = now_ns() - start;
+	*peak_kb = usage.ru_maxrss;
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4)
+	{
+		fprintf(stderr, "Usage: %s <manager> <backing store> <trace>...\n", argv[0]);
+		return 1;
+	}
+
+	fprintf(stdout, "%-28s %-16s %12s %10s %16s %10s\n", "trace", "geometry", "references", "ns/ref", "addresses/s", "peak RSS");
+	int failed = 0;
+	int t;
+	for (t = 3; t < argc; t++)
+	{
+		const char *name = strrchr(argv[t], '/') == NULL ? argv[t] : strrchr(argv[t], '/') + 1;
+		size_t g;
+		for (g = 0; g < NUMBER_GEOMETRIES; g++)
+		{
+			uint64_t elapsed;
+			long peak_kb;
+			size_t count = run(argv[1], argv[2], argv[t], &geometries[g], &elapsed, &peak_kb);
+			if (count == 0)
+			{
+				fprintf(stdout, "%-28s %-16s %12s\n", name, geometries[g].name, "failed");
+				failed = 1;
+				continue;
+			}
+
+			double ns = (double) elapsed / count;
+			fprintf(stdout, "%-28s %-16s %12zu %10.1f %16.0f %7ld KB\n", name, geometries[g].name, count, ns, 1e9 / ns, peak_kb);
+			fflush(stdout);
+		}
+	}
+
+	return failed;
+}
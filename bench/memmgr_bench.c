@@ -0,0 +1,137 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../include/memmgr.h"
+
+/**
+  * Benchmark of the library's batched translation. A trace of random references, all but one in a
+  * hundred of them to a hot set of pages which the TLB holds, and a third of them writes, is
+  * translated in process by a manager given batches of a single reference, as a caller translating
+  * address by address would, and then of ever more references, each time from a cold memory.
+  * Every batch size has to come to the same statistics
+  */
+
+#define DEFAULT_REFERENCES 10000000
+
+#define ADDRESS_BITS 20
+#define PAGE_BYTES   4096
+#define FRAMES       64
+#define HOT_PAGES    16
+
+/**
+  * Returns the current monotonic time in nanoseconds
+  */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+  * Returns the next value of a xorshift generator
+  */
+static uint32_t next_random(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+/**
+  * Translates the whole trace in batches of the given size with a manager of its own, returning
+  * the ns per reference, or -1 if the manager could not be used
+  */
+static double bench_batch(options_t *options, backing_store_t *backing, const uint64_t *addresses, const uint8_t *writes, size_t references,
+	size_t batch, int8_t *values, statistics_t *statistics)
+{
+	memmgr_t *manager;
+	if (memmgr_open(&manager, options, backing, NULL, NULL) != SUCCESS)
+	{
+		return -1;
+	}
+
+	status_t error = SUCCESS;
+	uint64_t start = now_ns();
+	size_t position;
+	for (position = 0; position < references && error == SUCCESS; position += batch)
+	{
+		size_t count = references - position < batch ? references - position : batch;
+		error = memmgr_translate_batch(manager, addresses + position, writes + position, count, values + position);
+	}
+	uint64_t elapsed = now_ns() - start;
+
+	memmgr_statistics(manager, statistics);
+	memmgr_close(manager);
+	return error == SUCCESS ? (double) elapsed / references : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t references = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_REFERENCES;
+	const char *backing_file = argc > 2 ? argv[2] : "input/BACKING_STORE.bin";
+
+	options_t options;
+	options_initialize(&options);
+	options.address_bits = ADDRESS_BITS;
+	options.page_bytes = PAGE_BYTES;
+	options.number_frames = FRAMES;
+
+	backing_store_t backing;
+	if (backing_store_open(&backing, backing_file, options.page_bytes, options.backing_mode) != SUCCESS)
+	{
+		fprintf(stderr, "Could not open %s\n", backing_file);
+		return OPEN_ERROR;
+	}
+
+	uint64_t *addresses = malloc(references * sizeof *addresses);
+	uint8_t *writes = malloc(references * sizeof *writes);
+	int8_t *values = malloc(references * sizeof *values);
+	if (addresses == NULL || writes == NULL || values == NULL)
+	{
+		fprintf(stderr, "Could not allocate %zu references\n", references);
+		return ALOC_ERROR;
+	}
+	uint32_t state = 2463534242u;
+	size_t i;
+	for (i = 0; i < references; i++)
+	{
+		uint32_t random = next_random(&state);
+		uint64_t span = random % 100 == 0 ? (uint64_t) 1 << ADDRESS_BITS : HOT_PAGES * PAGE_BYTES;
+		addresses[i] = next_random(&state) % span;
+		writes[i] = random % 3 == 0;
+	}
+
+	fprintf(stdout, "%zu references\n", references);
+	fprintf(stdout, "%10s %10s %16s %10s\n", "batch", "ns/ref", "references/s", "speedup");
+
+	static const size_t batches[] = { 1, 16, 256, 4096, 65536 };
+	statistics_t expected;
+	statistics_t statistics;
+	double single = 0;
+	for (i = 0; i < sizeof batches / sizeof *batches; i++)
+	{
+		double ns = bench_batch(&options, &backing, addresses, writes, references, batches[i], values, i == 0 ? &expected : &statistics);
+		if (ns < 0)
+		{
+			fprintf(stderr, "Could not translate in batches of %zu\n", batches[i]);
+			return READ_ERROR;
+		}
+		if (i == 0)
+		{
+			single = ns;
+			statistics = expected;
+		}
+		fprintf(stdout, "%10zu %10.1f %16.0f %9.2fx%s\n", batches[i], ns, 1e9 / ns, single / ns,
+			statistics.page_faults == expected.page_faults && statistics.tlb_hits == expected.tlb_hits ? "" : " (mismatch)");
+	}
+
+	free(values);
+	free(writes);
+	free(addresses);
+	backing_store_close(&backing);
+	return 0;
+}
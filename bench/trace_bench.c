@@ -0,0 +1,193 @@
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../include/trace.h"
+
+/**
+  * Benchmark of trace ingestion. A text address file of random references, a third of them reads
+  * and a third writes, is written out once along with its binary conversion, and then each is read
+  * back in batches: the text file with the original getline and convert loop, the text file with
+  * the mapped, vectorized reader, and the binary trace
+  */
+
+#define DEFAULT_REFERENCES 10000000
+
+#define ASCII_0 48
+
+/**
+  * Returns the current monotonic time in nanoseconds
+  */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+  * Returns the next value of a xorshift generator
+  */
+static uint32_t next_random(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+/**
+  * The original conversion, one digit at a time
+  */
+static int original_convert(char *s, size_t length, uint64_t *value)
+{
+	*value = 0;
+	uint64_t power10;
+	size_t i;
+	for (i = length - 1, power10 = 1; i < SIZE_MAX; i--, power10 *= 10)
+	{
+		if (!isdigit(s[i]))
+		{
+			return -1;
+		}
+		*value += (s[i] - ASCII_0) * power10;
+	}
+
+	return 0;
+}
+
+/**
+  * Reads the text address file with the original loop, returning the ns per reference
+  */
+static double bench_original(const char *path, uint64_t *checksum)
+{
+	FILE *fin = fopen(path, "r");
+	if (fin == NULL)
+	{
+		*checksum = 0;
+		return -1;
+	}
+
+	uint64_t sum = 0;
+	size_t count = 0;
+	char *line = NULL;
+	size_t size = 0;
+	ssize_t chars_read;
+	uint64_t start = now_ns();
+	while ((chars_read = getline(&line, &size, fin)) > 0)
+	{
+		chars_read--;
+		if (chars_read > 0 && line[chars_read - 1] == ' ')
+		{
+			chars_read--;
+		}
+		uint8_t is_write = chars_read > 0 && line[chars_read - 1] == 'W';
+		if (chars_read > 0 && (is_write || line[chars_read - 1] == 'R'))
+		{
+			chars_read -= 2;
+		}
+		line[chars_read] = '\0';
+
+		uint64_t address;
+		if (chars_read > 0 && original_convert(line, chars_read, &address) == 0)
+		{
+			sum += address + is_write;
+			count++;
+		}
+	}
+	uint64_t elapsed = now_ns() - start;
+
+	free(line);
+	fclose(fin);
+	*checksum = sum;
+	return (double) elapsed / count;
+}
+
+/**
+  * Reads an address file in batches with trace_read, returning the ns per reference
+  */
+static double bench_trace(const char *path, uint64_t *checksum)
+{
+	trace_file_t fin;
+	if (trace_open(&fin, path) != SUCCESS)
+	{
+		*checksum = 0;
+		return -1;
+	}
+
+	trace_t trace;
+	trace_initialize(&trace);
+	uint64_t sum = 0;
+	size_t count = 0;
+	uint64_t start = now_ns();
+	while (trace_read(&trace, &fin, TRACE_BATCH) == SUCCESS && trace.length > 0)
+	{
+		size_t i;
+		for (i = 0; i < trace.length; i++)
+		{
+			sum += trace.addresses[i] + trace.writes[i];
+		}
+		count += trace.length;
+	}
+	uint64_t elapsed = now_ns() - start;
+
+	trace_uninitialize(&trace);
+	trace_close(&fin);
+	*checksum = sum;
+	return (double) elapsed / count;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t references = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_REFERENCES;
+	const char *text = "build/trace_bench.txt";
+	const char *binary = "build/trace_bench.bin";
+
+	FILE *fout = fopen(text, "w");
+	if (fout == NULL)
+	{
+		fprintf(stderr, "Could not create %s\n", text);
+		return OPEN_ERROR;
+	}
+	static const char *suffixes[] = { "", " R", " W" };
+	uint32_t state = 2463534242u;
+	size_t i;
+	for (i = 0; i < references; i++)
+	{
+		uint32_t random = next_random(&state);
+		fprintf(fout, "%u%s\n", random >> 8, suffixes[random % 3]);
+	}
+	fclose(fout);
+
+	trace_file_t fin;
+	trace_t trace;
+	trace_initialize(&trace);
+	if (trace_open(&fin, text) != SUCCESS || trace_read(&trace, &fin, TRACE_ALL) != SUCCESS ||
+		trace_save(&trace, binary) != SUCCESS)
+	{
+		fprintf(stderr, "Could not create %s\n", binary);
+		return WRIT_ERROR;
+	}
+	trace_uninitialize(&trace);
+	trace_close(&fin);
+
+	fprintf(stdout, "%zu references\n", references);
+	fprintf(stdout, "%14s %10s %16s %10s\n", "reader", "ns/ref", "references/s", "speedup");
+
+	uint64_t expected;
+	uint64_t checksum;
+	double original = bench_original(text, &expected);
+	fprintf(stdout, "%14s %10.1f %16.0f %9.1fx\n", "getline", original, 1e9 / original, 1.0);
+
+	double mapped = bench_trace(text, &checksum);
+	fprintf(stdout, "%14s %10.1f %16.0f %9.1fx%s\n", "mapped text", mapped, 1e9 / mapped, original / mapped,
+		checksum == expected ? "" : " (mismatch)");
+
+	double converted = bench_trace(binary, &checksum);
+	fprintf(stdout, "%14s %10.1f %16.0f %9.1fx%s\n", "binary", converted, 1e9 / converted, original / converted,
+		checksum == expected ? "" : " (mismatch)");
+
+	return 0;
+}
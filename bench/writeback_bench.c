@@ -0,0 +1,211 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../include/backing_store.h"
+#include "../include/write_back.h"
+
+/**
+  * Benchmark of page fault latency with synchronous and with asynchronous write-back. A backing
+  * store of the size given on the command line, in MB, is written out once and copied for each
+  * mode. The same sequence of random faults is then served in each mode, where the victim of every
+  * other fault is dirty and is written back before the new page is read in. The latency of each
+  * fault is the time the faulting thread spends on it, so in asynchronous mode it leaves out the
+  * writes done by the flusher thread
+  */
+
+#define DEFAULT_MB     256
+#define PAGE_BYTES     4096
+#define NUMBER_FRAMES  128
+#define FAULTS         (1 << 18)
+#define DIRTY_EVERY    2
+
+static const char *modes[] = { "sync", "async" };
+
+/**
+  * Returns the current monotonic time in nanoseconds
+  */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+  * Returns the next value of a xorshift generator, so that every mode sees the same sequence
+  */
+static uint64_t next_random(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/**
+  * Writes a backing store of the given size, unless one of that size is already there
+  * @param path  the path of the backing store
+  * @param bytes the size of the backing store
+  * @return an indication of whether an error occurred
+  */
+static status_t create_store(const char *path, size_t bytes)
+{
+	FILE *file;
+	if ((file = fopen(path, "r")) != NULL)
+	{
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fclose(file);
+		if (size >= 0 && (size_t) size == bytes)
+		{
+			return SUCCESS;
+		}
+	}
+
+	if ((file = fopen(path, "w")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+
+	int8_t block[1 << 16];
+	uint64_t state = 88172645463325252ull;
+	size_t written;
+	for (written = 0; written < bytes; written += sizeof block)
+	{
+		size_t i;
+		for (i = 0; i < sizeof block; i++)
+		{
+			block[i] = next_random(&state);
+		}
+		fwrite(block, sizeof block, 1, file);
+	}
+
+	fclose(file);
+	return SUCCESS;
+}
+
+/**
+  * Orders latencies, for qsort
+  */
+static int compare_latencies(const void *a, const void *b)
+{
+	uint64_t first = *(const uint64_t *) a;
+	uint64_t second = *(const uint64_t *) b;
+	return (first > second) - (first < second);
+}
+
+/**
+  * Serves FAULTS random faults with the given write-back mode, filling in the latency of each, and
+  * returns the total time in ns including the final drain of the queue, or 0 on an error
+  */
+static uint64_t bench_mode(const char *path, write_back_mode_t mode, uint64_t pages, int8_t *frames, uint64_t *latencies)
+{
+	backing_store_t store;
+	if (backing_store_open_copy(&store, path, NULL, PAGE_BYTES, BACKING_MMAP) != SUCCESS)
+	{
+		return 0;
+	}
+
+	write_back_t write_back;
+	if (write_back_initialize(&write_back, &store, mode) != SUCCESS)
+	{
+		backing_store_close(&store);
+		return 0;
+	}
+
+	uint64_t resident[NUMBER_FRAMES] = { 0 };
+	uint64_t state = 2463534242ull;
+	status_t error = SUCCESS;
+	uint64_t begin = now_ns();
+	size_t fault;
+	for (fault = 0; fault < FAULTS && error == SUCCESS; fault++)
+	{
+		uint64_t page = next_random(&state) % pages;
+		size_t frame = fault % NUMBER_FRAMES;
+		int8_t *contents = frames + frame * PAGE_BYTES;
+
+		uint64_t start = now_ns();
+		if (fault >= NUMBER_FRAMES && fault % DIRTY_EVERY == 0)
+		{
+			error = write_back_page(&write_back, resident[frame], contents);
+		}
+		if (error == SUCCESS)
+		{
+			error = write_back_read(&write_back, page, contents);
+		}
+		latencies[fault] = now_ns() - start;
+
+		contents[page % PAGE_BYTES]++;
+		resident[frame] = page;
+	}
+
+	if (write_back_uninitialize(&write_back) != SUCCESS)
+	{
+		error = WRIT_ERROR;
+	}
+	uint64_t elapsed = now_ns() - begin;
+	backing_store_close(&store);
+	return error == SUCCESS ? elapsed : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t mb = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_MB;
+	const char *path = argc > 2 ? argv[2] : "build/writeback_bench.bin";
+	if (mb == 0)
+	{
+		fprintf(stderr, "Usage: %s [MB] [path]\n", argv[0]);
+		return ARGS_ERROR;
+	}
+
+	size_t bytes = mb << 20;
+	if (create_store(path, bytes) != SUCCESS)
+	{
+		fprintf(stderr, "Could not create %s\n", path);
+		return OPEN_ERROR;
+	}
+
+	int8_t *frames = malloc(NUMBER_FRAMES * PAGE_BYTES);
+	uint64_t *latencies = malloc(FAULTS * sizeof *latencies);
+	if (frames == NULL || latencies == NULL)
+	{
+		free(frames);
+		free(latencies);
+		return ALOC_ERROR;
+	}
+
+	fprintf(stdout, "%zu MB backing store, %d random faults of %d bytes, every %s victim dirty\n", mb, FAULTS, PAGE_BYTES, DIRTY_EVERY == 2 ? "other" : "nth");
+	fprintf(stdout, "%6s %14s %14s %14s %14s\n", "mode", "mean ns", "median ns", "p99 ns", "total ms");
+
+	size_t i;
+	for (i = 0; i < sizeof modes / sizeof *modes; i++)
+	{
+		write_back_mode_t mode;
+		write_back_mode_find(modes[i], &mode);
+		uint64_t elapsed = bench_mode(path, mode, bytes / PAGE_BYTES, frames, latencies);
+		if (elapsed == 0)
+		{
+			fprintf(stderr, "Could not write back to a copy of %s in %s mode\n", path, modes[i]);
+			free(frames);
+			free(latencies);
+			return WRIT_ERROR;
+		}
+
+		uint64_t sum = 0;
+		size_t fault;
+		for (fault = 0; fault < FAULTS; fault++)
+		{
+			sum += latencies[fault];
+		}
+		qsort(latencies, FAULTS, sizeof *latencies, compare_latencies);
+		fprintf(stdout, "%6s %14.1f %14" PRIu64 " %14" PRIu64 " %14.1f\n", modes[i], (double) sum / FAULTS,
+			latencies[FAULTS / 2], latencies[FAULTS / 100 * 99], elapsed / 1e6);
+	}
+
+	free(frames);
+	free(latencies);
+	return 0;
+}
@@ -0,0 +1,105 @@
+#ifndef _BACKING_STORE_H_
+#define _BACKING_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/uio.h>
+
+#include "status.h"
+
+/**
+  * The ways of getting at the contents of the backing store:
+  *   BACKING_STDIO     - seek and read through a stdio FILE on every page fault
+  *   BACKING_MMAP      - map the whole file read-only and copy a page out of the mapping on a fault
+  *   BACKING_ZERO_COPY - map the whole file read-only and point the frame straight at the page in
+  *                       the mapping, so that a fault copies nothing at all
+  */
+typedef enum
+{
+	BACKING_STDIO,
+	BACKING_MMAP,
+	BACKING_ZERO_COPY
+} backing_mode_t;
+
+/**
+  * An open backing store, holding the contents of every page in page order. A writable store is a
+  * private copy of the original, read unbuffered so that it always sees what was written to it
+  */
+typedef struct
+{
+	backing_mode_t mode;
+	uint8_t writable;
+	FILE *file;
+	int8_t *map;
+	size_t size;
+	size_t page_bytes;
+} backing_store_t;
+
+/**
+  * Looks up a backing store mode by name ("stdio", "mmap" or "zero-copy")
+  * @param name the name of the mode
+  * @param mode out param which will hold the mode
+  * @return an indication of whether an error occurred
+  */
+status_t backing_mode_find(const char *name, backing_mode_t *mode);
+
+/**
+  * Opens the backing store at the given path
+  * @param store      the backing store to open
+  * @param path       the path of the backing store file
+  * @param page_bytes the number of bytes in a page
+  * @param mode       how the contents are to be read
+  * @return an indication of whether an error occurred
+  */
+status_t backing_store_open(backing_store_t *store, const char *path, size_t page_bytes, backing_mode_t mode);
+
+/**
+  * Copies the backing store at the given path and opens the copy for writing as well as reading,
+  * leaving the original untouched
+  * @param store      the backing store to open
+  * @param path       the path of the backing store file
+  * @param copy       the path to copy it to, or NULL for a temporary file removed on closing
+  * @param page_bytes the number of bytes in a page
+  * @param mode       how the contents are to be read; zero-copy reads copy the page as mmap does,
+  *                   since a frame which is written to cannot point into the store
+  * @return an indication of whether an error occurred
+  */
+status_t backing_store_open_copy(backing_store_t *store, const char *path, const char *copy, size_t page_bytes, backing_mode_t mode);
+
+/**
+  * Closes a backing store after it is no longer needed
+  * @param store the backing store to close
+  */
+void backing_store_close(backing_store_t *store);
+
+/**
+  * Copies the contents of a page into the given buffer. A page past the end of the store reads as
+  * zeros
+  * @param store the backing store
+  * @param page  the number of the page
+  * @param dest  the buffer of page_bytes bytes to copy into
+  * @return an indication of whether an error occurred
+  */
+status_t backing_store_read(backing_store_t *store, uint64_t page, int8_t *dest);
+
+/**
+  * Writes a run of consecutive pages to a writable backing store in a single system call
+  * @param store the backing store
+  * @param page  the number of the first page
+  * @param pages the contents of each page, page_bytes bytes apiece
+  * @param count the number of pages
+  * @return an indication of whether an error occurred
+  */
+status_t backing_store_write(backing_store_t *store, uint64_t page, const struct iovec *pages, int count);
+
+/**
+  * Returns the contents of a page in place, without copying, if the backing store is in zero-copy
+  * mode and is not writable. The contents are read-only
+  * @param store the backing store
+  * @param page  the number of the page
+  * @return the contents of the page, or NULL if the store is not in zero-copy mode or the page lies
+  * beyond the end of the store
+  */
+int8_t *backing_store_page(backing_store_t *store, uint64_t page);
+#endif
@@ -0,0 +1,57 @@
+#ifndef _CODEC_H_
+#define _CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "status.h"
+
+/**
+  * The name of the codec used when none is given
+  */
+#define DEFAULT_CODEC "lz"
+
+/**
+  * The operations every page compressor provides:
+  *   compress   - compresses length bytes of src into at most capacity bytes of dst, returning the
+  *                compressed length, or 0 if it would not fit, in which case the page is kept
+  *                uncompressed elsewhere
+  *   decompress - decompresses compressed bytes of src into exactly length bytes of dst, failing
+  *                with FORM_ERROR if they do not decode to that many
+  */
+typedef struct
+{
+	const char *name;
+	size_t (*compress)(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity);
+	status_t (*decompress)(const uint8_t *src, size_t compressed, uint8_t *dst, size_t length);
+} codec_ops_t;
+
+/**
+  * A fast LZ77 codec in the block format of LZ4: each sequence is a token whose high nibble counts
+  * its literals and whose low nibble its match length beyond the minimum, with 255s extending
+  * either, then the literals, then a two byte offset back to the match. Matches are found through a
+  * hash table of the four bytes at each position. The last sequence has literals only
+  */
+extern const codec_ops_t lz_codec_ops;
+
+/**
+  * Compresses nothing, so that only the pages filled with a single byte value are kept
+  */
+extern const codec_ops_t same_codec_ops;
+
+/**
+  * Looks up a codec by name
+  * @param name the name of the codec, "lz" or "same"
+  * @return the operations of the codec, or NULL if there is no codec with that name
+  */
+const codec_ops_t *codec_find(const char *name);
+
+/**
+  * Checks whether a page is filled with a single byte value, as a zeroed page is
+  * @param src    the page
+  * @param length the length of the page, at least 1
+  * @param value  out param which will hold the value the page is filled with
+  * @return whether the page is filled with a single value
+  */
+uint8_t codec_same_filled(const uint8_t *src, size_t length, uint8_t *value);
+#endif
@@ -0,0 +1,140 @@
+#ifndef _DEDUP_H_
+#define _DEDUP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash_map.h"
+#include "status.h"
+
+/**
+  * What deduplication has done: the pages hashed as they were read in and the nanoseconds spent
+  * hashing them and looking for a frame with the same contents, the pages which were given such a
+  * frame rather than one of their own, the pages given a copy of their own again when written, and
+  * the pages now, and at most, sharing a frame with another page, which is the number of frames
+  * saved
+  */
+typedef struct
+{
+	uint64_t hashed;
+	uint64_t hash_ns;
+	uint64_t merged;
+	uint64_t copies;
+	uint64_t shared;
+	uint64_t peak_shared;
+} dedup_statistics_t;
+
+/**
+  * Tracks which pages share each frame and finds frames by their contents, like KSM. Every frame in
+  * use lists the tags of its pages in pages[frame], count[frame] of them in an array with room for
+  * capacity[frame], and position maps each tag to its place in that array so that a page leaves in
+  * constant time. A frame whose contents can still be shared, which is one none of its pages has
+  * written, is in index under the hash of its contents, kept in hashes[frame] while indexed[frame]
+  * is set. Since different contents may hash alike, only one frame is indexed under a hash at a
+  * time, and a frame found is compared in full before it is shared
+  */
+typedef struct
+{
+	size_t page_bytes;
+	size_t number_frames;
+	uint64_t **pages;
+	uint32_t *count;
+	uint32_t *capacity;
+	hash_map_t position;
+	hash_map_t index;
+	uint64_t *hashes;
+	uint8_t *indexed;
+	dedup_statistics_t statistics;
+} dedup_t;
+
+/**
+  * Initializes deduplication over frames which hold no pages
+  * @param dedup         the deduplication to initialize
+  * @param number_frames the number of frames
+  * @param page_bytes    the size of a page
+  * @return an indication of whether an error occurred
+  */
+status_t dedup_initialize(dedup_t *dedup, size_t number_frames, size_t page_bytes);
+
+/**
+  * Uninitializes deduplication after it is no longer needed
+  * @param dedup the deduplication to uninitialize
+  */
+void dedup_uninitialize(dedup_t *dedup);
+
+/**
+  * Hashes the contents of a page being read in and looks for a frame holding the same contents
+  * which may be shared
+  * @param dedup    the deduplication
+  * @param contents the contents of the page
+  * @param frames   the contents of every frame
+  * @param hash     out param which will hold the hash of the contents
+  * @param frame    out param which will hold the frame found, if any
+  * @return whether a frame was found
+  */
+uint8_t dedup_find(dedup_t *dedup, const int8_t *contents, int8_t *const *frames, uint64_t *hash, uint32_t *frame);
+
+/**
+  * Makes a frame which can be shared findable by the hash of its contents, unless another frame
+  * already is under the same hash
+  * @param dedup the deduplication
+  * @param frame the frame
+  * @param hash  the hash of its contents, as given by dedup_find
+  * @return an indication of whether an error occurred
+  */
+status_t dedup_index(dedup_t *dedup, uint32_t frame, uint64_t hash);
+
+/**
+  * Stops a frame being found by its contents, because one of its pages is writing them
+  * @param dedup the deduplication
+  * @param frame the frame
+  */
+void dedup_unindex(dedup_t *dedup, uint32_t frame);
+
+/**
+  * Adds a page to those in a frame, counting it as merged if the frame already held another
+  * @param dedup the deduplication
+  * @param frame the frame
+  * @param tag   the tag of the page
+  * @return an indication of whether an error occurred
+  */
+status_t dedup_add(dedup_t *dedup, uint32_t frame, uint64_t tag);
+
+/**
+  * Removes a page from those in a frame, which must hold it
+  * @param dedup the deduplication
+  * @param frame the frame
+  * @param tag   the tag of the page
+  */
+void dedup_remove(dedup_t *dedup, uint32_t frame, uint64_t tag);
+
+/**
+  * Removes every page from a frame which is being emptied, and unindexes it
+  * @param dedup the deduplication
+  * @param frame the frame
+  */
+void dedup_clear(dedup_t *dedup, uint32_t frame);
+
+/**
+  * Returns the number of pages in a frame
+  * @param dedup the deduplication
+  * @param frame the frame
+  * @return the number of pages
+  */
+static inline uint32_t dedup_count(dedup_t *dedup, uint32_t frame)
+{
+	return dedup->count[frame];
+}
+
+/**
+  * Returns the tags of the pages in a frame, dedup_count of them, which stay valid until a page is
+  * added to or removed from it
+  * @param dedup the deduplication
+  * @param frame the frame
+  * @return the tags of the pages
+  */
+static inline const uint64_t *dedup_pages(dedup_t *dedup, uint32_t frame)
+{
+	return dedup->pages[frame];
+}
+#endif
@@ -0,0 +1,36 @@
+#ifndef _GHOST_LIST_H_
+#define _GHOST_LIST_H_
+
+#include <stdint.h>
+
+#include "hash_map.h"
+#include "lru_queue.h"
+#include "snapshot.h"
+#include "status.h"
+
+/**
+  * A bounded list of the keys of recently evicted items, in the order they were evicted, which
+  * adaptive replacement policies (ARC and 2Q) use to recognise an item that returns soon after
+  * being evicted. Keys are looked up through a hash map, and the list itself is an LRU queue over
+  * a pool of ids, so every operation is O(1). Pushing onto a full list forgets the oldest key
+  */
+typedef struct
+{
+	lru_queue_t queue;
+	hash_map_t index;
+	uint64_t *keys;
+	int *free_ids;
+	int free_count;
+	int size;
+	int capacity;
+} ghost_list_t;
+
+status_t ghost_list_initialize(ghost_list_t *list, int capacity);
+void ghost_list_uninitialize(ghost_list_t *list);
+unsigned short ghost_list_contains(ghost_list_t *list, uint64_t key);
+void ghost_list_push(ghost_list_t *list, uint64_t key);
+void ghost_list_remove(ghost_list_t *list, uint64_t key);
+void ghost_list_drop_oldest(ghost_list_t *list);
+void ghost_list_save(ghost_list_t *list, snapshot_writer_t *writer);
+status_t ghost_list_restore(ghost_list_t *list, snapshot_reader_t *reader);
+#endif
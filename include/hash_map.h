@@ -0,0 +1,33 @@
+#ifndef _HASH_MAP_H_
+#define _HASH_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "status.h"
+
+/**
+  * The key which marks an empty bucket. It cannot itself be stored in the map
+  */
+#define HASH_MAP_EMPTY UINT64_MAX
+
+/**
+  * An open addressing hash map from 64-bit keys to 64-bit values, using linear probing. Removal
+  * shifts the following entries back rather than leaving tombstones, so lookups never slow down
+  * however many keys come and go. The map doubles in size whenever it becomes half full
+  */
+typedef struct
+{
+	uint64_t *keys;
+	uint64_t *values;
+	size_t capacity;
+	size_t size;
+} hash_map_t;
+
+status_t hash_map_initialize(hash_map_t *map, size_t expected);
+void hash_map_uninitialize(hash_map_t *map);
+uint64_t *hash_map_find(hash_map_t *map, uint64_t key);
+status_t hash_map_put(hash_map_t *map, uint64_t key, uint64_t value);
+void hash_map_remove(hash_map_t *map, uint64_t key);
+void hash_map_clear(hash_map_t *map);
+#endif
@@ -0,0 +1,34 @@
+#ifndef _HEAP_H_
+#define _HEAP_H_
+
+#include <stdint.h>
+
+/**
+  * Marks an id which is not currently in the heap
+  */
+#define HEAP_NOT_QUEUED -1
+
+/**
+  * An indexed binary min-heap over the ids 0 to capacity - 1, each with a 64-bit key. The position
+  * of every id is tracked so that the key of any id can be changed, or the id removed, in
+  * O(log capacity)
+  */
+typedef struct
+{
+	int *ids;
+	int *positions;
+	uint64_t *keys;
+	int size;
+	int capacity;
+} heap_t;
+
+void heap_initialize(heap_t *heap, int capacity);
+void heap_uninitialize(heap_t *heap);
+void heap_push(heap_t *heap, int id, uint64_t key);
+void heap_update(heap_t *heap, int id, uint64_t key);
+void heap_remove(heap_t *heap, int id);
+int heap_peek(heap_t *heap);
+int heap_pop(heap_t *heap);
+unsigned short heap_contains(heap_t *heap, int id);
+unsigned short heap_empty(heap_t *heap);
+#endif
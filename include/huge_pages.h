@@ -0,0 +1,95 @@
+#ifndef _HUGE_PAGES_H_
+#define _HUGE_PAGES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash_map.h"
+#include "status.h"
+
+/**
+  * The states of a huge page, the aligned run of base pages which it covers:
+  *   HUGE_BASE      - its pages are mapped as base pages, each with a translation of its own
+  *   HUGE_PROMOTING - its missing pages are being read in so that it can be promoted
+  *   HUGE_MAPPED    - every one of its pages is resident and a single translation covers them all
+  */
+typedef enum
+{
+	HUGE_BASE,
+	HUGE_PROMOTING,
+	HUGE_MAPPED
+} huge_state_t;
+
+/**
+  * Decides which huge pages to promote, counting how many base pages of each are resident. The map
+  * holds that count for every huge page with at least one page resident, with its state above
+  * bit 32. A huge page of pages base pages, numbered by its first page shifted right by shift, is
+  * ready to be promoted once threshold of them are resident
+  */
+typedef struct
+{
+	hash_map_t regions;
+	unsigned int shift;
+	size_t pages;
+	size_t threshold;
+} huge_pages_t;
+
+/**
+  * Initializes the huge pages with none resident
+  * @param huge      the huge pages to initialize
+  * @param shift     the number of bits of a page number which pick the page within its huge page
+  * @param threshold how many pages of a huge page must be resident for it to be promoted, from 1 up
+  *                  to all of them
+  * @return an indication of whether an error occurred
+  */
+status_t huge_pages_initialize(huge_pages_t *huge, unsigned int shift, size_t threshold);
+
+/**
+  * Uninitializes the huge pages after they are no longer needed
+  * @param huge the huge pages to uninitialize
+  */
+void huge_pages_uninitialize(huge_pages_t *huge);
+
+/**
+  * Finds the state of a huge page
+  * @param huge   the huge pages
+  * @param region the number of the huge page
+  * @return the state of the huge page
+  */
+huge_state_t huge_pages_state(huge_pages_t *huge, uint64_t region);
+
+/**
+  * Counts a page of a huge page which has become resident
+  * @param huge   the huge pages
+  * @param region the number of the huge page
+  * @return an indication of whether an error occurred
+  */
+status_t huge_pages_map(huge_pages_t *huge, uint64_t region);
+
+/**
+  * Counts a page of a huge page which has been evicted, which splits the huge page back into base
+  * pages if it was promoted, or stops it being promoted
+  * @param huge   the huge pages
+  * @param region the number of the huge page
+  * @return the state of the huge page before the page was evicted
+  */
+huge_state_t huge_pages_unmap(huge_pages_t *huge, uint64_t region);
+
+/**
+  * Checks whether a huge page of base pages has enough of them resident to be promoted, and if so
+  * starts promoting it
+  * @param huge   the huge pages
+  * @param region the number of the huge page
+  * @return whether the huge page is now being promoted
+  */
+uint8_t huge_pages_begin(huge_pages_t *huge, uint64_t region);
+
+/**
+  * Finishes promoting a huge page once its missing pages have been read in. It is only promoted if
+  * none of its pages were evicted meanwhile
+  * @param huge   the huge pages
+  * @param region the number of the huge page
+  * @return whether the huge page was promoted
+  */
+uint8_t huge_pages_finish(huge_pages_t *huge, uint64_t region);
+#endif
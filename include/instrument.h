@@ -0,0 +1,186 @@
+#ifndef _INSTRUMENT_H_
+#define _INSTRUMENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "hash_map.h"
+#include "stack_distance.h"
+#include "status.h"
+
+/**
+  * A histogram has a bucket for 0 and one for each power of two up to 2^63, bucket b holding the
+  * values from 2^(b - 1) up to 2^b - 1
+  */
+#define HISTOGRAM_BUCKETS 65
+
+/**
+  * The number of the most referenced pages written out
+  */
+#define INSTRUMENT_HOT_PAGES 256
+
+/**
+  * The parts of a reference which are timed:
+  *   PROBE_TLB   - looking the page up in the TLB, including the huge page entries
+  *   PROBE_WALK  - walking the page table after a TLB miss
+  *   PROBE_FAULT - serving a page fault, from choosing the frame to mapping the page
+  *   PROBE_IO    - reading a page from the backing store, or writing a dirty one back
+  */
+typedef enum
+{
+	PROBE_TLB,
+	PROBE_WALK,
+	PROBE_FAULT,
+	PROBE_IO,
+	PROBES
+} probe_t;
+
+/**
+  * A histogram of values bucketed by their base 2 logarithm, with their count, sum and maximum
+  */
+typedef struct
+{
+	uint64_t buckets[HISTOGRAM_BUCKETS];
+	uint64_t count;
+	uint64_t sum;
+	uint64_t max;
+} histogram_t;
+
+/**
+  * Everything recorded by the instrumentation of one thread: the latency of each probe, in cycles
+  * where the time stamp counter can be read and in nanoseconds otherwise, the reuse distance of
+  * every reference, and the references and faults of each page, keyed by its tag. Where it was
+  * started is kept so that the cycles can be converted to time
+  */
+typedef struct
+{
+	histogram_t latency[PROBES];
+	histogram_t reuse;
+	uint64_t cold;
+	stack_distance_t distances;
+	hash_map_t accesses;
+	hash_map_t faults;
+	uint64_t start_ticks;
+	uint64_t start_ns;
+} instrument_t;
+
+/**
+  * Whether probes are compiled in at all. Without INSTRUMENT every probe compiles away, and with it
+  * a probe costs a single test of a pointer which is NULL unless instrumentation was asked for
+  */
+#ifdef INSTRUMENT
+#define INSTRUMENT_PROBES 1
+#else
+#define INSTRUMENT_PROBES 0
+#endif
+#define instrument_active(instrument) (INSTRUMENT_PROBES && (instrument) != NULL)
+
+/**
+  * Reads the cheapest clock with the finest resolution: the time stamp counter on x86, and the
+  * monotonic clock in nanoseconds elsewhere
+  * @return the current time in ticks of that clock
+  */
+static inline uint64_t instrument_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/**
+  * Adds a value to a histogram
+  * @param histogram the histogram
+  * @param value     the value to add
+  */
+static inline void histogram_add(histogram_t *histogram, uint64_t value)
+{
+	histogram->buckets[value == 0 ? 0 : 64 - __builtin_clzll(value)]++;
+	histogram->count++;
+	histogram->sum += value;
+	if (value > histogram->max)
+	{
+		histogram->max = value;
+	}
+}
+
+/**
+  * Starts timing a probe
+  * @param instrument the instrumentation of the thread, or NULL when it is off
+  * @return the time the probe started, or 0 when instrumentation is off
+  */
+static inline uint64_t instrument_start(instrument_t *instrument)
+{
+	return instrument_active(instrument) ? instrument_ticks() : 0;
+}
+
+/**
+  * Stops timing a probe, adding the time it took to its histogram
+  * @param instrument the instrumentation of the thread, or NULL when it is off
+  * @param probe      the probe
+  * @param start      the time the probe started
+  */
+static inline void instrument_stop(instrument_t *instrument, probe_t probe, uint64_t start)
+{
+	if (instrument_active(instrument))
+	{
+		histogram_add(&instrument->latency[probe], instrument_ticks() - start);
+	}
+}
+
+/**
+  * Initializes the instrumentation of a thread with nothing recorded
+  * @param instrument the instrumentation to initialize
+  * @return an indication of whether an error occurred
+  */
+status_t instrument_initialize(instrument_t *instrument);
+
+/**
+  * Uninitializes the instrumentation after it is no longer needed
+  * @param instrument the instrumentation to uninitialize
+  */
+void instrument_uninitialize(instrument_t *instrument);
+
+/**
+  * Records a reference to a page, counting it and its reuse distance
+  * @param instrument the instrumentation
+  * @param tag        the tag of the page
+  * @return an indication of whether an error occurred
+  */
+status_t instrument_reference(instrument_t *instrument, uint64_t tag);
+
+/**
+  * Records a page fault
+  * @param instrument the instrumentation
+  * @param tag        the tag of the page
+  * @return an indication of whether an error occurred
+  */
+status_t instrument_fault(instrument_t *instrument, uint64_t tag);
+
+/**
+  * Adds what one thread recorded to what another did. The reuse distances of different threads are
+  * of different streams, so only their histograms are added
+  * @param total      the instrumentation to add to
+  * @param instrument the instrumentation to add
+  * @return an indication of whether an error occurred
+  */
+status_t instrument_add(instrument_t *total, instrument_t *instrument);
+
+/**
+  * Writes everything recorded as a JSON object
+  * @param instrument the instrumentation
+  * @param fout       the file to write to
+  * @param page_bits  the bits of a tag below its process
+  * @return an indication of whether an error occurred
+  */
+status_t instrument_write_json(instrument_t *instrument, FILE *fout, unsigned int page_bits);
+#endif
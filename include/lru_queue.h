@@ -1,25 +1,44 @@
 #ifndef _LRU_QUEUE_H_
 #define _LRU_QUEUE_H_
 
-typedef struct lru_node_t
+#include "snapshot.h"
+
+/**
+  * Marks a node whose data value is not currently in the queue
+  */
+#define LRU_NOT_QUEUED -1
+
+/**
+  * A single node in the queue. Nodes are linked by their index in the node array rather than by
+  * pointer, and the index of a node is the data value it holds
+  */
+typedef struct
 {
-	int data;
-	struct lru_node_t *next;
-	struct lru_node_t *prev;
+	int next;
+	int prev;
 } lru_node_t;
 
+/**
+  * An LRU queue over the data values 0 to capacity - 1. All of the nodes are allocated up front in
+  * a single array, with one extra node at index capacity acting as the artificial head of the
+  * circular list, so that every operation is O(1) and no operation allocates memory
+  */
 typedef struct
 {
-	lru_node_t *head;
-	lru_node_t *tail;
+	lru_node_t *nodes;
+	int capacity;
 } lru_queue_t;
 
-void lru_queue_initialize(lru_queue_t *queue);
+status_t lru_queue_initialize(lru_queue_t *queue, int capacity);
 void lru_queue_uninitialize(lru_queue_t *queue);
 void lru_queue_insert_new(lru_queue_t *queue, int data);
 void lru_queue_update_existing(lru_queue_t *queue, int data);
 void lru_queue_remove(lru_queue_t *queue);
+void lru_queue_remove_existing(lru_queue_t *queue, int data);
 int lru_queue_get(lru_queue_t *queue);
 int lru_queue_poll(lru_queue_t *queue);
 unsigned short lru_queue_empty(lru_queue_t *queue);
+unsigned short lru_queue_contains(lru_queue_t *queue, int data);
+void lru_queue_save(lru_queue_t *queue, snapshot_writer_t *writer);
+status_t lru_queue_restore(lru_queue_t *queue, snapshot_reader_t *reader);
 #endif
@@ -0,0 +1,198 @@
+#ifndef _MEMMGR_H_
+#define _MEMMGR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "backing_store.h"
+#include "options.h"
+#include "output.h"
+#include "schedule.h"
+#include "status.h"
+#include "trace.h"
+#include "write_back.h"
+
+/**
+  * The widest virtual address that can be simulated, and the widest tag, the page number with the
+  * number of its process above it
+  */
+#define MAX_ADDRESS_BITS 64
+#define MAX_TAG_BITS     63
+
+/**
+  * Holds a variety of statistical information, including total number of addresses translated,
+  * number of page faults, number of tlb hits, number of write-backs occuring, the number of TLB
+  * shootdowns sent to other cores, and the number of pages read ahead, of those later referenced
+  * and of those evicted first, and the walks of the page table with the entries they read. With
+  * huge pages, it also counts the TLB hits on huge pages, the huge pages promoted and split up
+  * again, the pages read in to complete them and those of them never referenced. They are kept
+  * for each process, and a write-back, a wasted prefetch or an unreferenced page is charged to the
+  * process which owned the page
+  */
+typedef struct
+{
+	size_t translated;
+	size_t page_faults;
+	size_t tlb_hits;
+	size_t write_backs;
+	size_t shootdowns;
+	size_t prefetches;
+	size_t prefetch_hits;
+	size_t prefetch_wasted;
+	size_t walks;
+	size_t walk_references;
+	size_t huge_tlb_hits;
+	size_t promotions;
+	size_t demotions;
+	size_t huge_fills;
+	size_t huge_wasted;
+} statistics_t;
+
+/**
+  * A simulated memory, with its own frame table, page table, TLB and statistics, which is given
+  * references a batch at a time. Managers are independent of each other, and any number of them
+  * may be used, on any thread, as long as a single manager is only used by one thread at a time.
+  * memmgr_run_cores and memmgr_run_sweep leave whatever manager the calling thread was using as
+  * they found it
+  */
+typedef struct memmgr_t memmgr_t;
+
+/**
+  * Checks that the options give a valid memory geometry and ask for no features which cannot be
+  * used together, without simulating anything
+  * @param options the options
+  * @return GEOM_ERROR for an invalid geometry, OPTN_ERROR for features which cannot be used
+  *         together, or SUCCESS
+  */
+status_t memmgr_check(options_t *options);
+
+/**
+  * Opens a simulated memory with the geometry, policies and features the options give, once
+  * memmgr_check has accepted them. The options, the backing store, the write-back and the writer
+  * must outlive the manager
+  * @param manager    out param which will hold the newly allocated manager
+  * @param options    the options
+  * @param backing    the backing store
+  * @param write_back where dirty pages are written back, or NULL when writes are not simulated
+  * @param out        the writer the line of every reference is printed to, or NULL for none
+  * @return an indication of whether an error occurred
+  */
+status_t memmgr_open(memmgr_t **manager, options_t *options, backing_store_t *backing, write_back_t *write_back, output_t *out);
+
+/**
+  * Closes a manager after it is no longer needed, without writing anything back
+  * @param manager the manager to close
+  */
+void memmgr_close(memmgr_t *manager);
+
+/**
+  * Writes every dirty page still resident or compressed back, and then what the probes recorded to
+  * the instrumentation file of the options, if there is one
+  * @param manager the manager
+  * @return an indication of whether an error occurred
+  */
+status_t memmgr_flush(memmgr_t *manager);
+
+/**
+  * Finds whether a replacement policy of the manager is offline, and so has to be given the
+  * future of the whole trace with memmgr_set_future before the first reference
+  * @param manager the manager
+  * @return whether the future is needed
+  */
+uint8_t memmgr_offline(memmgr_t *manager);
+
+/**
+  * Gives the offline policies of a manager the future of a whole trace, whose references are then
+  * to be translated in order from the first
+  * @param manager the manager
+  * @param trace   the whole trace
+  * @return an indication of whether an error occurred
+  */
+status_t memmgr_set_future(memmgr_t *manager, trace_t *trace);
+
+/**
+  * Translates a batch of references in order, as if they were given one at a time, switching
+  * between processes as the number above each address changes
+  * @param manager   the manager
+  * @param addresses the virtual addresses, each with its process above address_bits
+  * @param writes    whether each reference is a write, or NULL when none are
+  * @param count     the number of references
+  * @param values    out param which will hold the value at each address, or NULL
+  * @return an indication of whether an error occurred, leaving the references before the one
+  *         which failed translated
+  */
+status_t memmgr_translate_batch(memmgr_t *manager, const uint64_t *addresses, const uint8_t *writes, size_t count, int8_t *values);
+
+/**
+  * Adds up the statistics of every process of a manager so far, including the pages read in to
+  * complete a huge page which are still resident and have never been referenced
+  * @param manager the manager
+  * @param total   out param which will hold the statistics
+  */
+void memmgr_statistics(memmgr_t *manager, statistics_t *total);
+
+/**
+  * Prints the statistics of a manager so far, as a whole and for each process, along with those
+  * of the features the options turned on
+  * @param manager the manager
+  * @param summary the file to print to
+  * @return an indication of whether an error occurred
+  */
+status_t memmgr_print_statistics(memmgr_t *manager, FILE *summary);
+
+/**
+  * Saves the whole state of a manager to a snapshot file: its statistics, the pages resident in
+  * each frame with their contents, the page table, the order of every replacement policy and the
+  * TLB. Only a manager of the frame table, page table and TLB alone can be saved; one which
+  * simulates writes, prefetching, huge pages, resident sets, compressed swap or an offline policy
+  * cannot
+  * @param manager the manager
+  * @param path    the path of the snapshot, which is replaced if it exists
+  * @return an indication of whether an error occurred; OPTN_ERROR if the manager cannot be saved
+  */
+status_t memmgr_save(memmgr_t *manager, const char *path);
+
+/**
+  * Restores the state of a manager from a snapshot file, so that it carries on exactly as the
+  * manager which saved it would have, statistics included. The manager has to have just been
+  * opened, with the same geometry and replacement policies as the one which saved it; should the
+  * restore fail part way, it can only be closed
+  * @param manager the manager
+  * @param path    the path of the snapshot
+  * @return an indication of whether an error occurred; OPTN_ERROR if the manager cannot be restored
+  * or does not match the snapshot, and FORM_ERROR if the file is not a snapshot of this version or
+  * holds a state which no manager could have saved
+  */
+status_t memmgr_restore(memmgr_t *manager, const char *path);
+
+/**
+  * Prints the miss-ratio curve of the first address file of a schedule
+  * @param schedule the schedule
+  * @param options  the options
+  * @return an indication of whether an error occurred
+  */
+status_t memmgr_run_mrc(schedule_t *schedule, options_t *options);
+
+/**
+  * Replays every address file of the schedule on its own core, each in its own thread, in a
+  * single address space, and then prints the statistics
+  * @param schedule   the schedule holding the address file of every core
+  * @param backing    the backing store
+  * @param write_back where dirty pages are written back, or NULL when writes are not simulated
+  * @param options    the options
+  * @return an indication of whether an error occurred
+  */
+status_t memmgr_run_cores(schedule_t *schedule, backing_store_t *backing, write_back_t *write_back, options_t *options);
+
+/**
+  * Simulates every combination of the frame counts, TLB sizes and replacement policies swept,
+  * each with a manager of its own, on a pool of threads sharing the trace, and then prints a table
+  * of the statistics of every point
+  * @param schedule the schedule from which the memory addresses of every process will be read
+  * @param backing  the backing store
+  * @param options  the options
+  * @return an indication of whether an error occurred
+  */
+status_t memmgr_run_sweep(schedule_t *schedule, backing_store_t *backing, options_t *options);
+#endif
@@ -0,0 +1,22 @@
+#ifndef _MRC_H_
+#define _MRC_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "status.h"
+#include "trace.h"
+
+/**
+  * Computes the LRU miss-ratio curve of an address file in a single pass. Since LRU is a stack
+  * algorithm, a reference hits in an LRU structure of any size greater than its stack distance, so
+  * one histogram of stack distances gives the page faults of a frame table, and the hits of a TLB,
+  * of every size at once. Prints one row per size, from 1 up to the number of distinct pages
+  * @param fin         the address file
+  * @param offset_bits the number of bits of an address which make up the page offset
+  * @param page_mask   the mask applied to an address shifted right by offset_bits to get its page
+  * @param out         the file to print the curve to
+  * @return an indication of whether an error occurred
+  */
+status_t mrc_run(trace_file_t *fin, unsigned int offset_bits, uint64_t page_mask, FILE *out);
+#endif
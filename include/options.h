@@ -0,0 +1,115 @@
+#ifndef _OPTIONS_H_
+#define _OPTIONS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "backing_store.h"
+#include "output.h"
+#include "page_table.h"
+#include "resident_set.h"
+#include "status.h"
+#include "write_back.h"
+
+/**
+  * The default memory geometry, matching the original course assignment
+  */
+#define DEFAULT_PAGE_BYTES    256
+#define DEFAULT_NUMBER_FRAMES 128
+#define DEFAULT_ADDRESS_BITS  16
+#define DEFAULT_TLB_ENTRIES   16
+
+/**
+  * The default number of references each process runs for before the next one is scheduled
+  */
+#define DEFAULT_QUANTUM 100
+
+/**
+  * Holds everything that can be set from the command line or from a configuration file. A sweep
+  * is given by the lists of frame counts, TLB sizes and replacement policies to try, each of which
+  * is left NULL to try only the single value of its option, and is run on threads threads, or
+  * one for each processor when threads is 0. While a trace streams in, the statistics of every
+  * report_references references, or of every report_seconds seconds, are reported as it goes,
+  * each 0 when not. A run may start from the state saved in the snapshot restore_file, and save
+  * its own state at the end to snapshot_file, each NULL when not. With dedup set, pages of
+  * identical contents share a frame until one of them is written
+  */
+typedef struct
+{
+	size_t page_bytes;
+	size_t number_frames;
+	unsigned int address_bits;
+	size_t tlb_entries;
+	size_t tlb_ways;
+	const char *policy;
+	const char *tlb_policy;
+	uint8_t mrc;
+	backing_mode_t backing_mode;
+	write_back_mode_t write_back;
+	char *store_copy;
+	output_format_t output_format;
+	uint8_t stats_only;
+	size_t quantum;
+	uint8_t local_frames;
+	uint8_t tlb_flush;
+	uint8_t cores;
+	size_t prefetch_degree;
+	size_t io_workers;
+	page_table_kind_t page_table;
+	size_t huge_bytes;
+	size_t huge_threshold;
+	char *instrument_file;
+	resident_policy_t resident_policy;
+	size_t resident_window;
+	size_t zswap_bytes;
+	const char *codec;
+	uint8_t dedup;
+	size_t *sweep_frames;
+	size_t number_sweep_frames;
+	size_t *sweep_tlb;
+	size_t number_sweep_tlb;
+	const char **sweep_policies;
+	size_t number_sweep_policies;
+	size_t threads;
+	size_t report_references;
+	double report_seconds;
+	char *snapshot_file;
+	char *restore_file;
+	char **input_files;
+	size_t number_inputs;
+	char *backing_file;
+} options_t;
+
+/**
+  * Fills in the options with their default values
+  * @param options the options to initialize
+  */
+void options_initialize(options_t *options);
+
+/**
+  * Parses the command line into the options. Options may appear anywhere on the command line; the
+  * last remaining argument is taken as the backing store and those before it as the input files,
+  * one for each process. A configuration file given with --config is applied at the point it
+  * appears, so that later options override it
+  * @param options the options to fill in
+  * @param argc    the number of command line arguments
+  * @param argv    the command line arguments
+  * @return an indication of whether an error occurred
+  */
+status_t options_parse(options_t *options, int argc, char *argv[]);
+
+/**
+  * Reads a configuration file of "name = value" lines into the options. The names are the long
+  * command line option names, and blank lines and lines starting with '#' are ignored
+  * @param options the options to fill in
+  * @param path    the path to the configuration file
+  * @return an indication of whether an error occurred
+  */
+status_t options_read_config(options_t *options, const char *path);
+
+/**
+  * Prints a summary of the command line usage
+  * @param program the name the program was run as
+  */
+void options_usage(const char *program);
+#endif
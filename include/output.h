@@ -0,0 +1,94 @@
+#ifndef _OUTPUT_H_
+#define _OUTPUT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "status.h"
+
+/**
+  * The size of the buffer that output is gathered in before it is written out
+  */
+#define OUTPUT_BUFFER_BYTES (1 << 20)
+
+/**
+  * The formats that the line printed for every reference can take:
+  *   OUTPUT_TEXT   - "Virtual address: v Physical address: p Value: x", as in the assignment
+  *   OUTPUT_CSV    - a "virtual,physical,value" header and then one such line per reference
+  *   OUTPUT_BINARY - one output_record_t per reference
+  *   OUTPUT_NONE   - nothing at all, leaving only the statistics at the end
+  */
+typedef enum
+{
+	OUTPUT_TEXT,
+	OUTPUT_CSV,
+	OUTPUT_BINARY,
+	OUTPUT_NONE
+} output_format_t;
+
+/**
+  * A single reference in the binary format, in the byte order of the machine which wrote it
+  */
+typedef struct
+{
+	uint64_t virtual_address;
+	uint64_t physical_address;
+	int8_t value;
+	uint8_t reserved[7];
+} output_record_t;
+
+/**
+  * A writer which formats references into a large buffer itself, without going through printf,
+  * and hands the buffer to stdio only when it fills up
+  */
+typedef struct
+{
+	FILE *file;
+	output_format_t format;
+	char *buffer;
+	size_t length;
+	status_t error;
+} output_t;
+
+/**
+  * Looks up an output format by name ("text", "csv", "binary" or "none")
+  * @param name   the name of the format
+  * @param format out param which will hold the format
+  * @return an indication of whether an error occurred
+  */
+status_t output_format_find(const char *name, output_format_t *format);
+
+/**
+  * Initializes an output writer, writing the CSV header if there is one
+  * @param out    the writer to initialize
+  * @param file   the file to write to
+  * @param format the format of the references
+  * @return an indication of whether an error occurred
+  */
+status_t output_initialize(output_t *out, FILE *file, output_format_t format);
+
+/**
+  * Flushes and uninitializes an output writer after it is no longer needed
+  * @param out the writer to uninitialize
+  * @return an indication of whether an error occurred while writing
+  */
+status_t output_uninitialize(output_t *out);
+
+/**
+  * Writes out everything buffered so far
+  * @param out the writer to flush
+  * @return an indication of whether an error occurred while writing
+  */
+status_t output_flush(output_t *out);
+
+/**
+  * Writes the line for a single reference in the writer's format. Any error in writing is kept
+  * until the next flush
+  * @param out              the writer
+  * @param virtual_address  the virtual address referenced
+  * @param physical_address the physical address it translated to
+  * @param value            the value at the address
+  */
+void output_reference(output_t *out, uint64_t virtual_address, uint64_t physical_address, int8_t value);
+#endif
@@ -0,0 +1,171 @@
+#ifndef _PAGE_TABLE_H_
+#define _PAGE_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "snapshot.h"
+#include "status.h"
+
+/**
+  * The most bits of a tag a flat page table may be indexed by, and the bits of a tag resolved by
+  * each level of a radix page table, so that a node of 512 entries fills a 4KB page as it would on
+  * x86-64
+  */
+#define MAX_FLAT_BITS 31
+#define RADIX_BITS    9
+#define RADIX_FANOUT  (1 << RADIX_BITS)
+
+/**
+  * Marks the end of a chain of the hashed page table
+  */
+#define HASHED_END -1
+
+/**
+  * The designs of page table:
+  *   PAGE_TABLE_AUTO   - flat when every tag fits in MAX_FLAT_BITS, and radix otherwise, without
+  *                       printing the statistics of the page table
+  *   PAGE_TABLE_FLAT   - one array with an entry for every possible tag, found in one reference
+  *   PAGE_TABLE_RADIX  - a tree of levels of RADIX_FANOUT entries each, like the page tables of
+  *                       x86-64, whose nodes are only allocated once a page beneath them is mapped
+  *   PAGE_TABLE_HASHED - an inverted page table, with one entry for every frame, chained from a
+  *                       hash table of the tags of the resident pages
+  */
+typedef enum
+{
+	PAGE_TABLE_AUTO,
+	PAGE_TABLE_FLAT,
+	PAGE_TABLE_RADIX,
+	PAGE_TABLE_HASHED
+} page_table_kind_t;
+
+/**
+  * Used to represent a single entry in a page table, including which frame is being referenced,
+  * whether the reference is currently valid, whether the page was read ahead and has not been
+  * referenced since, and whether it was read in to complete a huge page and has not been referenced
+  * since
+  */
+typedef struct
+{
+	uint32_t frame;
+	uint8_t valid;
+	uint8_t dirty;
+	uint8_t prefetched;
+	uint8_t filled;
+} page_entry_t;
+
+/**
+  * An entry of the hashed page table, belonging to a frame: the page entry of the page in the
+  * frame, that page's tag, and the next frame in its chain
+  */
+typedef struct
+{
+	page_entry_t entry;
+	uint64_t tag;
+	int32_t next;
+} hashed_entry_t;
+
+/**
+  * The page table of every process, indexed by tag, the page number with the number of its
+  * process above it. A radix table resolves the tag RADIX_BITS at a time from the top, the root
+  * taking whatever bits are left over. Levels are added with an atomic compare and swap so that
+  * cores holding the locks of different shards may map pages beneath the same missing node at
+  * once. The chains of the hashed table are picked by the low shard_bits of the tag as well as by
+  * its hash, so that a chain only ever holds pages of one shard. footprint counts the bytes
+  * allocated for the table
+  */
+typedef struct
+{
+	page_table_kind_t kind;
+	unsigned int tag_bits;
+	unsigned int levels;
+	unsigned int root_bits;
+	page_entry_t *flat;
+	void **root;
+	hashed_entry_t *hashed;
+	int32_t *anchors;
+	unsigned int anchor_bits;
+	unsigned int shard_bits;
+	size_t footprint;
+} page_table_t;
+
+/**
+  * Looks up a page table design by name ("auto", "flat", "radix" or "hashed")
+  * @param name the name of the design
+  * @param kind out param which will hold the design
+  * @return an indication of whether an error occurred
+  */
+status_t page_table_kind_find(const char *name, page_table_kind_t *kind);
+
+/**
+  * Initializes an empty page table
+  * @param table         the page table to initialize
+  * @param kind          the design of the table; not PAGE_TABLE_AUTO
+  * @param tag_bits      the number of bits in a tag, at most MAX_FLAT_BITS for a flat table
+  * @param number_frames the number of frames, which a hashed table has an entry for each of
+  * @param shard_bits    the number of low bits of a tag which pick its shard of the frames
+  * @return an indication of whether an error occurred
+  */
+status_t page_table_initialize(page_table_t *table, page_table_kind_t kind, unsigned int tag_bits, size_t number_frames, unsigned int shard_bits);
+
+/**
+  * Uninitializes a page table after it is no longer needed
+  * @param table the page table to uninitialize
+  */
+void page_table_uninitialize(page_table_t *table);
+
+/**
+  * Finds the entry of a page, as a walk of the table would
+  * @param table      the page table
+  * @param tag        the tag of the page
+  * @param references if not NULL, has the number of entries the walk read added to it
+  * @return the entry of the page, which is only resident if valid is set, or NULL if the table has
+  * no entry for it
+  */
+page_entry_t *page_table_find(page_table_t *table, uint64_t tag, size_t *references);
+
+/**
+  * Maps a page to a frame, marking its entry valid, clean, not read ahead and not filled. The page
+  * must not already be mapped, and in a hashed table the frame must have been unmapped first
+  * @param table the page table
+  * @param tag   the tag of the page
+  * @param frame the frame
+  * @return the entry of the page, or NULL if a level of a radix table could not be allocated
+  */
+page_entry_t *page_table_map(page_table_t *table, uint64_t tag, uint32_t frame);
+
+/**
+  * Unmaps a resident page. Its entry keeps everything but its validity until the frame is mapped
+  * again
+  * @param table the page table
+  * @param tag   the tag of the page
+  */
+void page_table_unmap(page_table_t *table, uint64_t tag);
+
+/**
+  * Writes a page table to a snapshot: the entries of the resident pages, and whatever else decides
+  * the cost of later walks, which is the levels allocated in a radix table and the order of the
+  * chains of a hashed one
+  * @param table         the page table
+  * @param tags          the tags of every resident page
+  * @param count         the number of resident pages
+  * @param number_frames the number of frames
+  * @param writer        the snapshot being written
+  */
+void page_table_save(page_table_t *table, const uint64_t *tags, size_t count, size_t number_frames, snapshot_writer_t *writer);
+
+/**
+  * Fills an empty page table of the same design and size with one read from a snapshot. Every
+  * resident page must be mapped to a frame in range, and the chains of a hashed table must hold
+  * exactly count distinct frames, each under the chain of its tag; whether each page is mapped to
+  * the frame which holds it is left to the caller
+  * @param table         the page table, in which nothing has been mapped
+  * @param tags          the tags of every resident page, in the order they were saved
+  * @param count         the number of resident pages
+  * @param number_frames the number of frames
+  * @param reader        the snapshot being read
+  * @return FORM_ERROR if the table read could not have been saved, or otherwise an indication of
+  * whether an error occurred
+  */
+status_t page_table_restore(page_table_t *table, const uint64_t *tags, size_t count, size_t number_frames, snapshot_reader_t *reader);
+#endif
@@ -0,0 +1,77 @@
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "backing_store.h"
+#include "status.h"
+
+/**
+  * The most pages which can be read ahead of the references that need them at once, and the most
+  * I/O workers which may read them
+  */
+#define PIPELINE_SLOTS       64
+#define MAX_PIPELINE_WORKERS 64
+
+/**
+  * Reads pages of the backing store on a pool of I/O worker threads, ahead of the page faults
+  * which will need them, so that the simulation carries on with resident pages in the meantime.
+  * Each slot holds one page: free, queued for a worker, being read, or read and waiting for its
+  * fault. Workers take queued pages in the order they were issued. A fault takes its page out of
+  * a slot, waiting if a worker is still reading it, and reads the page itself if it was never
+  * issued, so the pipeline changes when a page is read but never what is read
+  */
+typedef struct
+{
+	backing_store_t *store;
+	int8_t *buffers;
+	uint64_t pages[PIPELINE_SLOTS];
+	uint64_t sequences[PIPELINE_SLOTS];
+	uint8_t states[PIPELINE_SLOTS];
+	uint64_t issued;
+	size_t queued;
+	uint8_t stopping;
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	pthread_t *workers;
+	size_t number_workers;
+} pipeline_t;
+
+/**
+  * Initializes a pipeline over a backing store and starts its workers
+  * @param pipeline       the pipeline to initialize
+  * @param store          the backing store to read from, which must allow reads from several
+  *                       threads at once
+  * @param number_workers the number of I/O worker threads, from 1 to MAX_PIPELINE_WORKERS
+  * @return an indication of whether an error occurred
+  */
+status_t pipeline_initialize(pipeline_t *pipeline, backing_store_t *store, size_t number_workers);
+
+/**
+  * Stops the workers, once they have finished the pages they are reading, and uninitializes the
+  * pipeline. Pages which were issued but never taken are dropped
+  * @param pipeline the pipeline to uninitialize
+  */
+void pipeline_uninitialize(pipeline_t *pipeline);
+
+/**
+  * Asks for a page to be read ahead. Does nothing if the page is already in a slot
+  * @param pipeline the pipeline
+  * @param page     the number of the page
+  * @return whether the page is now in a slot, which it is not when every slot is taken
+  */
+uint8_t pipeline_issue(pipeline_t *pipeline, uint64_t page);
+
+/**
+  * Copies the contents of a page into the given buffer, from its slot if it was issued and
+  * otherwise straight from the backing store, freeing the slot
+  * @param pipeline the pipeline
+  * @param page     the number of the page
+  * @param dest     the buffer of page_bytes bytes to copy into
+  * @return an indication of whether an error occurred
+  */
+status_t pipeline_read(pipeline_t *pipeline, uint64_t page, int8_t *dest);
+#endif
@@ -0,0 +1,168 @@
+#ifndef _POLICY_H_
+#define _POLICY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "snapshot.h"
+#include "status.h"
+
+/**
+  * The name of the policy used when none is given
+  */
+#define DEFAULT_POLICY "lru"
+
+typedef struct policy_t policy_t;
+
+/**
+  * The operations every replacement policy provides. A policy manages the slots 0 to capacity - 1
+  * (frames in the frame table, or entries in the TLB), each of which holds the item with some key
+  * (a page number). The caller fills empty slots itself and only asks for a victim once every slot
+  * is in use:
+  *   hit          - the item in an occupied slot has been referenced again
+  *   insert       - the slot has just been filled with the item with the given key, which is
+  *                  being referenced for the first time since it was brought in
+  *   victim       - choose an occupied slot to make room for the item with the given key and stop
+  *                  tracking it; the caller will then insert into that same slot
+  *   remove       - stop tracking an occupied slot which has been emptied without a replacement
+  *   insert_cold  - like insert, but the item was brought in ahead of being referenced and so is
+  *                  given none of the credit of a reference; a policy which orders items only by
+  *                  when they arrived or were last referenced leaves this NULL, and the item is
+  *                  inserted as usual
+  *   save         - write the whole state of the policy, in the order of its slots, to a snapshot
+  *   restore      - replace the whole state of the policy with one it saved, for the same number
+  *                  of slots, which must track exactly the slots marked occupied; a policy which
+  *                  cannot be saved, such as one which depends on the future of a particular
+  *                  trace, leaves both NULL
+  * An offline policy also needs to know the future of the trace, given with policy_set_future
+  * before the first reference
+  */
+typedef struct
+{
+	const char *name;
+	status_t (*initialize)(policy_t *policy);
+	void (*uninitialize)(policy_t *policy);
+	void (*hit)(policy_t *policy, int slot, uint8_t is_write);
+	void (*insert)(policy_t *policy, int slot, uint64_t key, uint8_t is_write);
+	int (*victim)(policy_t *policy, uint64_t key);
+	void (*remove)(policy_t *policy, int slot);
+	uint8_t offline;
+	void (*insert_cold)(policy_t *policy, int slot, uint64_t key);
+	void (*save)(policy_t *policy, snapshot_writer_t *writer);
+	status_t (*restore)(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied);
+} policy_ops_t;
+
+/**
+  * A replacement policy instance, with the operations of its kind and that kind's private state.
+  * Offline policies also see the next-use index of the trace and the index of the reference
+  * currently being simulated
+  */
+struct policy_t
+{
+	const policy_ops_t *ops;
+	int capacity;
+	void *state;
+	const uint32_t *next_use;
+	const size_t *position;
+};
+
+extern const policy_ops_t lru_policy_ops;
+extern const policy_ops_t fifo_policy_ops;
+extern const policy_ops_t clock_policy_ops;
+extern const policy_ops_t second_chance_policy_ops;
+extern const policy_ops_t lfu_policy_ops;
+extern const policy_ops_t arc_policy_ops;
+extern const policy_ops_t two_queue_policy_ops;
+extern const policy_ops_t opt_policy_ops;
+extern const policy_ops_t plru_policy_ops;
+
+/**
+  * Looks up a policy kind by name
+  * @param name the name of the policy, e.g. "lru" or "clock"
+  * @return the operations of the policy, or NULL if there is no policy with that name
+  */
+const policy_ops_t *policy_find(const char *name);
+
+/**
+  * Prints the names of all of the policies, separated by spaces
+  * @param out the file to print to
+  */
+void policy_print_names(FILE *out);
+
+/**
+  * Initializes a policy of the named kind over the given number of slots, all initially empty
+  * @param policy   the policy to initialize
+  * @param name     the name of the policy
+  * @param capacity the number of slots
+  * @return an indication of whether an error occurred
+  */
+status_t policy_initialize(policy_t *policy, const char *name, int capacity);
+
+/**
+  * Gives an offline policy the future of the trace
+  * @param policy   the policy
+  * @param next_use the next-use index of the whole trace (see trace_next_use)
+  * @param position points to the index of the reference currently being simulated
+  */
+void policy_set_future(policy_t *policy, const uint32_t *next_use, const size_t *position);
+
+/**
+  * Uninitializes a policy after it is no longer needed
+  * @param policy the policy to uninitialize
+  */
+void policy_uninitialize(policy_t *policy);
+
+/**
+  * Writes the state of a policy to a snapshot
+  * @param policy the policy
+  * @param writer the snapshot being written
+  * @return OPTN_ERROR if the policy cannot be saved, and otherwise SUCCESS; any error writing is
+  * left in the writer
+  */
+status_t policy_save(policy_t *policy, snapshot_writer_t *writer);
+
+/**
+  * Replaces the state of a policy with one read from a snapshot, which a policy of the same kind
+  * over the same number of slots saved
+  * @param policy   the policy
+  * @param reader   the snapshot being read
+  * @param occupied whether each slot is in use, which the restored state must agree with
+  * @return OPTN_ERROR if the policy cannot be restored, FORM_ERROR if the state read is not one the
+  * policy could have saved over the occupied slots, or an indication of whether an error occurred
+  * restoring it; any error reading is left in the reader
+  */
+status_t policy_restore(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied);
+
+static inline void policy_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+	policy->ops->hit(policy, slot, is_write);
+}
+
+static inline void policy_insert(policy_t *policy, int slot, uint64_t key, uint8_t is_write)
+{
+	policy->ops->insert(policy, slot, key, is_write);
+}
+
+static inline void policy_insert_cold(policy_t *policy, int slot, uint64_t key)
+{
+	if (policy->ops->insert_cold != NULL)
+	{
+		policy->ops->insert_cold(policy, slot, key);
+	}
+	else
+	{
+		policy->ops->insert(policy, slot, key, 0);
+	}
+}
+
+static inline int policy_victim(policy_t *policy, uint64_t key)
+{
+	return policy->ops->victim(policy, key);
+}
+
+static inline void policy_remove(policy_t *policy, int slot)
+{
+	policy->ops->remove(policy, slot);
+}
+#endif
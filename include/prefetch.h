@@ -0,0 +1,68 @@
+#ifndef _PREFETCH_H_
+#define _PREFETCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "status.h"
+
+/**
+  * The most pages which may be read ahead of a single reference
+  */
+#define MAX_PREFETCH_DEGREE 64
+
+/**
+  * What the prefetcher has seen of one process: the last page it watched, the distance from the
+  * page before that, and how many times in a row that distance has repeated. A distance of one
+  * page either way, a sequential scan, is trusted the first time it is seen, any other stride only
+  * once it has repeated
+  */
+typedef struct
+{
+	uint64_t last;
+	int64_t stride;
+	unsigned int confidence;
+	uint8_t started;
+} prefetch_stream_t;
+
+/**
+  * Predicts which pages each process will fault on next, from the pages it has faulted on so far.
+  * The caller reports every fault, and every first reference to a page which was read ahead, so
+  * that a stream which is being prefetched successfully keeps on being recognised
+  */
+typedef struct
+{
+	size_t degree;
+	prefetch_stream_t *streams;
+	size_t number_streams;
+} prefetch_t;
+
+/**
+  * Initializes a prefetcher for the given number of independent streams
+  * @param prefetch       the prefetcher to initialize
+  * @param number_streams the number of streams, one for each process
+  * @param degree         the most pages to predict after each reference, at most
+  *                       MAX_PREFETCH_DEGREE
+  * @return an indication of whether an error occurred
+  */
+status_t prefetch_initialize(prefetch_t *prefetch, size_t number_streams, size_t degree);
+
+/**
+  * Uninitializes a prefetcher after it is no longer needed
+  * @param prefetch the prefetcher to uninitialize
+  */
+void prefetch_uninitialize(prefetch_t *prefetch);
+
+/**
+  * Watches a reference of a stream and predicts the pages which will follow it
+  * @param prefetch     the prefetcher
+  * @param stream       the stream the reference belongs to
+  * @param page         the page which was referenced
+  * @param number_pages the number of pages in the address space; no page at or past it is
+  *                     predicted
+  * @param predicted    out param which will hold the predicted pages, nearest first, with room
+  *                     for the degree of the prefetcher
+  * @return the number of pages predicted, none if no pattern has been recognised
+  */
+size_t prefetch_observe(prefetch_t *prefetch, size_t stream, uint64_t page, uint64_t number_pages, uint64_t *predicted);
+#endif
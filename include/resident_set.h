@@ -0,0 +1,146 @@
+#ifndef _RESIDENT_SET_H_
+#define _RESIDENT_SET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "status.h"
+
+/**
+  * The window used when none is given, in references of the process
+  */
+#define DEFAULT_RESIDENT_WINDOW 1000
+
+/**
+  * The most samples kept of the frames in use over time
+  */
+#define RESIDENT_SAMPLES 32
+
+/**
+  * Returned when no frame of a process has expired
+  */
+#define RESIDENT_NONE -1
+
+/**
+  * How the frames of each process are decided:
+  *   RESIDENT_OFF   - they are not tracked at all, and only the replacement policy evicts pages
+  *   RESIDENT_FIXED - they are tracked and reported, but only the replacement policy evicts pages
+  *   RESIDENT_WS    - a page leaves the resident set once it has not been referenced in the last
+  *                    window references of its process, its working set
+  *   RESIDENT_PFF   - page fault frequency: a fault more than window references of its process
+  *                    after the one before it releases every page not referenced in between, and
+  *                    a fault sooner than that only adds its page
+  */
+typedef enum
+{
+	RESIDENT_OFF,
+	RESIDENT_FIXED,
+	RESIDENT_WS,
+	RESIDENT_PFF
+} resident_policy_t;
+
+/**
+  * The resident set of a process: its virtual time, counted in its own references, the time of its
+  * last fault, the frames it holds now and at most, the frames released from it, and its
+  * space-time product, the sum over its references of the frames it held
+  */
+typedef struct
+{
+	uint64_t clock;
+	uint64_t last_fault;
+	size_t resident;
+	size_t peak;
+	size_t released;
+	uint64_t space_time;
+} resident_process_t;
+
+/**
+  * Tracks the resident set of every process. The frames of each process are kept in a circular
+  * list from the most to the least recently referenced, linked by frame number, with one extra
+  * node per process after the frames as the head of its list, so that the pages which have left
+  * the working set are always found at the tail. in_use counts the frames of every process, peak
+  * the most there have been, and time and space_time are those of the whole run, counted in
+  * references of any process. The frames in use are sampled every interval references, and when
+  * the samples run out every other one is dropped and the interval doubled
+  */
+typedef struct
+{
+	resident_policy_t policy;
+	uint64_t window;
+	size_t number_frames;
+	size_t number_processes;
+	int32_t *next;
+	int32_t *prev;
+	uint32_t *owner;
+	uint64_t *last_reference;
+	resident_process_t *processes;
+	size_t in_use;
+	size_t peak;
+	uint64_t time;
+	uint64_t space_time;
+	size_t samples[RESIDENT_SAMPLES];
+	size_t number_samples;
+	uint64_t interval;
+} resident_set_t;
+
+/**
+  * Looks up a resident set policy by name ("off", "fixed", "ws" or "pff")
+  * @param name   the name of the policy
+  * @param policy out param which will hold the policy
+  * @return an indication of whether an error occurred
+  */
+status_t resident_policy_find(const char *name, resident_policy_t *policy);
+
+/**
+  * Initializes the resident sets with no frames in use
+  * @param rs               the resident sets to initialize
+  * @param policy           how the frames of each process are decided; not RESIDENT_OFF
+  * @param window           the working set window, or the fault interval of PFF, in references
+  * @param number_frames    the number of frames
+  * @param number_processes the number of processes
+  * @return an indication of whether an error occurred
+  */
+status_t resident_set_initialize(resident_set_t *rs, resident_policy_t policy, uint64_t window, size_t number_frames, size_t number_processes);
+
+/**
+  * Uninitializes the resident sets after they are no longer needed
+  * @param rs the resident sets to uninitialize
+  */
+void resident_set_uninitialize(resident_set_t *rs);
+
+/**
+  * Adds a frame which has just been filled to the resident set of a process
+  * @param rs      the resident sets
+  * @param process the process
+  * @param frame   the frame
+  */
+void resident_set_insert(resident_set_t *rs, uint32_t process, uint32_t frame);
+
+/**
+  * Removes a frame which has been emptied from the resident set it was in
+  * @param rs    the resident sets
+  * @param frame the frame
+  */
+void resident_set_remove(resident_set_t *rs, uint32_t frame);
+
+/**
+  * Records a reference of a process to the page in a frame, and decides which of its pages have
+  * left its resident set
+  * @param rs      the resident sets
+  * @param process the process
+  * @param frame   the frame referenced
+  * @param faulted whether the reference faulted
+  * @return the time before which a page of the process must have been last referenced to leave its
+  * resident set, or 0 if none leaves
+  */
+uint64_t resident_set_reference(resident_set_t *rs, uint32_t process, uint32_t frame, uint8_t faulted);
+
+/**
+  * Finds the least recently referenced frame of a process, if its page has left the resident set
+  * @param rs      the resident sets
+  * @param process the process
+  * @param cutoff  the time returned by resident_set_reference
+  * @return the frame, or RESIDENT_NONE if the page has not left
+  */
+int32_t resident_set_expired(resident_set_t *rs, uint32_t process, uint64_t cutoff);
+#endif
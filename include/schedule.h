@@ -0,0 +1,58 @@
+#ifndef _SCHEDULE_H_
+#define _SCHEDULE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "status.h"
+#include "trace.h"
+
+/**
+  * Interleaves the address files of several processes into one stream of references, round robin,
+  * a quantum of references from each process at a time. A process drops out of the rotation once
+  * its address file is finished. Each reference in the stream carries the number of its process
+  * in the bits above address_bits, which in turn are cleared of anything the process itself put
+  * there. A single process is passed through untouched
+  */
+typedef struct
+{
+	trace_file_t *files;
+	trace_t *traces;
+	size_t *positions;
+	uint8_t *finished;
+	size_t number;
+	size_t quantum;
+	size_t current;
+	size_t remaining;
+	size_t active;
+	unsigned int address_bits;
+	trace_t merged;
+} schedule_t;
+
+/**
+  * Opens the address file of every process
+  * @param schedule     the schedule to open
+  * @param paths        the paths of the address files, one per process
+  * @param number       the number of processes
+  * @param quantum      the number of references each process runs for before the next one
+  * @param address_bits the width of a virtual address within a process
+  * @return an indication of whether an error occurred
+  */
+status_t schedule_open(schedule_t *schedule, char **paths, size_t number, size_t quantum, unsigned int address_bits);
+
+/**
+  * Closes every address file after they are no longer needed
+  * @param schedule the schedule to close
+  */
+void schedule_close(schedule_t *schedule);
+
+/**
+  * Reads the next references of the interleaved stream
+  * @param schedule the schedule
+  * @param max      the most references to read, or TRACE_ALL for the rest of the stream
+  * @param batch    out param which will point to the references read, which stay valid until the
+  *                 next call; its length is 0 at the end of the stream
+  * @return an indication of whether an error occurred
+  */
+status_t schedule_read(schedule_t *schedule, size_t max, trace_t **batch);
+#endif
@@ -0,0 +1,104 @@
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "status.h"
+
+/**
+  * The magic bytes which open every snapshot file, and the version of the layout of what follows.
+  * The version is raised whenever that layout changes, and a snapshot of any other version is
+  * refused rather than misread
+  */
+#define SNAPSHOT_MAGIC   "MMSNAP\r\n"
+#define SNAPSHOT_VERSION 1
+
+/**
+  * Every field of a snapshot starts on a multiple of SNAPSHOT_ALIGN bytes from the start of the
+  * file, so that arrays of any type can be used in place once the file is mapped
+  */
+#define SNAPSHOT_ALIGN 8
+
+/**
+  * Writes a snapshot, field by field, each padded out to SNAPSHOT_ALIGN. offset is the number of
+  * bytes written so far, and the first error stops anything more from being written, so that the
+  * fields may be written one after another and error checked once with snapshot_finish
+  */
+typedef struct
+{
+	FILE *file;
+	uint64_t offset;
+	status_t error;
+} snapshot_writer_t;
+
+/**
+  * Reads a snapshot which has been mapped whole into memory, field by field in the order they were
+  * written. offset is the start of the next field, and the first error, a field running past the
+  * end of the file, stops anything more from being read
+  */
+typedef struct
+{
+	uint8_t *data;
+	size_t length;
+	size_t offset;
+	status_t error;
+} snapshot_reader_t;
+
+/**
+  * Creates a snapshot file, writing its magic and version
+  * @param writer the writer to initialize
+  * @param path   the path of the file, which is replaced if it exists
+  * @return an indication of whether an error occurred
+  */
+status_t snapshot_create(snapshot_writer_t *writer, const char *path);
+
+/**
+  * Writes the next field of a snapshot
+  * @param writer the writer
+  * @param data   the bytes of the field
+  * @param bytes  the number of bytes in the field
+  */
+void snapshot_write(snapshot_writer_t *writer, const void *data, size_t bytes);
+
+/**
+  * Finishes a snapshot, closing its file
+  * @param writer the writer
+  * @return the first error met while writing any field, or while closing the file
+  */
+status_t snapshot_finish(snapshot_writer_t *writer);
+
+/**
+  * Maps a snapshot file and checks its magic and version
+  * @param reader the reader to initialize
+  * @param path   the path of the file
+  * @return an indication of whether an error occurred; FORM_ERROR if the file is not a snapshot of
+  * this version
+  */
+status_t snapshot_open(snapshot_reader_t *reader, const char *path);
+
+/**
+  * Finds the next field of a snapshot in place, in the mapping of the file
+  * @param reader the reader
+  * @param bytes  the number of bytes in the field
+  * @return the bytes of the field, or NULL if the file ends before it does
+  */
+const void *snapshot_section(snapshot_reader_t *reader, size_t bytes);
+
+/**
+  * Copies the next field of a snapshot out of the file. If the file ends before it does, data is
+  * left alone
+  * @param reader the reader
+  * @param data   where the field is copied to
+  * @param bytes  the number of bytes in the field
+  */
+void snapshot_read(snapshot_reader_t *reader, void *data, size_t bytes);
+
+/**
+  * Unmaps a snapshot file after it has been read
+  * @param reader the reader
+  * @return the first error met while reading any field
+  */
+status_t snapshot_close(snapshot_reader_t *reader);
+#endif
@@ -0,0 +1,43 @@
+#ifndef _STACK_DISTANCE_H_
+#define _STACK_DISTANCE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash_map.h"
+#include "status.h"
+
+/**
+  * The distance reported for the first reference to a page
+  */
+#define STACK_DISTANCE_INFINITE UINT64_MAX
+
+/**
+  * Computes LRU stack (reuse) distances one reference at a time: the number of distinct other pages
+  * referenced since the previous reference to the same page. Every page's latest reference takes a
+  * time slot, marked in a Fenwick tree, so a distance is the count of marks after the page's slot,
+  * which costs O(log slots). When the slots run out they are renumbered densely in order, so the
+  * memory used grows with the number of distinct pages rather than with the length of the trace
+  */
+typedef struct
+{
+	hash_map_t last_slot;
+	uint32_t *tree;
+	uint64_t *slot_pages;
+	size_t capacity;
+	size_t next;
+	size_t live;
+} stack_distance_t;
+
+status_t stack_distance_initialize(stack_distance_t *sd);
+void stack_distance_uninitialize(stack_distance_t *sd);
+
+/**
+  * Records a reference to a page and computes its stack distance
+  * @param sd       the stack distance tracker
+  * @param page     the page being referenced
+  * @param distance out param which will hold the stack distance, or STACK_DISTANCE_INFINITE
+  * @return an indication of whether an error occurred
+  */
+status_t stack_distance_access(stack_distance_t *sd, uint64_t page, uint64_t *distance);
+#endif
@@ -0,0 +1,28 @@
+#ifndef _STATUS_H_
+#define _STATUS_H_
+
+#include <stdint.h>
+
+/**
+  * Define error constants. Contain a mixture of user (e.g., not enough command line arguments) and
+  * system (e.g., couldn't read from an open file) errors
+  */
+#define SUCCESS    0
+#define ARGS_ERROR 1
+#define OPEN_ERROR 2
+#define NUMB_ERROR 3
+#define SEEK_ERROR 4
+#define READ_ERROR 5
+#define OPTN_ERROR 6
+#define GEOM_ERROR 7
+#define ALOC_ERROR 8
+#define WRIT_ERROR 9
+#define FORM_ERROR 10
+
+/**
+  * Define the type for the erorrs. Allows for a total of 2^64 - 1 types of error conditions (plus a
+  * succcess condition)
+  */
+typedef uint64_t status_t;
+
+#endif
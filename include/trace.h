@@ -0,0 +1,159 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "status.h"
+
+/**
+  * The number of references read at a time when the whole trace is not needed at once, and the
+  * value of max which reads the whole trace
+  */
+#define TRACE_BATCH 65536
+#define TRACE_ALL   SIZE_MAX
+
+/**
+  * The size of the buffer an address file which cannot be mapped is read through, which bounds
+  * the longest line it may hold
+  */
+#define TRACE_STREAM_BYTES 65536
+
+/**
+  * Marks a reference whose page is never referenced again
+  */
+#define NEVER_USED UINT32_MAX
+
+/**
+  * The binary trace format. The file starts with a header of the magic string, the version and the
+  * number of references, count. After it come count 64-bit addresses and then count bytes which
+  * are 1 for a write and 0 for a read, so that both arrays can be used straight from a mapping of
+  * the file. All values are in the byte order of the machine which wrote the file; a file from a
+  * machine of the other byte order is rejected because its version does not match
+  */
+#define TRACE_MAGIC   "MMTRACE"
+#define TRACE_VERSION 1
+
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t count;
+} trace_header_t;
+
+/**
+  * Holds a run of references from an address file as two parallel arrays: the virtual address of
+  * each reference and whether it was a write. When borrowed is set the arrays point into a mapped
+  * binary trace rather than being owned by the trace
+  */
+typedef struct
+{
+	uint64_t *addresses;
+	uint8_t *writes;
+	size_t length;
+	size_t capacity;
+	uint8_t borrowed;
+} trace_t;
+
+/**
+  * An open address file, either a text file of one reference per line or a binary trace. A text
+  * file may also hold the records Valgrind's lackey tool prints with --trace-mem=yes, of the form
+  * " L addr,size", " S addr,size" or " M addr,size" with the address in hexadecimal: a load is a
+  * read, a store a write, and a modify a read and then a write, each of the first byte only.
+  * Instruction fetches ("I addr,size") and lines starting with "==" are skipped. Regular files are
+  * mapped into memory and read from the mapping; anything which cannot be mapped, such as a pipe,
+  * is read through buffer instead, which holds the buffered bytes not yet made into references
+  */
+typedef struct
+{
+	FILE *file;
+	const char *map;
+	size_t size;
+	size_t position;
+	uint8_t binary;
+	uint64_t count;
+	char *buffer;
+	size_t buffered;
+} trace_file_t;
+
+/**
+  * Opens an address file, recognizing a binary trace from its header
+  * @param fin  the address file to open
+  * @param path the path of the address file, or "-" for the standard input
+  * @return an indication of whether an error occurred
+  */
+status_t trace_open(trace_file_t *fin, const char *path);
+
+/**
+  * Closes an address file after it is no longer needed
+  * @param fin the address file to close
+  */
+void trace_close(trace_file_t *fin);
+
+/**
+  * Initializes an empty trace
+  * @param trace the trace to initialize
+  */
+void trace_initialize(trace_t *trace);
+
+/**
+  * Uninitializes a trace after it is no longer needed
+  * @param trace the trace to uninitialize
+  */
+void trace_uninitialize(trace_t *trace);
+
+/**
+  * Replaces the contents of the trace with the next references from the address file. Lines which
+  * cannot be converted are reported on stderr and skipped. References from a binary trace are not
+  * copied; the trace borrows them from the mapping until the next call. Unless the whole file is
+  * read, a file which cannot be mapped gives only the references which have arrived, waiting only
+  * while there are none, so that a live stream is simulated as it comes. A read interrupted by a
+  * signal ends the file
+  * @param trace the trace to fill
+  * @param fin   the address file
+  * @param max   the most references to read, or TRACE_ALL for the rest of the file
+  * @return an indication of whether an error occurred; trace->length is 0 at the end of the file
+  */
+status_t trace_read(trace_t *trace, trace_file_t *fin, size_t max);
+
+/**
+  * Appends a reference to a trace which owns its arrays, growing it if necessary
+  * @param trace    the trace
+  * @param address  the address of the reference
+  * @param is_write whether the reference is a write
+  * @return an indication of whether an error occurred
+  */
+status_t trace_append(trace_t *trace, uint64_t address, uint8_t is_write);
+
+/**
+  * Converts a single line of an address file, of the form "address", "address R" or "address W"
+  * with an optional trailing space, into a reference
+  * @param line     the line, including its line ending
+  * @param length   the length of the line
+  * @param address  out param which will hold the address
+  * @param is_write out param which will hold whether the reference is a write
+  * @return an indication of whether an error occurred
+  */
+status_t trace_parse_line(const char *line, size_t length, uint64_t *address, uint8_t *is_write);
+
+/**
+  * Writes references out as a binary trace, replacing the file at path
+  * @param trace the references to write
+  * @param path  the path of the binary trace
+  * @return an indication of whether an error occurred
+  */
+status_t trace_save(trace_t *trace, const char *path);
+
+/**
+  * Builds the next-use index of a trace in a single backward pass: for every reference, the index
+  * of the next reference to the same page, or NEVER_USED if there is none
+  * @param trace       the whole trace
+  * @param offset_bits the number of bits of an address which make up the page offset
+  * @param page_mask   the mask applied to an address shifted right by offset_bits to get its page
+  * @param next_use    out param which will hold the newly allocated index
+  * @return an indication of whether an error occurred
+  */
+status_t trace_next_use(trace_t *trace, unsigned int offset_bits, uint64_t page_mask, uint32_t **next_use);
+#endif
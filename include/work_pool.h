@@ -0,0 +1,65 @@
+#ifndef _WORK_POOL_H_
+#define _WORK_POOL_H_
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "status.h"
+
+/**
+  * The most threads a pool may run its tasks on
+  */
+#define MAX_WORK_THREADS 256
+
+/**
+  * Runs a single task, given the context it was passed with and the number of the task
+  */
+typedef status_t (*work_pool_task_t)(void *context, size_t task);
+
+typedef struct work_pool_t work_pool_t;
+
+/**
+  * A thread of the pool and the tasks it still has to run, next up to end - 1, under its lock. The
+  * thread takes its tasks from the front, while a thread which has run out steals the back half of
+  * another's from the end, so that tasks stay in order on each thread and a thread given slow ones
+  * is helped by the rest
+  */
+typedef struct
+{
+	pthread_t thread;
+	pthread_mutex_t lock;
+	size_t next;
+	size_t end;
+	size_t steals;
+	work_pool_t *pool;
+} work_thread_t;
+
+/**
+  * A pool of threads sharing out a fixed number of tasks by work stealing. The tasks are split
+  * evenly between the threads up front, the calling thread being the first of them. Once a task
+  * has failed, under error_lock, the tasks not yet started are abandoned
+  */
+struct work_pool_t
+{
+	work_thread_t *threads;
+	size_t number_threads;
+	work_pool_task_t run;
+	void *context;
+	pthread_mutex_t error_lock;
+	status_t error;
+};
+
+/**
+  * Runs every task on a pool of threads, returning once they have all finished
+  * @param number_tasks   the number of tasks, numbered from 0
+  * @param number_threads the number of threads, from 1 to MAX_WORK_THREADS, including the calling
+  *                       thread
+  * @param run            runs a single task, and may be called from any of the threads
+  * @param context        passed to run
+  * @param steals         out param which will hold the number of times a thread stole tasks, or
+  *                       NULL
+  * @return the first error of any task, or an indication of whether another error occurred
+  */
+status_t work_pool_run(size_t number_tasks, size_t number_threads, work_pool_task_t run, void *context, size_t *steals);
+#endif
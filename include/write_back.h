@@ -0,0 +1,102 @@
+#ifndef _WRITE_BACK_H_
+#define _WRITE_BACK_H_
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "backing_store.h"
+#include "status.h"
+
+/**
+  * The most dirty pages which can wait to be written back at once; a fault which finds them all
+  * taken waits for the flusher to catch up. The flusher is woken once WRITE_BACK_BATCH are queued
+  */
+#define WRITE_BACK_SLOTS 64
+#define WRITE_BACK_BATCH 16
+
+/**
+  * How dirty pages reach the backing store:
+  *   WRITE_BACK_NONE  - they do not; a write only marks its page dirty and changes nothing
+  *   WRITE_BACK_SYNC  - a fault writes its dirty victim out itself before reading the new page
+  *   WRITE_BACK_ASYNC - a fault copies its dirty victim into a queue, from which a background
+  *                      flusher thread writes it out, a batch of consecutive pages per system call
+  */
+typedef enum
+{
+	WRITE_BACK_NONE,
+	WRITE_BACK_SYNC,
+	WRITE_BACK_ASYNC
+} write_back_mode_t;
+
+/**
+  * Writes dirty pages back to a writable backing store. In asynchronous mode each slot holds a copy
+  * of one page: free, queued for the flusher, or being written by it. A page evicted again while
+  * still queued replaces its queued contents rather than taking another slot, and a page read while
+  * it is waiting is read from its slot, since the store does not have it yet
+  */
+typedef struct
+{
+	write_back_mode_t mode;
+	backing_store_t *store;
+	int8_t *buffers;
+	uint64_t pages[WRITE_BACK_SLOTS];
+	uint8_t states[WRITE_BACK_SLOTS];
+	size_t queued;
+	size_t free_slots;
+	uint8_t stopping;
+	status_t error;
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t space;
+	pthread_t flusher;
+	size_t written;
+	size_t coalesced;
+	size_t batches;
+} write_back_t;
+
+/**
+  * Looks up a write-back mode by name ("none", "sync" or "async")
+  * @param name the name of the mode
+  * @param mode out param which will hold the mode
+  * @return an indication of whether an error occurred
+  */
+status_t write_back_mode_find(const char *name, write_back_mode_t *mode);
+
+/**
+  * Initializes the write-back of dirty pages to a backing store, starting the flusher thread in
+  * asynchronous mode
+  * @param write_back the write-back to initialize
+  * @param store      the writable backing store
+  * @param mode       how the pages are to be written back
+  * @return an indication of whether an error occurred
+  */
+status_t write_back_initialize(write_back_t *write_back, backing_store_t *store, write_back_mode_t mode);
+
+/**
+  * Writes out every page still waiting and stops the flusher thread
+  * @param write_back the write-back to uninitialize
+  * @return an indication of whether any write failed
+  */
+status_t write_back_uninitialize(write_back_t *write_back);
+
+/**
+  * Writes a dirty page back to the backing store, or in asynchronous mode queues a copy of it to be
+  * written. Safe to call from several threads
+  * @param write_back the write-back
+  * @param page       the number of the page
+  * @param contents   the page_bytes bytes of the page
+  * @return an indication of whether an error occurred, including a failed write of an earlier page
+  */
+status_t write_back_page(write_back_t *write_back, uint64_t page, const int8_t *contents);
+
+/**
+  * Reads a page, from the queue if it is still waiting to be written back and otherwise from the
+  * backing store. Safe to call from several threads
+  * @param write_back the write-back
+  * @param page       the number of the page
+  * @param dest       the buffer of page_bytes bytes to copy into
+  * @return an indication of whether an error occurred
+  */
+status_t write_back_read(write_back_t *write_back, uint64_t page, int8_t *dest);
+#endif
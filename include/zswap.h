@@ -0,0 +1,177 @@
+#ifndef _ZSWAP_H_
+#define _ZSWAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "codec.h"
+#include "hash_map.h"
+#include "status.h"
+
+/**
+  * The number of size classes a page is split into: an object of class c takes c + 1 sixteenths of
+  * a page, and a page which does not compress to fifteen sixteenths is not kept
+  */
+#define ZSWAP_CLASSES 16
+
+/**
+  * The smallest page whose sixteenth holds the link of a free object
+  */
+#define ZSWAP_MIN_PAGE_BYTES (ZSWAP_CLASSES * sizeof(int32_t))
+
+/**
+  * The pages' worth of bytes in a slab, whose objects are all of a single size class at a time
+  */
+#define ZSWAP_SLAB_PAGES 4
+
+/**
+  * Marks the end of a list of objects or entries
+  */
+#define ZSWAP_NONE -1
+
+/**
+  * The class of a page filled with a single value, which takes no space in the arena and is never
+  * pushed out, and of a slab holding no objects
+  */
+#define ZSWAP_NO_CLASS UINT8_MAX
+
+/**
+  * A page held in the pool: its tag, the first grain of its object in the arena, or the value its
+  * page is filled with, its compressed length, its size class, whether it is dirty, and the pages
+  * stored before and after it
+  */
+typedef struct
+{
+	uint64_t tag;
+	uint32_t object;
+	uint32_t length;
+	uint8_t class;
+	uint8_t dirty;
+	int32_t prev;
+	int32_t next;
+} zswap_entry_t;
+
+/**
+  * Writes back a dirty page leaving the pool, given the context it was passed with, the tag of the
+  * page and its contents
+  */
+typedef status_t (*zswap_write_t)(void *context, uint64_t tag, const int8_t *contents);
+
+/**
+  * What the pool has done: the pages offered to it and those stored, of which those filled with a
+  * single value, those refused because they did not compress, the pages found in it on a fault,
+  * those pushed out to make room and those of them which were dirty, the bytes of the pages stored
+  * compressed before and after compression, and the pages decompressed and the nanoseconds spent
+  * compressing and decompressing
+  */
+typedef struct
+{
+	uint64_t offered;
+	uint64_t stored;
+	uint64_t same_filled;
+	uint64_t incompressible;
+	uint64_t loads;
+	uint64_t evictions;
+	uint64_t dirty_evictions;
+	uint64_t raw_bytes;
+	uint64_t compressed_bytes;
+	uint64_t decompressions;
+	uint64_t compress_ns;
+	uint64_t decompress_ns;
+} zswap_statistics_t;
+
+/**
+  * A pool of compressed pages of a fixed size, like zswap over zsmalloc. The pool is an arena of
+  * slabs of slab_bytes, each cut into the objects of a single size class while it holds any; an
+  * object is a run of grains addressed by the number of its first grain. Each slab links its free
+  * objects through their first four bytes, starting at slab_free, counts those in use in live, and
+  * is in the list of its class from partial, through next_slab and prev_slab, while it has any free.
+  * A slab whose last object is freed goes back on free_slabs for any class. The compressed pages are
+  * kept from the least recently stored at oldest to the most at newest, and when a page finds no
+  * room the oldest are pushed out until it does. Pages are found by tag through index, and an entry
+  * leaves the pool when its page is loaded again. used_bytes counts the compressed bytes held,
+  * scratch holds a page being compressed and victim a dirty page being pushed out
+  */
+typedef struct
+{
+	const codec_ops_t *codec;
+	size_t page_bytes;
+	size_t grain;
+	size_t number_classes;
+	size_t slab_bytes;
+	size_t slab_grains;
+	size_t number_slabs;
+	size_t used_slabs;
+	uint8_t *arena;
+	uint8_t *slab_class;
+	uint32_t *live;
+	int32_t *slab_free;
+	int32_t *next_slab;
+	int32_t *prev_slab;
+	int32_t *free_slabs;
+	size_t number_free_slabs;
+	int32_t partial[ZSWAP_CLASSES];
+	int32_t oldest;
+	int32_t newest;
+	zswap_entry_t *entries;
+	size_t capacity;
+	size_t number_entries;
+	int32_t free_entries;
+	hash_map_t index;
+	uint8_t *scratch;
+	int8_t *victim;
+	size_t used_bytes;
+	zswap_statistics_t statistics;
+} zswap_t;
+
+/**
+  * Initializes an empty pool
+  * @param zswap      the pool to initialize
+  * @param codec      the codec which compresses its pages
+  * @param pool_bytes the size of the arena, rounded down to whole slabs
+  * @param page_bytes the size of a page, at least ZSWAP_MIN_PAGE_BYTES
+  * @return an indication of whether an error occurred
+  */
+status_t zswap_initialize(zswap_t *zswap, const codec_ops_t *codec, size_t pool_bytes, size_t page_bytes);
+
+/**
+  * Uninitializes a pool after it is no longer needed
+  * @param zswap the pool to uninitialize
+  */
+void zswap_uninitialize(zswap_t *zswap);
+
+/**
+  * Offers a page leaving memory to the pool, which keeps it if it is filled with a single value or
+  * compresses, pushing out the least recently stored pages until there is room for it
+  * @param zswap    the pool
+  * @param tag      the tag of the page
+  * @param contents the contents of the page
+  * @param dirty    whether the page is dirty, in which case it is written back only once it leaves
+  *                 the pool
+  * @param stored   out param which will hold whether the page was kept
+  * @param write    writes back each dirty page pushed out
+  * @param context  passed to write
+  * @return an indication of whether an error occurred
+  */
+status_t zswap_store(zswap_t *zswap, uint64_t tag, const int8_t *contents, uint8_t dirty, uint8_t *stored, zswap_write_t write, void *context);
+
+/**
+  * Takes a page out of the pool, if it is there, decompressing it
+  * @param zswap    the pool
+  * @param tag      the tag of the page
+  * @param contents where to decompress the page to
+  * @param found    out param which will hold whether the page was in the pool
+  * @param dirty    out param which will hold whether the page was dirty when it was stored
+  * @return an indication of whether an error occurred
+  */
+status_t zswap_load(zswap_t *zswap, uint64_t tag, int8_t *contents, uint8_t *found, uint8_t *dirty);
+
+/**
+  * Decompresses every dirty page still in the pool and passes it to a function which writes it back
+  * @param zswap   the pool
+  * @param write   writes back each dirty page
+  * @param context passed to write
+  * @return an indication of whether an error occurred
+  */
+status_t zswap_flush(zswap_t *zswap, zswap_write_t write, void *context);
+#endif
@@ -0,0 +1,231 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/backing_store.h"
+
+status_t backing_mode_find(const char *name, backing_mode_t *mode)
+{
+	if (strcmp(name, "stdio") == 0)
+	{
+		*mode = BACKING_STDIO;
+	}
+	else if (strcmp(name, "mmap") == 0)
+	{
+		*mode = BACKING_MMAP;
+	}
+	else if (strcmp(name, "zero-copy") == 0)
+	{
+		*mode = BACKING_ZERO_COPY;
+	}
+	else
+	{
+		return OPTN_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+/**
+  * Finds the size of a backing store which has just been opened, and maps it unless it is to be
+  * read through stdio. On failure the file is closed
+  * @param store the backing store
+  * @return an indication of whether an error occurred
+  */
+static status_t backing_store_map(backing_store_t *store);
+
+#define COPY_BLOCK (1 << 16)
+
+status_t backing_store_open(backing_store_t *store, const char *path, size_t page_bytes, backing_mode_t mode)
+{
+	store->mode = mode;
+	store->writable = 0;
+	store->page_bytes = page_bytes;
+	store->map = NULL;
+	if ((store->file = fopen(path, "r")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+
+	return backing_store_map(store);
+}
+
+status_t backing_store_open_copy(backing_store_t *store, const char *path, const char *copy, size_t page_bytes, backing_mode_t mode)
+{
+	store->mode = mode == BACKING_ZERO_COPY ? BACKING_MMAP : mode;
+	store->writable = 1;
+	store->page_bytes = page_bytes;
+	store->map = NULL;
+
+	int source;
+	if ((source = open(path, O_RDONLY)) < 0)
+	{
+		return OPEN_ERROR;
+	}
+
+	int fd = -1;
+	if (copy == NULL)
+	{
+		store->file = tmpfile();
+	}
+	else if ((fd = open(copy, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0 || (store->file = fdopen(fd, "r+")) == NULL)
+	{
+		store->file = NULL;
+	}
+	if (store->file == NULL)
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		close(source);
+		return OPEN_ERROR;
+	}
+
+	//the copy is written through its descriptor, and the stream is left unbuffered so that a read
+	//never returns a stale buffer from before a write
+	setvbuf(store->file, NULL, _IONBF, 0);
+	fd = fileno(store->file);
+
+	status_t error = SUCCESS;
+	int8_t *block = malloc(COPY_BLOCK);
+	ssize_t length = 0;
+	while (block != NULL && (length = read(source, block, COPY_BLOCK)) > 0)
+	{
+		if (write(fd, block, length) != length)
+		{
+			error = WRIT_ERROR;
+			break;
+		}
+	}
+	if (block == NULL)
+	{
+		error = ALOC_ERROR;
+	}
+	else if (length < 0)
+	{
+		error = READ_ERROR;
+	}
+	free(block);
+	close(source);
+
+	if (error != SUCCESS)
+	{
+		fclose(store->file);
+		return error;
+	}
+
+	return backing_store_map(store);
+}
+
+static status_t backing_store_map(backing_store_t *store)
+{
+	struct stat info;
+	if (fstat(fileno(store->file), &info) < 0)
+	{
+		fclose(store->file);
+		return OPEN_ERROR;
+	}
+	store->size = info.st_size;
+
+	//a writable store is mapped shared, so that the mapping follows what is written to the file
+	if (store->mode != BACKING_STDIO && store->size > 0)
+	{
+		void *map = mmap(NULL, store->size, PROT_READ, store->writable ? MAP_SHARED : MAP_PRIVATE, fileno(store->file), 0);
+		if (map == MAP_FAILED)
+		{
+			fclose(store->file);
+			return OPEN_ERROR;
+		}
+
+		//page faults land all over the store, so kernel readahead would mostly fetch pages that are
+		//never used
+		madvise(map, store->size, MADV_RANDOM);
+		store->map = map;
+	}
+
+	return SUCCESS;
+}
+
+void backing_store_close(backing_store_t *store)
+{
+	if (store->map != NULL)
+	{
+		munmap(store->map, store->size);
+	}
+	fclose(store->file);
+}
+
+status_t backing_store_read(backing_store_t *store, uint64_t page, int8_t *dest)
+{
+	uint64_t position = page * store->page_bytes;
+	if (store->map != NULL && position + store->page_bytes <= store->size)
+	{
+		memcpy(dest, store->map + position, store->page_bytes);
+		return SUCCESS;
+	}
+
+	//a page past the end of the file reads as zeros, as a hole in a sparse file would, so that a
+	//wide address space needs no store as large as it. Only a writable store can have grown since
+	//it was opened
+	if (!store->writable && position >= store->size)
+	{
+		memset(dest, 0, store->page_bytes);
+		return SUCCESS;
+	}
+
+	//adjust the backing store file to the correct position, holding the stream's lock so that
+	//the seek and the read of one thread are not split by another's
+	status_t error = SUCCESS;
+	flockfile(store->file);
+	if (fseeko(store->file, position, SEEK_SET) < 0)
+	{
+		error = SEEK_ERROR;
+	}
+	else
+	{
+		size_t length = fread(dest, 1, store->page_bytes, store->file);
+		if (length < store->page_bytes && ferror(store->file))
+		{
+			clearerr(store->file);
+			error = READ_ERROR;
+		}
+		else
+		{
+			memset(dest + length, 0, store->page_bytes - length);
+		}
+	}
+	funlockfile(store->file);
+
+	return error;
+}
+
+status_t backing_store_write(backing_store_t *store, uint64_t page, const struct iovec *pages, int count)
+{
+	if (!store->writable)
+	{
+		return WRIT_ERROR;
+	}
+
+	ssize_t expected = (ssize_t) count * store->page_bytes;
+	if (pwritev(fileno(store->file), pages, count, page * store->page_bytes) != expected)
+	{
+		return WRIT_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+int8_t *backing_store_page(backing_store_t *store, uint64_t page)
+{
+	uint64_t position = page * store->page_bytes;
+	if (store->mode != BACKING_ZERO_COPY || store->map == NULL || position + store->page_bytes > store->size)
+	{
+		return NULL;
+	}
+
+	return store->map + position;
+}
@@ -0,0 +1,302 @@
+#include <string.h>
+
+#include "../include/codec.h"
+
+/**
+  * The shortest match worth encoding, the furthest back a match may start, and the number of bits
+  * hashing the four bytes at a position
+  */
+#define MIN_MATCH  4
+#define MAX_OFFSET 65535
+#define HASH_BITS  10
+
+/**
+  * After every 2^SKIP_TRIGGER positions without a match the search steps one byte further, so that
+  * a page which does not compress is given up on quickly, as LZ4 does
+  */
+#define SKIP_TRIGGER 6
+
+/**
+  * A nibble of the token which is extended by the bytes which follow
+  */
+#define NIBBLE_MAX 15
+
+static const codec_ops_t *codecs[] = { &lz_codec_ops, &same_codec_ops };
+
+/**
+  * Reads four bytes which may not be aligned
+  */
+static uint32_t read32(const uint8_t *p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof value);
+	return value;
+}
+
+/**
+  * Reads eight bytes which may not be aligned
+  */
+static uint64_t read64(const uint8_t *p)
+{
+	uint64_t value;
+	memcpy(&value, p, sizeof value);
+	return value;
+}
+
+/**
+  * Copies whole words of eight bytes at a time, which may read and write up to seven bytes past the
+  * end, so is only used where there is room for them. The bytes copied may overlap those written
+  * as long as they start at least eight bytes back
+  */
+static void wild_copy(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	uint8_t *end = dst + count;
+	do
+	{
+		memcpy(dst, src, sizeof (uint64_t));
+		dst += sizeof (uint64_t);
+		src += sizeof (uint64_t);
+	} while (dst < end);
+}
+
+/**
+  * Writes a sequence of literals followed by a match, or by nothing when offset is 0
+  * @param dst      the output
+  * @param out      the position in the output, advanced past the sequence
+  * @param capacity the size of the output
+  * @param literals the literals
+  * @param count    the number of literals
+  * @param offset   how far back the match starts, or 0 for the last sequence
+  * @param match    the length of the match
+  * @return whether the sequence fit
+  */
+static uint8_t emit_sequence(uint8_t *dst, size_t *out, size_t capacity, const uint8_t *literals, size_t count, size_t offset, size_t match)
+{
+	//the worst case is a token, the extension of each length, the literals and the offset
+	size_t op = *out;
+	size_t extra = match - (offset == 0 ? 0 : MIN_MATCH);
+	if (op + 1 + count / 255 + 1 + count + 2 + extra / 255 + 1 > capacity)
+	{
+		return 0;
+	}
+
+	size_t token = op++;
+	dst[token] = (count < NIBBLE_MAX ? count : NIBBLE_MAX) << 4;
+	if (count >= NIBBLE_MAX)
+	{
+		size_t rest;
+		for (rest = count - NIBBLE_MAX; rest >= 255; rest -= 255)
+		{
+			dst[op++] = 255;
+		}
+		dst[op++] = rest;
+	}
+	memcpy(dst + op, literals, count);
+	op += count;
+
+	if (offset != 0)
+	{
+		dst[op++] = offset & 0xFF;
+		dst[op++] = offset >> 8;
+		dst[token] |= extra < NIBBLE_MAX ? extra : NIBBLE_MAX;
+		if (extra >= NIBBLE_MAX)
+		{
+			size_t rest;
+			for (rest = extra - NIBBLE_MAX; rest >= 255; rest -= 255)
+			{
+				dst[op++] = 255;
+			}
+			dst[op++] = rest;
+		}
+	}
+
+	*out = op;
+	return 1;
+}
+
+/**
+  * Reads the extension of a length from the input
+  * @param src        the input
+  * @param in         the position in the input, advanced past the extension
+  * @param compressed the size of the input
+  * @param length     the length to extend
+  * @return whether the extension was complete
+  */
+static uint8_t read_length(const uint8_t *src, size_t *in, size_t compressed, size_t *length)
+{
+	uint8_t byte;
+	do
+	{
+		if (*in >= compressed)
+		{
+			return 0;
+		}
+		byte = src[(*in)++];
+		*length += byte;
+	} while (byte == 255);
+
+	return 1;
+}
+
+static size_t lz_compress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity)
+{
+	//positions are kept one higher so that 0 marks an empty slot
+	uint32_t table[1 << HASH_BITS];
+	memset(table, 0, sizeof table);
+
+	size_t ip = 0;
+	size_t anchor = 0;
+	size_t op = 0;
+	size_t misses = 0;
+	while (ip + MIN_MATCH <= length)
+	{
+		uint32_t sequence = read32(src + ip);
+		uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+		size_t candidate = table[hash];
+		table[hash] = ip + 1;
+		if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET || read32(src + candidate - 1) != sequence)
+		{
+			ip += 1 + (misses++ >> SKIP_TRIGGER);
+			continue;
+		}
+		misses = 0;
+
+		//extend the match eight bytes at a time, and then a byte at a time within the last eight
+		size_t ref = candidate - 1;
+		size_t match = MIN_MATCH;
+		while (ip + match + sizeof (uint64_t) <= length && read64(src + ref + match) == read64(src + ip + match))
+		{
+			match += sizeof (uint64_t);
+		}
+		while (ip + match < length && src[ref + match] == src[ip + match])
+		{
+			match++;
+		}
+		if (!emit_sequence(dst, &op, capacity, src + anchor, ip - anchor, ip - ref, match))
+		{
+			return 0;
+		}
+		ip += match;
+		anchor = ip;
+	}
+
+	if (!emit_sequence(dst, &op, capacity, src + anchor, length - anchor, 0, 0))
+	{
+		return 0;
+	}
+	return op;
+}
+
+static status_t lz_decompress(const uint8_t *src, size_t compressed, uint8_t *dst, size_t length)
+{
+	size_t in = 0;
+	size_t op = 0;
+	while (in < compressed)
+	{
+		uint8_t token = src[in++];
+		size_t count = token >> 4;
+		if (count == NIBBLE_MAX && !read_length(src, &in, compressed, &count))
+		{
+			return FORM_ERROR;
+		}
+		if (in + count > compressed || op + count > length)
+		{
+			return FORM_ERROR;
+		}
+		if (in + count + sizeof (uint64_t) <= compressed && op + count + sizeof (uint64_t) <= length)
+		{
+			wild_copy(dst + op, src + in, count);
+		}
+		else
+		{
+			memcpy(dst + op, src + in, count);
+		}
+		in += count;
+		op += count;
+
+		//only the last sequence ends without a match
+		if (in == compressed)
+		{
+			break;
+		}
+		if (in + 2 > compressed)
+		{
+			return FORM_ERROR;
+		}
+		size_t offset = src[in] | (size_t) src[in + 1] << 8;
+		in += 2;
+		size_t match = token & NIBBLE_MAX;
+		if (match == NIBBLE_MAX && !read_length(src, &in, compressed, &match))
+		{
+			return FORM_ERROR;
+		}
+		match += MIN_MATCH;
+		if (offset == 0 || offset > op || op + match > length)
+		{
+			return FORM_ERROR;
+		}
+
+		//a match at least a word back is copied a word at a time. One closer than that repeats
+		//its bytes every offset bytes, so it is copied from the furthest multiple of offset back
+		//which has already been written, which doubles what each copy covers, as in a run of zeros
+		if (offset >= sizeof (uint64_t) && op + match + sizeof (uint64_t) <= length)
+		{
+			wild_copy(dst + op, dst + op - offset, match);
+			op += match;
+			continue;
+		}
+		size_t start = op;
+		size_t end = op + match;
+		while (op < end)
+		{
+			size_t written = op - start + offset;
+			size_t distance = written - written % offset;
+			size_t count = end - op < distance ? end - op : distance;
+			memcpy(dst + op, dst + op - distance, count);
+			op += count;
+		}
+	}
+
+	return op == length ? SUCCESS : FORM_ERROR;
+}
+
+const codec_ops_t lz_codec_ops =
+{
+	"lz", lz_compress, lz_decompress
+};
+
+static size_t same_compress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity)
+{
+	return 0;
+}
+
+static status_t same_decompress(const uint8_t *src, size_t compressed, uint8_t *dst, size_t length)
+{
+	return FORM_ERROR;
+}
+
+const codec_ops_t same_codec_ops =
+{
+	"same", same_compress, same_decompress
+};
+
+const codec_ops_t *codec_find(const char *name)
+{
+	size_t i;
+	for (i = 0; i < sizeof codecs / sizeof *codecs; i++)
+	{
+		if (strcmp(codecs[i]->name, name) == 0)
+		{
+			return codecs[i];
+		}
+	}
+
+	return NULL;
+}
+
+uint8_t codec_same_filled(const uint8_t *src, size_t length, uint8_t *value)
+{
+	//every byte equals the one after it exactly when every byte equals the first
+	*value = src[0];
+	return memcmp(src, src + 1, length - 1) == 0;
+}
@@ -0,0 +1,259 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "../include/dedup.h"
+
+/**
+  * The pages a frame starts out with room for once it is first given one
+  */
+#define MIN_PAGES 4
+
+/**
+  * The number of words hashed side by side, each in a lane of its own, so that the multiplications
+  * of each do not wait on one another
+  */
+#define HASH_LANES 8
+
+/**
+  * Reads the monotonic clock
+  * @return the time in nanoseconds
+  */
+static uint64_t now_ns(void);
+
+/**
+  * Hashes the contents of a page a word at a time, in HASH_LANES lanes which are mixed together
+  * at the end. The hash is never HASH_MAP_EMPTY, so that it can key the index
+  * @param contents the contents of the page
+  * @param bytes    the size of the page
+  * @return the hash
+  */
+static uint64_t dedup_hash(const int8_t *contents, size_t bytes);
+
+status_t dedup_initialize(dedup_t *dedup, size_t number_frames, size_t page_bytes)
+{
+	dedup->page_bytes = page_bytes;
+	dedup->number_frames = number_frames;
+	memset(&dedup->statistics, 0, sizeof dedup->statistics);
+	dedup->position.keys = NULL;
+	dedup->position.values = NULL;
+	dedup->index.keys = NULL;
+	dedup->index.values = NULL;
+
+	dedup->pages = calloc(number_frames, sizeof *dedup->pages);
+	dedup->count = calloc(number_frames, sizeof *dedup->count);
+	dedup->capacity = calloc(number_frames, sizeof *dedup->capacity);
+	dedup->hashes = malloc(number_frames * sizeof *dedup->hashes);
+	dedup->indexed = calloc(number_frames, sizeof *dedup->indexed);
+	if (dedup->pages == NULL || dedup->count == NULL || dedup->capacity == NULL || dedup->hashes == NULL ||
+		dedup->indexed == NULL ||
+		hash_map_initialize(&dedup->position, number_frames) != SUCCESS || hash_map_initialize(&dedup->index, number_frames) != SUCCESS)
+	{
+		dedup_uninitialize(dedup);
+		return ALOC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+void dedup_uninitialize(dedup_t *dedup)
+{
+	if (dedup->pages != NULL)
+	{
+		size_t frame;
+		for (frame = 0; frame < dedup->number_frames; frame++)
+		{
+			free(dedup->pages[frame]);
+		}
+	}
+	hash_map_uninitialize(&dedup->index);
+	hash_map_uninitialize(&dedup->position);
+	free(dedup->indexed);
+	free(dedup->hashes);
+	free(dedup->capacity);
+	free(dedup->count);
+	free(dedup->pages);
+}
+
+uint8_t dedup_find(dedup_t *dedup, const int8_t *contents, int8_t *const *frames, uint64_t *hash, uint32_t *frame)
+{
+	uint64_t start = now_ns();
+	*hash = dedup_hash(contents, dedup->page_bytes);
+	uint64_t *found = hash_map_find(&dedup->index, *hash);
+	uint8_t same = found != NULL && memcmp(frames[*found], contents, dedup->page_bytes) == 0;
+	dedup->statistics.hash_ns += now_ns() - start;
+	dedup->statistics.hashed++;
+
+	if (same)
+	{
+		*frame = *found;
+	}
+	return same;
+}
+
+status_t dedup_index(dedup_t *dedup, uint32_t frame, uint64_t hash)
+{
+	if (hash_map_find(&dedup->index, hash) != NULL)
+	{
+		return SUCCESS;
+	}
+
+	status_t error;
+	if ((error = hash_map_put(&dedup->index, hash, frame)) != SUCCESS)
+	{
+		return error;
+	}
+	dedup->hashes[frame] = hash;
+	dedup->indexed[frame] = 1;
+	return SUCCESS;
+}
+
+void dedup_unindex(dedup_t *dedup, uint32_t frame)
+{
+	if (dedup->indexed[frame])
+	{
+		hash_map_remove(&dedup->index, dedup->hashes[frame]);
+		dedup->indexed[frame] = 0;
+	}
+}
+
+status_t dedup_add(dedup_t *dedup, uint32_t frame, uint64_t tag)
+{
+	if (dedup->count[frame] == dedup->capacity[frame])
+	{
+		uint32_t capacity = dedup->capacity[frame] == 0 ? MIN_PAGES : 2 * dedup->capacity[frame];
+		uint64_t *pages = realloc(dedup->pages[frame], capacity * sizeof *pages);
+		if (pages == NULL)
+		{
+			return ALOC_ERROR;
+		}
+		dedup->pages[frame] = pages;
+		dedup->capacity[frame] = capacity;
+	}
+
+	status_t error;
+	if ((error = hash_map_put(&dedup->position, tag, dedup->count[frame])) != SUCCESS)
+	{
+		return error;
+	}
+	dedup->pages[frame][dedup->count[frame]] = tag;
+
+	//every page after the first in a frame is a frame saved
+	if (dedup->count[frame]++ > 0)
+	{
+		dedup->statistics.merged++;
+		if (++dedup->statistics.shared > dedup->statistics.peak_shared)
+		{
+			dedup->statistics.peak_shared = dedup->statistics.shared;
+		}
+	}
+	return SUCCESS;
+}
+
+void dedup_remove(dedup_t *dedup, uint32_t frame, uint64_t tag)
+{
+	//the last page of the frame takes the place of the one leaving
+	uint64_t position = *hash_map_find(&dedup->position, tag);
+	uint64_t last = dedup->pages[frame][--dedup->count[frame]];
+	dedup->pages[frame][position] = last;
+	*hash_map_find(&dedup->position, last) = position;
+	hash_map_remove(&dedup->position, tag);
+
+	if (dedup->count[frame] > 0)
+	{
+		dedup->statistics.shared--;
+	}
+}
+
+void dedup_clear(dedup_t *dedup, uint32_t frame)
+{
+	uint32_t i;
+	for (i = 0; i < dedup->count[frame]; i++)
+	{
+		hash_map_remove(&dedup->position, dedup->pages[frame][i]);
+	}
+	if (dedup->count[frame] > 0)
+	{
+		dedup->statistics.shared -= dedup->count[frame] - 1;
+	}
+	dedup->count[frame] = 0;
+	dedup_unindex(dedup, frame);
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t dedup_hash(const int8_t *contents, size_t bytes)
+{
+	static const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+	uint64_t lanes[HASH_LANES];
+	size_t words = bytes / sizeof(uint64_t) / HASH_LANES * HASH_LANES;
+	size_t i;
+#ifdef __SSE2__
+	//two lanes to a register; SSE2 has no 64-bit multiply, so the two halves of each word, mixed
+	//with a key, are multiplied together and added to the lane along with the word. The key moves
+	//on every round so that the same words elsewhere in the page hash differently
+	__m128i step = _mm_set1_epi64x(multiplier);
+	__m128i key = _mm_set_epi64x(0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL);
+	__m128i sums[HASH_LANES / 2];
+	size_t lane;
+	for (lane = 0; lane < HASH_LANES / 2; lane++)
+	{
+		sums[lane] = _mm_setzero_si128();
+	}
+	for (i = 0; i < words; i += HASH_LANES)
+	{
+		for (lane = 0; lane < HASH_LANES / 2; lane++)
+		{
+			__m128i word = _mm_loadu_si128((const __m128i *) (contents + i * sizeof(uint64_t)) + lane);
+			__m128i keyed = _mm_xor_si128(word, key);
+			__m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+			sums[lane] = _mm_add_epi64(sums[lane], _mm_add_epi64(product, _mm_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2))));
+		}
+		key = _mm_add_epi64(key, step);
+	}
+	for (lane = 0; lane < HASH_LANES / 2; lane++)
+	{
+		_mm_storeu_si128((__m128i *) lanes + lane, sums[lane]);
+	}
+#else
+	//each word is multiplied before it joins its lane, so that a lane only waits on an add and a
+	//rotate between one word and the next
+	size_t lane;
+	for (lane = 0; lane < HASH_LANES; lane++)
+	{
+		lanes[lane] = lane;
+	}
+	for (i = 0; i < words; i += HASH_LANES)
+	{
+		uint64_t word[HASH_LANES];
+		memcpy(word, contents + i * sizeof *word, sizeof word);
+		for (lane = 0; lane < HASH_LANES; lane++)
+		{
+			lanes[lane] += word[lane] * multiplier;
+			lanes[lane] = (lanes[lane] << 31) | (lanes[lane] >> 33);
+		}
+	}
+#endif
+
+	//pages too small for whole rounds of words are hashed a byte at a time
+	uint64_t hash = bytes;
+	for (i = words * sizeof(uint64_t); i < bytes; i++)
+	{
+		hash = (hash ^ (uint8_t) contents[i]) * multiplier;
+	}
+	for (lane = 0; lane < HASH_LANES; lane++)
+	{
+		hash = (hash ^ lanes[lane]) * multiplier;
+		hash ^= hash >> 32;
+	}
+	return hash == HASH_MAP_EMPTY ? 0 : hash;
+}
@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include "../include/ghost_list.h"
+
+/**
+  * Forgets the key with the given id, returning the id to the pool
+  * @param list the ghost list
+  * @param id   the id of the key to forget
+  */
+static void ghost_list_release(ghost_list_t *list, int id);
+
+status_t ghost_list_initialize(ghost_list_t *list, int capacity)
+{
+	status_t error;
+	if ((error = hash_map_initialize(&list->index, capacity)) != SUCCESS)
+	{
+		return error;
+	}
+
+	list->keys = malloc(capacity * sizeof *list->keys);
+	list->free_ids = malloc(capacity * sizeof *list->free_ids);
+	if (list->keys == NULL || list->free_ids == NULL || (error = lru_queue_initialize(&list->queue, capacity)) != SUCCESS)
+	{
+		free(list->keys);
+		free(list->free_ids);
+		hash_map_uninitialize(&list->index);
+		return ALOC_ERROR;
+	}
+
+	int i;
+	for (i = 0; i < capacity; i++)
+	{
+		list->free_ids[i] = capacity - i - 1;
+	}
+	list->free_count = capacity;
+	list->size = 0;
+	list->capacity = capacity;
+
+	return SUCCESS;
+}
+
+void ghost_list_uninitialize(ghost_list_t *list)
+{
+	lru_queue_uninitialize(&list->queue);
+	free(list->free_ids);
+	free(list->keys);
+	hash_map_uninitialize(&list->index);
+}
+
+unsigned short ghost_list_contains(ghost_list_t *list, uint64_t key)
+{
+	return hash_map_find(&list->index, key) != NULL;
+}
+
+void ghost_list_push(ghost_list_t *list, uint64_t key)
+{
+	if (list->capacity == 0)
+	{
+		return;
+	}
+
+	if (list->free_count == 0)
+	{
+		ghost_list_drop_oldest(list);
+	}
+
+	int id = list->free_ids[--list->free_count];
+	list->keys[id] = key;
+	lru_queue_insert_new(&list->queue, id);
+	hash_map_put(&list->index, key, id);
+	list->size++;
+}
+
+void ghost_list_remove(ghost_list_t *list, uint64_t key)
+{
+	uint64_t *id = hash_map_find(&list->index, key);
+	if (id != NULL)
+	{
+		int found = *id;
+		lru_queue_remove_existing(&list->queue, found);
+		ghost_list_release(list, found);
+	}
+}
+
+void ghost_list_drop_oldest(ghost_list_t *list)
+{
+	if (list->size > 0)
+	{
+		ghost_list_release(list, lru_queue_poll(&list->queue));
+	}
+}
+
+void ghost_list_save(ghost_list_t *list, snapshot_writer_t *writer)
+{
+	lru_queue_save(&list->queue, writer);
+	snapshot_write(writer, list->keys, list->capacity * sizeof *list->keys);
+	snapshot_write(writer, list->free_ids, list->capacity * sizeof *list->free_ids);
+	snapshot_write(writer, &list->free_count, sizeof list->free_count);
+	snapshot_write(writer, &list->size, sizeof list->size);
+}
+
+status_t ghost_list_restore(ghost_list_t *list, snapshot_reader_t *reader)
+{
+	status_t error;
+	if ((error = lru_queue_restore(&list->queue, reader)) != SUCCESS)
+	{
+		return error;
+	}
+	snapshot_read(reader, list->keys, list->capacity * sizeof *list->keys);
+	snapshot_read(reader, list->free_ids, list->capacity * sizeof *list->free_ids);
+	snapshot_read(reader, &list->free_count, sizeof list->free_count);
+	snapshot_read(reader, &list->size, sizeof list->size);
+
+	//the index is not saved but rebuilt from the keys still queued, which is all it holds, and no
+	//key may be queued twice
+	hash_map_clear(&list->index);
+	int queued = 0;
+	int id;
+	for (id = 0; id < list->capacity; id++)
+	{
+		if (!lru_queue_contains(&list->queue, id))
+		{
+			continue;
+		}
+		if (hash_map_find(&list->index, list->keys[id]) != NULL)
+		{
+			return FORM_ERROR;
+		}
+		if ((error = hash_map_put(&list->index, list->keys[id], id)) != SUCCESS)
+		{
+			return error;
+		}
+		queued++;
+	}
+
+	//the pool holds every id which is not queued, each of them once
+	if (list->size != queued || list->free_count != list->capacity - queued)
+	{
+		return FORM_ERROR;
+	}
+	uint8_t *pooled;
+	if ((pooled = calloc(list->capacity > 0 ? list->capacity : 1, sizeof *pooled)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	int i;
+	for (i = 0; i < list->free_count && error == SUCCESS; i++)
+	{
+		id = list->free_ids[i];
+		if (id < 0 || id >= list->capacity || pooled[id] || lru_queue_contains(&list->queue, id))
+		{
+			error = FORM_ERROR;
+		}
+		else
+		{
+			pooled[id] = 1;
+		}
+	}
+	free(pooled);
+	return error;
+}
+
+static void ghost_list_release(ghost_list_t *list, int id)
+{
+	hash_map_remove(&list->index, list->keys[id]);
+	list->free_ids[list->free_count++] = id;
+	list->size--;
+}
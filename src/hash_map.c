@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include "../include/hash_map.h"
+
+#define MIN_CAPACITY 16
+
+/**
+  * Mixes the bits of a key so that sequential keys spread across the buckets
+  * @param key the key to hash
+  * @return the hash of the key
+  */
+static uint64_t hash_map_hash(uint64_t key);
+
+/**
+  * Allocates a new bucket array of the given capacity and moves every entry into it
+  * @param map      the map to resize
+  * @param capacity the new capacity, a power of two
+  * @return an indication of whether an error occurred
+  */
+static status_t hash_map_resize(hash_map_t *map, size_t capacity);
+
+status_t hash_map_initialize(hash_map_t *map, size_t expected)
+{
+	size_t capacity = MIN_CAPACITY;
+	while (capacity < 2 * expected)
+	{
+		capacity *= 2;
+	}
+
+	map->keys = NULL;
+	map->values = NULL;
+	map->capacity = 0;
+	map->size = 0;
+	return hash_map_resize(map, capacity);
+}
+
+void hash_map_uninitialize(hash_map_t *map)
+{
+	free(map->values);
+	free(map->keys);
+}
+
+uint64_t *hash_map_find(hash_map_t *map, uint64_t key)
+{
+	size_t mask = map->capacity - 1;
+	size_t i;
+	for (i = hash_map_hash(key) & mask; map->keys[i] != HASH_MAP_EMPTY; i = (i + 1) & mask)
+	{
+		if (map->keys[i] == key)
+		{
+			return map->values + i;
+		}
+	}
+
+	return NULL;
+}
+
+status_t hash_map_put(hash_map_t *map, uint64_t key, uint64_t value)
+{
+	if (2 * (map->size + 1) > map->capacity)
+	{
+		status_t error;
+		if ((error = hash_map_resize(map, 2 * map->capacity)) != SUCCESS)
+		{
+			return error;
+		}
+	}
+
+	size_t mask = map->capacity - 1;
+	size_t i;
+	for (i = hash_map_hash(key) & mask; map->keys[i] != HASH_MAP_EMPTY; i = (i + 1) & mask)
+	{
+		if (map->keys[i] == key)
+		{
+			map->values[i] = value;
+			return SUCCESS;
+		}
+	}
+
+	map->keys[i] = key;
+	map->values[i] = value;
+	map->size++;
+	return SUCCESS;
+}
+
+void hash_map_remove(hash_map_t *map, uint64_t key)
+{
+	size_t mask = map->capacity - 1;
+	size_t i;
+	for (i = hash_map_hash(key) & mask; map->keys[i] != key; i = (i + 1) & mask)
+	{
+		if (map->keys[i] == HASH_MAP_EMPTY)
+		{
+			return;
+		}
+	}
+
+	//shift back any following entry whose home bucket lies at or before the hole, so that every
+	//remaining key is still reachable from its home bucket without crossing an empty bucket
+	size_t hole = i;
+	for (i = (i + 1) & mask; map->keys[i] != HASH_MAP_EMPTY; i = (i + 1) & mask)
+	{
+		size_t home = hash_map_hash(map->keys[i]) & mask;
+		if (((i - home) & mask) >= ((i - hole) & mask))
+		{
+			map->keys[hole] = map->keys[i];
+			map->values[hole] = map->values[i];
+			hole = i;
+		}
+	}
+	map->keys[hole] = HASH_MAP_EMPTY;
+	map->size--;
+}
+
+void hash_map_clear(hash_map_t *map)
+{
+	size_t i;
+	for (i = 0; i < map->capacity; i++)
+	{
+		map->keys[i] = HASH_MAP_EMPTY;
+	}
+	map->size = 0;
+}
+
+static uint64_t hash_map_hash(uint64_t key)
+{
+	//the finalizer of MurmurHash3
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return key;
+}
+
+static status_t hash_map_resize(hash_map_t *map, size_t capacity)
+{
+	uint64_t *keys = malloc(capacity * sizeof *keys);
+	uint64_t *values = malloc(capacity * sizeof *values);
+	if (keys == NULL || values == NULL)
+	{
+		free(keys);
+		free(values);
+		return ALOC_ERROR;
+	}
+
+	size_t i;
+	for (i = 0; i < capacity; i++)
+	{
+		keys[i] = HASH_MAP_EMPTY;
+	}
+
+	uint64_t *old_keys = map->keys;
+	uint64_t *old_values = map->values;
+	size_t old_capacity = map->capacity;
+	map->keys = keys;
+	map->values = values;
+	map->capacity = capacity;
+	map->size = 0;
+
+	for (i = 0; i < old_capacity; i++)
+	{
+		if (old_keys[i] != HASH_MAP_EMPTY)
+		{
+			hash_map_put(map, old_keys[i], old_values[i]);
+		}
+	}
+
+	free(old_keys);
+	free(old_values);
+	return SUCCESS;
+}
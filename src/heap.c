@@ -0,0 +1,155 @@
+#include <stdlib.h>
+#include "../include/heap.h"
+
+/**
+  * Places the given id at the given position of the heap array, recording its new position
+  * @param heap     the heap
+  * @param position the position in the heap array
+  * @param id       the id to place there
+  */
+static void heap_place(heap_t *heap, int position, int id);
+
+/**
+  * Moves the id at the given position up towards the root until the heap property holds
+  * @param heap     the heap
+  * @param position the position of the id to move
+  */
+static void heap_sift_up(heap_t *heap, int position);
+
+/**
+  * Moves the id at the given position down towards the leaves until the heap property holds
+  * @param heap     the heap
+  * @param position the position of the id to move
+  */
+static void heap_sift_down(heap_t *heap, int position);
+
+void heap_initialize(heap_t *heap, int capacity)
+{
+	heap->ids = malloc(capacity * sizeof *heap->ids);
+	heap->positions = malloc(capacity * sizeof *heap->positions);
+	heap->keys = malloc(capacity * sizeof *heap->keys);
+	heap->size = 0;
+	heap->capacity = capacity;
+
+	int i;
+	for (i = 0; i < capacity; i++)
+	{
+		heap->positions[i] = HEAP_NOT_QUEUED;
+	}
+}
+
+void heap_uninitialize(heap_t *heap)
+{
+	free(heap->keys);
+	free(heap->positions);
+	free(heap->ids);
+}
+
+void heap_push(heap_t *heap, int id, uint64_t key)
+{
+	heap->keys[id] = key;
+	heap_place(heap, heap->size, id);
+	heap->size++;
+	heap_sift_up(heap, heap->size - 1);
+}
+
+void heap_update(heap_t *heap, int id, uint64_t key)
+{
+	uint64_t old = heap->keys[id];
+	heap->keys[id] = key;
+	if (key < old)
+	{
+		heap_sift_up(heap, heap->positions[id]);
+	}
+	else
+	{
+		heap_sift_down(heap, heap->positions[id]);
+	}
+}
+
+void heap_remove(heap_t *heap, int id)
+{
+	int position = heap->positions[id];
+	heap->positions[id] = HEAP_NOT_QUEUED;
+	heap->size--;
+	if (position == heap->size)
+	{
+		return;
+	}
+
+	//fill the hole with the last id, which may need to move either way from there
+	int moved = heap->ids[heap->size];
+	heap_place(heap, position, moved);
+	heap_sift_up(heap, position);
+	heap_sift_down(heap, heap->positions[moved]);
+}
+
+int heap_peek(heap_t *heap)
+{
+	return heap->ids[0];
+}
+
+int heap_pop(heap_t *heap)
+{
+	int id = heap->ids[0];
+	heap_remove(heap, id);
+	return id;
+}
+
+unsigned short heap_contains(heap_t *heap, int id)
+{
+	return heap->positions[id] != HEAP_NOT_QUEUED;
+}
+
+unsigned short heap_empty(heap_t *heap)
+{
+	return heap->size == 0;
+}
+
+static void heap_place(heap_t *heap, int position, int id)
+{
+	heap->ids[position] = id;
+	heap->positions[id] = position;
+}
+
+static void heap_sift_up(heap_t *heap, int position)
+{
+	int id = heap->ids[position];
+	uint64_t key = heap->keys[id];
+	while (position > 0)
+	{
+		int parent = (position - 1) / 2;
+		if (heap->keys[heap->ids[parent]] <= key)
+		{
+			break;
+		}
+		heap_place(heap, position, heap->ids[parent]);
+		position = parent;
+	}
+	heap_place(heap, position, id);
+}
+
+static void heap_sift_down(heap_t *heap, int position)
+{
+	int id = heap->ids[position];
+	uint64_t key = heap->keys[id];
+	while (1)
+	{
+		int child = 2 * position + 1;
+		if (child >= heap->size)
+		{
+			break;
+		}
+		if (child + 1 < heap->size && heap->keys[heap->ids[child + 1]] < heap->keys[heap->ids[child]])
+		{
+			child++;
+		}
+		if (heap->keys[heap->ids[child]] >= key)
+		{
+			break;
+		}
+		heap_place(heap, position, heap->ids[child]);
+		position = child;
+	}
+	heap_place(heap, position, id);
+}
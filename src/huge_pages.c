@@ -0,0 +1,91 @@
+#include "../include/huge_pages.h"
+
+/**
+  * How the count of resident pages and the state of a huge page share a value of the map
+  */
+#define STATE_SHIFT 32
+#define COUNT_MASK  (((uint64_t) 1 << STATE_SHIFT) - 1)
+
+/**
+  * The number of huge pages the map starts out with room for
+  */
+#define EXPECTED_REGIONS 64
+
+status_t huge_pages_initialize(huge_pages_t *huge, unsigned int shift, size_t threshold)
+{
+	huge->shift = shift;
+	huge->pages = (size_t) 1 << shift;
+	huge->threshold = threshold;
+	if (threshold == 0 || threshold > huge->pages)
+	{
+		return OPTN_ERROR;
+	}
+
+	return hash_map_initialize(&huge->regions, EXPECTED_REGIONS);
+}
+
+void huge_pages_uninitialize(huge_pages_t *huge)
+{
+	hash_map_uninitialize(&huge->regions);
+}
+
+huge_state_t huge_pages_state(huge_pages_t *huge, uint64_t region)
+{
+	uint64_t *value = hash_map_find(&huge->regions, region);
+	return value == NULL ? HUGE_BASE : (huge_state_t) (*value >> STATE_SHIFT);
+}
+
+status_t huge_pages_map(huge_pages_t *huge, uint64_t region)
+{
+	uint64_t *value = hash_map_find(&huge->regions, region);
+	if (value == NULL)
+	{
+		return hash_map_put(&huge->regions, region, 1);
+	}
+
+	(*value)++;
+	return SUCCESS;
+}
+
+huge_state_t huge_pages_unmap(huge_pages_t *huge, uint64_t region)
+{
+	uint64_t *value = hash_map_find(&huge->regions, region);
+	huge_state_t state = (huge_state_t) (*value >> STATE_SHIFT);
+	uint64_t count = (*value & COUNT_MASK) - 1;
+	if (count == 0)
+	{
+		hash_map_remove(&huge->regions, region);
+	}
+	else
+	{
+		*value = count;
+	}
+
+	return state;
+}
+
+uint8_t huge_pages_begin(huge_pages_t *huge, uint64_t region)
+{
+	uint64_t *value = hash_map_find(&huge->regions, region);
+	if (value == NULL || (*value >> STATE_SHIFT) != HUGE_BASE || (*value & COUNT_MASK) < huge->threshold)
+	{
+		return 0;
+	}
+
+	*value |= (uint64_t) HUGE_PROMOTING << STATE_SHIFT;
+	return 1;
+}
+
+uint8_t huge_pages_finish(huge_pages_t *huge, uint64_t region)
+{
+	//an eviction while the pages were read in left the huge page as base pages
+	uint64_t *value = hash_map_find(&huge->regions, region);
+	if (value == NULL || (*value >> STATE_SHIFT) != HUGE_PROMOTING)
+	{
+		return 0;
+	}
+
+	uint64_t count = *value & COUNT_MASK;
+	*value = ((uint64_t) (count == huge->pages ? HUGE_MAPPED : HUGE_BASE) << STATE_SHIFT) | count;
+	return count == huge->pages;
+}
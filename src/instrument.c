@@ -0,0 +1,262 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/instrument.h"
+
+/**
+  * The number of pages the maps of references and faults start out with room for
+  */
+#define EXPECTED_PAGES 1024
+
+/**
+  * The names of the probes in the JSON output
+  */
+static const char *probe_names[PROBES] = { "tlb_lookup", "page_table_walk", "fault_service", "backing_store_io" };
+
+/**
+  * A page and the number of times it was referenced, for sorting the hottest pages to the front
+  */
+typedef struct
+{
+	uint64_t tag;
+	uint64_t accesses;
+} page_count_t;
+
+/**
+  * Returns the current monotonic time in nanoseconds
+  * @return the time
+  */
+static uint64_t now_ns(void);
+
+/**
+  * Adds one to the count of a key of a map, or adds the key with a count of one
+  * @param map   the map
+  * @param key   the key
+  * @param count the amount to add
+  * @return an indication of whether an error occurred
+  */
+static status_t count_add(hash_map_t *map, uint64_t key, uint64_t count);
+
+/**
+  * Orders pages from the most to the least referenced, and then by tag
+  */
+static int compare_counts(const void *a, const void *b);
+
+/**
+  * Writes a histogram as a JSON object of its count, sum, maximum and non-empty buckets
+  * @param histogram the histogram
+  * @param fout      the file to write to
+  */
+static void histogram_write_json(histogram_t *histogram, FILE *fout);
+
+status_t instrument_initialize(instrument_t *instrument)
+{
+	memset(instrument->latency, 0, sizeof instrument->latency);
+	memset(&instrument->reuse, 0, sizeof instrument->reuse);
+	instrument->cold = 0;
+
+	status_t error;
+	if ((error = stack_distance_initialize(&instrument->distances)) != SUCCESS)
+	{
+		return error;
+	}
+	if ((error = hash_map_initialize(&instrument->accesses, EXPECTED_PAGES)) != SUCCESS)
+	{
+		stack_distance_uninitialize(&instrument->distances);
+		return error;
+	}
+	if ((error = hash_map_initialize(&instrument->faults, EXPECTED_PAGES)) != SUCCESS)
+	{
+		hash_map_uninitialize(&instrument->accesses);
+		stack_distance_uninitialize(&instrument->distances);
+		return error;
+	}
+
+	instrument->start_ticks = instrument_ticks();
+	instrument->start_ns = now_ns();
+	return SUCCESS;
+}
+
+void instrument_uninitialize(instrument_t *instrument)
+{
+	hash_map_uninitialize(&instrument->faults);
+	hash_map_uninitialize(&instrument->accesses);
+	stack_distance_uninitialize(&instrument->distances);
+}
+
+status_t instrument_reference(instrument_t *instrument, uint64_t tag)
+{
+	uint64_t distance;
+	status_t error;
+	if ((error = stack_distance_access(&instrument->distances, tag, &distance)) != SUCCESS)
+	{
+		return error;
+	}
+	if (distance == STACK_DISTANCE_INFINITE)
+	{
+		instrument->cold++;
+	}
+	else
+	{
+		histogram_add(&instrument->reuse, distance);
+	}
+
+	return count_add(&instrument->accesses, tag, 1);
+}
+
+status_t instrument_fault(instrument_t *instrument, uint64_t tag)
+{
+	return count_add(&instrument->faults, tag, 1);
+}
+
+status_t instrument_add(instrument_t *total, instrument_t *instrument)
+{
+	size_t probe;
+	size_t bucket;
+	for (probe = 0; probe <= PROBES; probe++)
+	{
+		histogram_t *into = probe == PROBES ? &total->reuse : &total->latency[probe];
+		histogram_t *from = probe == PROBES ? &instrument->reuse : &instrument->latency[probe];
+		for (bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+		{
+			into->buckets[bucket] += from->buckets[bucket];
+		}
+		into->count += from->count;
+		into->sum += from->sum;
+		into->max = from->max > into->max ? from->max : into->max;
+	}
+	total->cold += instrument->cold;
+
+	size_t i;
+	status_t error;
+	for (i = 0; i < instrument->accesses.capacity; i++)
+	{
+		if (instrument->accesses.keys[i] != HASH_MAP_EMPTY &&
+			(error = count_add(&total->accesses, instrument->accesses.keys[i], instrument->accesses.values[i])) != SUCCESS)
+		{
+			return error;
+		}
+	}
+	for (i = 0; i < instrument->faults.capacity; i++)
+	{
+		if (instrument->faults.keys[i] != HASH_MAP_EMPTY &&
+			(error = count_add(&total->faults, instrument->faults.keys[i], instrument->faults.values[i])) != SUCCESS)
+		{
+			return error;
+		}
+	}
+
+	return SUCCESS;
+}
+
+status_t instrument_write_json(instrument_t *instrument, FILE *fout, unsigned int page_bits)
+{
+	//the hottest pages are only known once every page has been sorted by its references
+	page_count_t *pages = malloc((instrument->accesses.size + 1) * sizeof *pages);
+	if (pages == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	size_t number_pages = 0;
+	size_t i;
+	for (i = 0; i < instrument->accesses.capacity; i++)
+	{
+		if (instrument->accesses.keys[i] != HASH_MAP_EMPTY)
+		{
+			pages[number_pages].tag = instrument->accesses.keys[i];
+			pages[number_pages].accesses = instrument->accesses.values[i];
+			number_pages++;
+		}
+	}
+	qsort(pages, number_pages, sizeof *pages, compare_counts);
+
+	//the time stamp counter ticks at a constant rate, which the wall clock over the whole run gives
+	uint64_t ticks = instrument_ticks() - instrument->start_ticks;
+	uint64_t ns = now_ns() - instrument->start_ns;
+#if defined(__x86_64__) || defined(__i386__)
+	const char *unit = "cycles";
+	double ticks_per_ns = ns == 0 ? 0 : (double) ticks / ns;
+#else
+	const char *unit = "ns";
+	double ticks_per_ns = 1;
+#endif
+
+	fprintf(fout, "{\n  \"unit\": \"%s\",\n  \"ticks_per_ns\": %.4f,\n  \"latency\": {\n", unit, ticks_per_ns);
+	size_t probe;
+	for (probe = 0; probe < PROBES; probe++)
+	{
+		fprintf(fout, "    \"%s\": ", probe_names[probe]);
+		histogram_write_json(&instrument->latency[probe], fout);
+		fprintf(fout, probe + 1 < PROBES ? ",\n" : "\n");
+	}
+	fprintf(fout, "  },\n  \"reuse_distance\": ");
+	histogram_write_json(&instrument->reuse, fout);
+	fprintf(fout, ",\n  \"cold_references\": %" PRIu64 ",\n", instrument->cold);
+
+	fprintf(fout, "  \"pages\": {\n    \"distinct\": %zu,\n    \"hottest\": [", number_pages);
+	for (i = 0; i < number_pages && i < INSTRUMENT_HOT_PAGES; i++)
+	{
+		uint64_t *faults = hash_map_find(&instrument->faults, pages[i].tag);
+		fprintf(fout, "%s\n      { \"process\": %" PRIu64 ", \"page\": %" PRIu64 ", \"accesses\": %" PRIu64 ", \"faults\": %" PRIu64 " }",
+			i == 0 ? "" : ",", page_bits >= 64 ? 0 : pages[i].tag >> page_bits,
+			page_bits >= 64 ? pages[i].tag : pages[i].tag & (((uint64_t) 1 << page_bits) - 1),
+			pages[i].accesses, faults == NULL ? 0 : *faults);
+	}
+	fprintf(fout, "%s]\n  }\n}\n", number_pages == 0 ? "" : "\n    ");
+	free(pages);
+
+	return ferror(fout) ? WRIT_ERROR : SUCCESS;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static status_t count_add(hash_map_t *map, uint64_t key, uint64_t count)
+{
+	uint64_t *value = hash_map_find(map, key);
+	if (value == NULL)
+	{
+		return hash_map_put(map, key, count);
+	}
+
+	*value += count;
+	return SUCCESS;
+}
+
+static int compare_counts(const void *a, const void *b)
+{
+	const page_count_t *x = a;
+	const page_count_t *y = b;
+	if (x->accesses != y->accesses)
+	{
+		return x->accesses < y->accesses ? 1 : -1;
+	}
+	return x->tag < y->tag ? -1 : x->tag > y->tag;
+}
+
+static void histogram_write_json(histogram_t *histogram, FILE *fout)
+{
+	fprintf(fout, "{ \"count\": %" PRIu64 ", \"sum\": %" PRIu64 ", \"max\": %" PRIu64 ", \"mean\": %.2f, \"buckets\": [",
+		histogram->count, histogram->sum, histogram->max, histogram->count == 0 ? 0 : (double) histogram->sum / histogram->count);
+
+	//each bucket is written with the range of values it holds
+	const char *separator = "";
+	size_t bucket;
+	for (bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+	{
+		if (histogram->buckets[bucket] == 0)
+		{
+			continue;
+		}
+		uint64_t low = bucket == 0 ? 0 : (uint64_t) 1 << (bucket - 1);
+		uint64_t high = bucket == 0 ? 0 : low + (low - 1);
+		fprintf(fout, "%s{ \"low\": %" PRIu64 ", \"high\": %" PRIu64 ", \"count\": %" PRIu64 " }", separator, low, high, histogram->buckets[bucket]);
+		separator = ", ";
+	}
+	fprintf(fout, "] }");
+}
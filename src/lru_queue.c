@@ -2,69 +2,79 @@
 #include <stdlib.h>
 #include "../include/lru_queue.h"
 
-void lru_queue_initialize(lru_queue_t *queue)
-{
-	//create an empty/"artificial" head, to make insertion and deletion much simpler
-	queue->head = malloc(sizeof *queue->head);
-	queue->head->next = NULL;
-	queue->head->prev = NULL;
-	queue->tail = queue->head;
-}
+/**
+  * Unlinks the node for the given data value from the list, without marking it as unqueued
+  * @param queue the queue containing the node
+  * @param data  the data value whose node is to be unlinked
+  */
+static void lru_queue_unlink(lru_queue_t *queue, int data);
 
+/**
+  * Links the node for the given data value in at the most recently used end of the list
+  * @param queue the queue into which the node is linked
+  * @param data  the data value whose node is to be linked
+  */
+static void lru_queue_link_head(lru_queue_t *queue, int data);
 
-void lru_queue_uninitialize(lru_queue_t *queue)
+status_t lru_queue_initialize(lru_queue_t *queue, int capacity)
 {
-	while (!lru_queue_empty(queue))
+	//allocate one node per possible data value, plus the artificial head at index capacity. The
+	//head's next is the least recently used node and its prev is the most recently used one
+	queue->capacity = capacity;
+	if ((queue->nodes = malloc((capacity + 1) * sizeof *queue->nodes)) == NULL)
 	{
-		lru_queue_remove(queue);
+		return ALOC_ERROR;
 	}
 
-	//free the artificial head
-	free(queue->head);
+	int i;
+	for (i = 0; i < capacity; i++)
+	{
+		queue->nodes[i].next = LRU_NOT_QUEUED;
+		queue->nodes[i].prev = LRU_NOT_QUEUED;
+	}
+	queue->nodes[capacity].next = capacity;
+	queue->nodes[capacity].prev = capacity;
+	return SUCCESS;
+}
+
+void lru_queue_uninitialize(lru_queue_t *queue)
+{
+	free(queue->nodes);
+	queue->nodes = NULL;
+	queue->capacity = 0;
 }
 
 void lru_queue_insert_new(lru_queue_t *queue, int data)
 {
-	lru_node_t *node = malloc(sizeof *node);
-	node->data = data;
-	node->next = NULL;
-	node->prev = queue->head;
-	queue->head->next = node;
-	queue->head = node;
+	lru_queue_link_head(queue, data);
 }
 
 void lru_queue_update_existing(lru_queue_t *queue, int data)
 {
-	if (queue->head->data == data)
+	if (queue->nodes[queue->capacity].prev == data)
 	{
 		return;
 	}
 
-	lru_node_t *curr = queue->head->prev;
-	while (curr->data != data)
-	{
-		curr = curr->prev;
-	}
-
-	curr->prev->next = curr->next;
-	curr->next->prev = curr->prev;
-	curr->prev = queue->head;
-	queue->head->next = curr;
-	curr->next = NULL;
-	queue->head = curr;
+	lru_queue_unlink(queue, data);
+	lru_queue_link_head(queue, data);
 }
 
 void lru_queue_remove(lru_queue_t *queue)
 {
-	lru_node_t *node = queue->tail;
-	queue->tail = node->next;
-	queue->tail->prev= NULL;
-	free(node);
+	lru_queue_remove_existing(queue, queue->nodes[queue->capacity].next);
+}
+
+void lru_queue_remove_existing(lru_queue_t *queue, int data)
+{
+	lru_queue_unlink(queue, data);
+	queue->nodes[data].next = LRU_NOT_QUEUED;
+	queue->nodes[data].prev = LRU_NOT_QUEUED;
 }
 
 int lru_queue_get(lru_queue_t *queue)
 {
-	return queue->tail->next->data;
+	return queue->nodes[queue->capacity].next;
 }
 
 int lru_queue_poll(lru_queue_t *queue)
@@ -76,5 +86,71 @@ int lru_queue_poll(lru_queue_t *queue)
 
 unsigned short lru_queue_empty(lru_queue_t *queue)
 {
-	return queue->head == queue->tail;
+	return queue->nodes[queue->capacity].next == queue->capacity;
+}
+
+unsigned short lru_queue_contains(lru_queue_t *queue, int data)
+{
+	return queue->nodes[data].next != LRU_NOT_QUEUED;
+}
+
+void lru_queue_save(lru_queue_t *queue, snapshot_writer_t *writer)
+{
+	//the links, head included, are the whole of the queue's order
+	snapshot_write(writer, queue->nodes, (queue->capacity + 1) * sizeof *queue->nodes);
+}
+
+status_t lru_queue_restore(lru_queue_t *queue, snapshot_reader_t *reader)
+{
+	snapshot_read(reader, queue->nodes, (queue->capacity + 1) * sizeof *queue->nodes);
+
+	//the links must make a single circular list through the head, with every node off it marked
+	//unqueued. A node only has one prev, so a walk which checks each step against it cannot go
+	//round any loop but the one back to the head
+	int queued = 0;
+	int node = queue->capacity;
+	do
+	{
+		int next = queue->nodes[node].next;
+		if (next < 0 || next > queue->capacity || queue->nodes[next].prev != node)
+		{
+			return FORM_ERROR;
+		}
+		queued += next != queue->capacity;
+		node = next;
+	}
+	while (node != queue->capacity);
+
+	int i;
+	for (i = 0; i < queue->capacity; i++)
+	{
+		if (queue->nodes[i].next == LRU_NOT_QUEUED)
+		{
+			if (queue->nodes[i].prev != LRU_NOT_QUEUED)
+			{
+				return FORM_ERROR;
+			}
+		}
+		else
+		{
+			queued--;
+		}
+	}
+	return queued == 0 ? SUCCESS : FORM_ERROR;
+}
+
+static void lru_queue_unlink(lru_queue_t *queue, int data)
+{
+	lru_node_t *node = queue->nodes + data;
+	queue->nodes[node->prev].next = node->next;
+	queue->nodes[node->next].prev = node->prev;
+}
+
+static void lru_queue_link_head(lru_queue_t *queue, int data)
+{
+	int head = queue->nodes[queue->capacity].prev;
+	queue->nodes[data].prev = head;
+	queue->nodes[data].next = queue->capacity;
+	queue->nodes[head].next = data;
+	queue->nodes[queue->capacity].prev = data;
 }
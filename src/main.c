@@ -1,279 +1,86 @@
-#include <ctype.h>
+#include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-#include "../include/lru_queue.h"
-
-#define EXTRA_CHARS 1
-
-#define MIN_ARGS 3
-#define ASCII_0 48
-
-/**
-  * Define error constants. Contain a mixture of user (e.g., not enough command line arguments) and
-  * system (e.g., couldn't read from an open file) errors
-  */
-#define SUCCESS    0
-#define ARGS_ERROR 1
-#define OPEN_ERROR 2
-#define NUMB_ERROR 3
-#define SEEK_ERROR 4
-#define READ_ERROR 5
-
-/**
-  * Define the type for the erorrs. Allows for a total of 2^64 - 1 types of error conditions (plus a
-  * succcess condition)
-  */
-typedef uint64_t status_t;
-
-
-/**
-  * Define variosu contants for the size of pages, the total number of pages, the size of frames,
-  * the total number of frames, etc. Note that these constants assume that the number of bits in a
-  * page number is the same as the number of bits in the offset.
-  */
-#define BITS_PER_BYTE     8
-#define OFFSET_BITS       sizeof(offset_t) * BITS_PER_BYTE
-#define NUMBER_PAGES      256 
-#define MAX_PAGE_NUMBER   NUMBER_PAGES - 1
-#define MAX_OFFSET        255 
-#define PAGE_BYTES        256
-#define NUMBER_FRAMES     128
-#define MAX_FRAME_NUMBER  NUMBER_FRAMES - 1
-#define FRAME_BYTES       PAGE_BYTES
-#define TLB_ENTRIES       16
-#define INVALID_PAGE      NUMBER_PAGES
-
-typedef uint16_t virtual_address_t;
-
-/**
-  * Used to hold the number of a page, in the range 0 to MAX_PAGe_NUMBER (currently 255)
-  */
-typedef uint8_t page_number_t;
-
-/**
-  * Used to hold the offset from the beginning of a page/frame that a data value begins at, in the
-  * range 0 to MAX_OFFSET (currently 255)
-  */
-typedef uint8_t offset_t;
-
-/**
-  * Holds the two components of a virtual address, the page number and the offset within the page
-  */
-typedef struct
-{
-	page_number_t page;
-	offset_t offset;
-} virtual_components_t;
-
-/**
-  * Used to hold a physical address value, in the range 0 to 32768 (NUMBER_FRAMES * FRAME_BYTES)
-  */
-typedef uint16_t physical_address_t;
-
-/**
-  * Used to hold a frame number, from 0 to NUMBER_FRAMES - 1
-  */
-typedef uint8_t frame_number_t;
+#include <time.h>
+
+#include "../include/backing_store.h"
+#include "../include/memmgr.h"
+#include "../include/options.h"
+#include "../include/output.h"
+#include "../include/page_table.h"
+#include "../include/schedule.h"
+#include "../include/status.h"
+#include "../include/trace.h"
+#include "../include/write_back.h"
 
 /**
-  * A single, individual value in a frame.
+  * While a trace streams in and is reported on every so many seconds, the clock is read after
+  * every REPORT_CLOCK_EVERY references, as well as after every batch
   */
-typedef int8_t frameval_t;
+#define REPORT_CLOCK_EVERY 4096
 
 /**
-  * The frame table data structure. Holds the actual physical memory and information on which frame
-  * is to be used next upon a page fault
+  * A window of a trace streaming in, whose statistics are reported once it closes: its number, the
+  * references in it so far, when it started, and the totals of the statistics as it did
   */
 typedef struct
 {
-	frame_number_t used_frames;
-	frameval_t table[NUMBER_FRAMES][FRAME_BYTES];
-	page_number_t page_for_frame[NUMBER_FRAMES];
-	lru_queue_t queue;
-} frame_table_t;
+	size_t number;
+	size_t references;
+	struct timespec start;
+	statistics_t before;
+} report_window_t;
 
 /**
-  * Used to represent a single entry in a page table, including which frame is being referenced and
-  * whether the reference is currently valid
+  * Set once the simulation is interrupted while a trace streams in, which ends the trace there
   */
-typedef struct
-{
-	frame_number_t frame;
-	uint8_t valid;
-	uint8_t dirty;
-} page_entry_t;
-
-/**
-  * The data structure for the page table, made up of an array of page entries
-  */
-typedef struct
-{
-	page_entry_t table[NUMBER_PAGES];
-} page_table_t;
-
-/**
-  * Holds the information on the TLB, including which page numbers are in it and which entry is to
-  * be replaced next. Note that TLB does not need to contain dirty bit information because page
-  * table is always consulted for this
-  */
-typedef struct
-{
-	uint16_t pages[TLB_ENTRIES];
-	frame_number_t frames[TLB_ENTRIES];
-	lru_queue_t queue;
-} tlb_t;
-
-/**
-  * Holds a variety of statistical information, including total number of addresses translated,
-  * number of page faults, number of tlb hits, and number of write-backs occuring
-  */
-typedef struct
-{
-	size_t translated;
-	size_t page_faults;
-	size_t tlb_hits;
-	size_t write_backs;
-} statistics_t;
-
-static statistics_t statistics;
+static volatile sig_atomic_t interrupted;
 
 //DRIVER FUNCTIONS---------------------------------------------------------------------------------
 	/**
 	  * After initialization, acts as the main driving function
-	  * @param fin     the file from which the memory addresses will be read
-	  * @param backing the file which contains the backing store
-	  * @return an indication of whether an error occurred
-	  */
-	status_t perform_management(FILE *fin, FILE *backing);
-
-	/**
-	  * For a single virtual address, this function will perform all necessary calculations and
-	  * retrieves to ultimately print out the value at the address
-	  * @param fin        the file from which the memory addresses are read
-	  * @param backing    the file which contains the backing store
-	  * @param address    the virtual address being accesses
-	  * @param frames     the frame table
-	  * @param page_table the page_table
-	  * @param tlb        the current tlb
-	  * @param is_write   whether the current memory access is a write or not
+	  * @param schedule   the schedule from which the memory addresses of every process will be read
+	  * @param backing    the backing store
+	  * @param write_back where dirty pages are written back, or NULL when writes are not simulated
+	  * @param options    the command line options
 	  * @return an indication of whether an error occurred
 	  */
-	status_t print_for_address(FILE *fin, FILE *backing, virtual_address_t address, frame_table_t *frames, page_table_t *page_table, tlb_t *tlb, uint8_t is_write);
-//END DRIVER FUNCTIONS------------------------------------------------------------------------------
+	status_t perform_management(schedule_t *schedule, backing_store_t *backing, write_back_t *write_back, options_t *options);
 
-//VIRTUAL ADDRESS FUNCTIONS-------------------------------------------------------------------------
 	/**
-	  * Given a string of a particular length, converts it to a virtual address value
-	  * @param line   the string to be converted
-	  * @param length the length of the string
-	  * @param value  the out parameter which will hold the calculated virtual address
+	  * Runs every reference of the schedule through the memory, a batch at a time, reporting on
+	  * each window of a trace streaming in
+	  * @param schedule the schedule from which the memory addresses will be read
+	  * @param options  the command line options
+	  * @param manager  the simulated memory
 	  * @return an indication of whether an error occurred
 	  */
-	status_t convert(char *line, size_t length, virtual_address_t *value);
-
-	/**
-	  * Pulls out the components, the page and the offset, of the virtual address
-	  * @param address the virtual address of which to get the components
-	  * @return a structure containing the components of the address
-	  */
-	virtual_components_t get_components(virtual_address_t address);
+	status_t simulate(schedule_t *schedule, options_t *options, memmgr_t *manager);
 
 	/**
-	  * Pulls out the offset of the virtual address
-	  * @param address the virtual address of which to get the offset
-	  * @return the offset of the address
-	  */
-	offset_t get_offset(virtual_address_t address);
-
-	/**
-	  * Pulls out the page number of the virtual address
-	  * @param address the virtual address of which to get the page number
-	  * @return the page number of the address
-	  */
-	page_number_t get_page(virtual_address_t address);
-//END VIRTUAL ADDRESS FUNCTIONS---------------------------------------------------------------------
-
-//FRAME TABLE FUNCTIONS-----------------------------------------------------------------------------
-	/**
-	  * Initializes a frame table data structure after it has been declared
-	  * @param frames the frame table to initialize
-	  */
-	void frame_table_initialize(frame_table_t *frames);
-
-	/**
-	  * Uninitializes a frame table data structure after it is no longer needed.
-	  * @param frames the frame table to uninitialize
-	  */
-	void frame_table_uninitialize(frame_table_t *frames);
-
-	/**
-	  * If the page at the given page number is not already loaded into a frame, this function will
-	  * load it into a frame from the backing store, updating the page table as necessary; if the
-	  * page is already loaded, this function has no effect
-	  * @param ptable  the current page table
-	  * @param page    the number of the page that needs to be loaded
-	  * @param ftable  the current frame table
-	  * @param backing the backing store holding all memory information
-	  * @return an indication of whether an error occurred
+	  * Prints the statistics of the window of a streaming trace which has just closed, as a line of
+	  * a table, and starts the next window
+	  * @param manager the simulated memory
+	  * @param summary the file to print to
+	  * @param window  the window
 	  */
-	status_t load_if_necessary(page_table_t *ptable, page_number_t page, frame_table_t *ftable, FILE *backing);
+	void report_window(memmgr_t *manager, FILE *summary, report_window_t *window);
 
 	/**
-	  * Gets the value from the frame table at the particular address
-	  * @param frames    the frame table
-	  * @param phys_addr the physical address from which the value is being retrieved
-	  * @return the value at the given physical address
+	  * Finds how long a window of a streaming trace has been open
+	  * @param window the window
+	  * @return the number of seconds since the window started
 	  */
-	frameval_t get_value_at_address(frame_table_t *frames, physical_address_t phys_addr);
-//END FRAME TABLE FUNCTIONS------------------------------------------------------------------------
+	double window_seconds(report_window_t *window);
 
-//TLB FUNCTIONS------------------------------------------------------------------------------------
 	/**
-	  * Initializes a TLB data structure after it has been declared
-	  * @param tlb the TLB to be initialized
+	  * Ends a streaming trace after the batch being simulated; installed for SIGINT
+	  * @param signal the signal
 	  */
-	void tlb_initialize(tlb_t *tlb);
-
-	/**
-	  * Uninitializes a TLB data structure after it is no longer needed
-	  * @param tlb the TLB to be uninitialized
-	  */
-	void tlb_uninitialize(tlb_t *tlb);
-
-	/**
-	  * Tries to get the frame for the given page from the given TLB. Places the frame in frame and
-	  * returns the index in the TLB of the discovered entry, upon success. Upon failure, returns
-	  * TLB_ENTRIES
-	  * @param tlb   the tlb to be searched
-	  * @param page  the number of the page for which the frame is to be found
-	  * @param frame out param which will hold the frame number for the page upon success
-	  * @return if the frame is successfully found, returns the index in the tlb of the tlb entry;
-	  * otherwise, returns TLB_ENTRIES
-	  */
-	int get_frame_from_tlb(tlb_t *tlb, page_number_t page, frame_number_t *frame);
-//END TLB FUNCTIONS--------------------------------------------------------------------------------
-
-//PHYSICAL ADDRESS FUNCTIONS-----------------------------------------------------------------------
-	/**
-	  * Given a page table and the components of a virtual address, returns the physical address
-	  * corresponding to the components
-	  * @param ptable     the current page table
-	  * @param components the components of the virtual address
-	  * @return the physical address corresponding to the components
-	  */
-	physical_address_t get_physical_address_from_page_table(page_table_t *ptable, virtual_components_t *components);
-
-	/**
-	  * Given a frame number and an offset, returns the corresponding physical address
-	  * @param frame  the frame number
-	  * @param offset the offset from the beginning of the frame
-	  * @return the physical address corresponding to the frame and the offset
-	  */
-	physical_address_t get_physical_address(frame_number_t frame, offset_t offset);
-//PHYSICAL ADDRESS FUNCTIONS-----------------------------------------------------------------------
+	void interrupt_stream(int signal);
+//END DRIVER FUNCTIONS------------------------------------------------------------------------------
 
 //ERROR FUNCTIONS----------------------------------------------------------------------------------
 	/**
@@ -287,291 +94,245 @@ static statistics_t statistics;
 
 int main(int argc, char *argv[])
 {
-	if (argc < MIN_ARGS)
-	{
-		return error_message(ARGS_ERROR);
-	}
-	
-	FILE *fin;
-	if ((fin = fopen(argv[1], "r")) == NULL)
+	options_t options;
+	options_initialize(&options);
+
+	status_t error;
+	if ((error = options_parse(&options, argc, argv)) != SUCCESS)
 	{
-		return error_message(OPEN_ERROR);
+		if (error == ARGS_ERROR)
+		{
+			options_usage(argv[0]);
+		}
+		return error_message(error);
 	}
 
-	FILE *backing;
-	if ((backing = fopen(argv[2], "r")) == NULL)
+	if ((error = memmgr_check(&options)) != SUCCESS)
 	{
-		fclose(fin);
-		return error_message(OPEN_ERROR);
+		return error_message(error);
 	}
 
-	status_t error = perform_management(fin, backing);
+	uint8_t windowed = options.report_references > 0 || options.report_seconds > 0;
 
-	fclose(backing);
-	fclose(fin);
-	return error_message(error);
-}
+	//interrupting a trace reported on as it streams in ends it, so that the statistics of the whole
+	//run are still printed. Without SA_RESTART, a read waiting on the stream gives up at once
+	if (windowed)
+	{
+		struct sigaction action;
+		memset(&action, 0, sizeof action);
+		action.sa_handler = interrupt_stream;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGINT, &action, NULL);
+	}
 
-status_t perform_management(FILE *fin, FILE *backing)
-{
-	frame_table_t frames;
-	frame_table_initialize(&frames);
-	page_table_t page_table = {0};
-	tlb_t tlb;
-	tlb_initialize(&tlb);
-	
-	char *line = NULL;
-	size_t size = 0;
-	ssize_t chars_read;
-	while ((chars_read = getline(&line, &size, fin)) > 0)
+	schedule_t schedule;
+	if ((error = schedule_open(&schedule, options.input_files, options.number_inputs, options.quantum, options.address_bits)) != SUCCESS)
 	{
-		//eliminate the newline and the carriage return as well as one for the space
-		//and the Read/Write indicator
-		chars_read -= EXTRA_CHARS;
-
-		//sanitize input - it cannot be assumed that the input file has a regular form - make sure
-		//to handle R/W indications and no R/W indications as well as the occasional space at the
-		//end of a line
-		if (line[chars_read - 1] == ' ')
-		{
-			chars_read--;
-		}
-		uint8_t is_write = line[chars_read - 1] == 'W';
-		if (is_write || line[chars_read - 1] == 'R')
-		{
-			chars_read -= 2;
-		}
-		line[chars_read] = '\0';
-		
-		//convert the string to the address
-		virtual_address_t address;
-		status_t error;
-		if ((error = convert(line, chars_read, &address)) != SUCCESS)
-		{
-			fprintf(stderr, "%s\n", line);
-			error_message(error);
-		}
-		else if ((error = print_for_address(fin, backing, address, &frames, &page_table, &tlb, is_write)) != SUCCESS)
-		{
-			free(line);
-			return error;
-		}
+		return error_message(error);
 	}
 
-	fprintf(stdout, "Number of Translated Addresses = %zu\n", statistics.translated);
-	fprintf(stdout, "Percentage of Page Faults = %lf (absolute = %zu)\n", (double) statistics.page_faults / statistics.translated, statistics.page_faults);
-	fprintf(stdout, "TLB Hit Ratio = %lf (absolute = %zu)\n", (double) statistics.tlb_hits / statistics.translated, statistics.tlb_hits);
-	fprintf(stdout, "Write-Backs = %lf (absolute = %zu)\n", (double) statistics.write_backs / statistics.translated, statistics.write_backs);
+	//writes go to a copy of the backing store, never to the original
+	backing_store_t backing;
+	if ((options.write_back == WRITE_BACK_NONE && (error = backing_store_open(&backing, options.backing_file, options.page_bytes, options.backing_mode)) != SUCCESS) ||
+		(options.write_back != WRITE_BACK_NONE && (error = backing_store_open_copy(&backing, options.backing_file, options.store_copy, options.page_bytes, options.backing_mode)) != SUCCESS))
+	{
+		schedule_close(&schedule);
+		return error_message(error);
+	}
 
-	free(line);
-	tlb_uninitialize(&tlb);
-	frame_table_uninitialize(&frames);
-	return SUCCESS;
-}
+	write_back_t write_back;
+	if ((error = write_back_initialize(&write_back, &backing, options.write_back)) != SUCCESS)
+	{
+		backing_store_close(&backing);
+		schedule_close(&schedule);
+		return error_message(error);
+	}
 
-status_t print_for_address(FILE *fin, FILE *backing, virtual_address_t address, frame_table_t *frames, page_table_t *page_table, tlb_t *tlb, uint8_t is_write)
-{
-	//get the page and offset from the address
-	virtual_components_t components = get_components(address);
-	
-	frame_number_t frame;
-	physical_address_t phys_addr;
-	int tlb_entry;
-	if ((tlb_entry = get_frame_from_tlb(tlb, components.page, &frame)) != TLB_ENTRIES)
+	if (options.mrc)
 	{
-		phys_addr = get_physical_address(frame, components.offset);
+		error = memmgr_run_mrc(&schedule, &options);
 	}
-	else 
+	else if (options.sweep_frames != NULL || options.sweep_tlb != NULL || options.sweep_policies != NULL)
 	{
-		status_t error;
-		if ((error = load_if_necessary(page_table, components.page, frames, backing)) != SUCCESS)
-		{
-			return error;
-		}
-
-		phys_addr = get_physical_address_from_page_table(page_table, &components);
-
-		//update the tlb
-		tlb_entry = lru_queue_get(&tlb->queue);
-		tlb->pages[tlb_entry] = components.page;
-		tlb->frames[tlb_entry] = page_table->table[components.page].frame;
+		error = memmgr_run_sweep(&schedule, &backing, &options);
 	}
-
-	//actually retrieve the memory value at the given physical address
-	frameval_t memval = get_value_at_address(frames, phys_addr);
-	fprintf(stdout, "Virtual address: %u Physical address: %u Value: %d\n", address, phys_addr, memval);
-
-	//if it's a write, set the dirty bit after the memory access
-	if (is_write)
+	else if (options.cores)
 	{
-		//don't bother actually writing the page back out, because this program does not actually do
-		//any writing
-		page_table->table[components.page].dirty = 1;
+		error = memmgr_run_cores(&schedule, &backing, options.write_back == WRITE_BACK_NONE ? NULL : &write_back, &options);
+	}
+	else
+	{
+		error = perform_management(&schedule, &backing, options.write_back == WRITE_BACK_NONE ? NULL : &write_back, &options);
 	}
 
-	//update the LRU information for the tlb
-	lru_queue_update_existing(&tlb->queue, tlb_entry);
-
-	
-	//indicate that the frame has just been referenced to bring it to the front of the LRU queue
-	lru_queue_update_existing(&frames->queue, page_table->table[components.page].frame);
-
-	//update the statistics
-	statistics.translated++;
-
-	return SUCCESS;
-}
-
-status_t convert(char *s, size_t length, virtual_address_t *value)
-{
-    *value = 0;
-    size_t power10;
-    size_t i;
-    for (i = length - 1, power10 = 1; i < SIZE_MAX; i--, power10 *= 10)
-    {
-        if (!isdigit(s[i]))
-        {
-            return NUMB_ERROR;
-        }
-        *value += (s[i] - ASCII_0) * power10;
-    }
-
-    return SUCCESS;
-}
+	//the flusher finishes whatever is still queued before it stops
+	status_t write_error = write_back_uninitialize(&write_back);
+	if (error == SUCCESS)
+	{
+		error = write_error;
+	}
 
-virtual_components_t get_components(virtual_address_t address)
-{
-	virtual_components_t components = { get_page(address), get_offset(address) };
-	return components;
+	backing_store_close(&backing);
+	schedule_close(&schedule);
+	free(options.store_copy);
+	free(options.instrument_file);
+	free(options.snapshot_file);
+	free(options.restore_file);
+	free(options.sweep_frames);
+	free(options.sweep_tlb);
+	free(options.sweep_policies);
+	return error_message(error);
 }
 
-page_number_t get_page(virtual_address_t address)
+status_t perform_management(schedule_t *schedule, backing_store_t *backing, write_back_t *write_back, options_t *options)
 {
-	//shift right by the OFFSET_SIZE (because the offset takes up the lower bits), and than AND by
-	//the max value to get the value of the upper bits are
-	return (address >> OFFSET_BITS) & MAX_PAGE_NUMBER;
-}
+	status_t error;
+	output_t out;
+	if ((error = output_initialize(&out, stdout, options->stats_only ? OUTPUT_NONE : options->output_format)) != SUCCESS)
+	{
+		return error;
+	}
 
-offset_t get_offset(virtual_address_t address)
-{
-	return address & MAX_OFFSET;
-}
+	memmgr_t *manager;
+	if ((error = memmgr_open(&manager, options, backing, write_back, &out)) != SUCCESS)
+	{
+		output_uninitialize(&out);
+		return error;
+	}
+	if (options->restore_file != NULL && (error = memmgr_restore(manager, options->restore_file)) != SUCCESS)
+	{
+		memmgr_close(manager);
+		output_uninitialize(&out);
+		return error;
+	}
 
+	//write out whatever was printed before any error, and only then the statistics, which would
+	//break up CSV or binary output, so go to stderr instead
+	error = simulate(schedule, options, manager);
+	status_t write_error = output_uninitialize(&out);
+	if (error == SUCCESS && (error = write_error) == SUCCESS)
+	{
+		FILE *summary = out.format == OUTPUT_CSV || out.format == OUTPUT_BINARY ? stderr : stdout;
+		error = memmgr_print_statistics(manager, summary);
+	}
+	if (error == SUCCESS && options->snapshot_file != NULL)
+	{
+		error = memmgr_save(manager, options->snapshot_file);
+	}
 
-void frame_table_initialize(frame_table_t *frames)
-{
-	frames->used_frames = 0;
-	lru_queue_initialize(&frames->queue);
-	size_t i;
-	for (i = 0; i < NUMBER_FRAMES; i++)
+	//the pages written back by the final flush are timed too
+	if (error == SUCCESS)
 	{
-		lru_queue_insert_new(&frames->queue, NUMBER_FRAMES - i - 1);
+		error = memmgr_flush(manager);
 	}
+	memmgr_close(manager);
+	return error;
 }
 
-void frame_table_uninitialize(frame_table_t *frames)
+status_t simulate(schedule_t *schedule, options_t *options, memmgr_t *manager)
 {
-	lru_queue_uninitialize(&frames->queue);
-}
+	//an offline policy needs the whole trace up front to know the future; otherwise the trace is
+	//simulated a batch at a time
+	uint8_t offline = memmgr_offline(manager);
+
+	//a trace streaming in is reported on as it goes, a window at a time, beside any values
+	//printed rather than among them
+	report_window_t window = { 0, 0, { 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 } };
+	uint8_t windowed = options->report_references > 0 || options->report_seconds > 0;
+	FILE *reports = options->stats_only || options->output_format == OUTPUT_NONE ? stdout : stderr;
+	if (windowed)
+	{
+		fprintf(reports, "Window References Page_Faults Fault_Rate TLB_Hits TLB_Hit_Ratio Write_Backs Seconds\n");
+		clock_gettime(CLOCK_MONOTONIC, &window.start);
 
-status_t load_if_necessary(page_table_t *ptable, page_number_t page, frame_table_t *frames, FILE *backing)
-{
-	if (!ptable->table[page].valid)
+		//a memory restored from a snapshot starts out with the statistics of the run which saved it
+		memmgr_statistics(manager, &window.before);
+	}
+
+	status_t error;
+	trace_t *trace;
+	while ((error = schedule_read(schedule, offline ? TRACE_ALL : TRACE_BATCH, &trace)) == SUCCESS && trace->length > 0)
 	{
-		statistics.page_faults++;
-		
-		//adjust the backing store file to the correct position
-		if (fseek(backing, page * FRAME_BYTES, SEEK_SET) < 0)
+		if (offline && (error = memmgr_set_future(manager, trace)) != SUCCESS)
 		{
-			return SEEK_ERROR;
+			break;
 		}
 
-		frame_number_t next_frame;
-		if (frames->used_frames < NUMBER_FRAMES)
-		{
-			next_frame = frames->used_frames;
-			frames->used_frames++;
-		}
-		else
+		//the batch is translated in one call, unless a window closes within it. A window closes
+		//after its references, or with the first reference past its time, which is only looked
+		//for every REPORT_CLOCK_EVERY references
+		size_t position;
+		size_t count;
+		for (position = 0; position < trace->length; position += count)
 		{
-			next_frame = lru_queue_get(&frames->queue);
-			//invalidate the page previously at the frame. Note that the TLB does not have to be
-			//updated because both the TLB and the frame table use LRU behavior to determine the
-			//next thing to remove. Therefore, if something is in the TLB, there is no way it could
-			//be invalidated here, because it would have been used more recently than 128 pages ago
-			//(because the TLB has only 16 entries)
-			page_number_t prev_page = frames->page_for_frame[next_frame];
-			ptable->table[prev_page].valid = 0;
-			if (ptable->table[prev_page].dirty)
+			count = trace->length - position;
+			if (options->report_references > 0 && count > options->report_references - window.references)
 			{
-				statistics.write_backs++;
+				count = options->report_references - window.references;
+			}
+			if (options->report_seconds > 0 && count > REPORT_CLOCK_EVERY - window.references % REPORT_CLOCK_EVERY)
+			{
+				count = REPORT_CLOCK_EVERY - window.references % REPORT_CLOCK_EVERY;
+			}
+
+			if ((error = memmgr_translate_batch(manager, trace->addresses + position, trace->writes + position, count, NULL)) != SUCCESS)
+			{
+				break;
+			}
+
+			if (windowed && ((window.references += count) == options->report_references || (options->report_seconds > 0 &&
+				window.references % REPORT_CLOCK_EVERY == 0 && window_seconds(&window) >= options->report_seconds)))
+			{
+				report_window(manager, reports, &window);
 			}
 		}
-		//read the file into the frames table at the next available frame
-		if (fread(frames->table + next_frame, FRAME_BYTES, 1, backing) < 1) 
+
+		//a batch ends where the stream ran dry for the moment, which may be long past the time
+		if (windowed && options->report_seconds > 0 && window.references > 0 && window_seconds(&window) >= options->report_seconds)
 		{
-			return READ_ERROR;
+			report_window(manager, reports, &window);
 		}
 
-		//then indicate the frame associated with the page and mark the table entry valid and
-		//undirty
-		ptable->table[page].frame = next_frame; 
-		ptable->table[page].valid = 1;
-		ptable->table[page].dirty = 0;
-		//and associate the given frame with the new page
-		frames->page_for_frame[next_frame] = page;
-
+		if (error != SUCCESS || offline || interrupted)
+		{
+			break;
+		}
 	}
-
-	return SUCCESS;
-}
-
-frameval_t get_value_at_address(frame_table_t *frames, physical_address_t phys_addr)
-{
-	return *((frameval_t *) frames->table + phys_addr); 
-}
-
-void tlb_initialize(tlb_t *tlb)
-{
-	lru_queue_initialize(&tlb->queue);
-	
-	size_t i;
-	for (i = 0; i < TLB_ENTRIES; i++)
+	if (error == SUCCESS && window.references > 0)
 	{
-		tlb->pages[i] = INVALID_PAGE;
-		lru_queue_insert_new(&tlb->queue, TLB_ENTRIES - i - 1);
+		report_window(manager, reports, &window);
 	}
-}
 
-void tlb_uninitialize(tlb_t *tlb)
-{
-	lru_queue_uninitialize(&tlb->queue);
+	return error;
 }
 
-int get_frame_from_tlb(tlb_t *tlb, page_number_t page, frame_number_t *frame)
+void report_window(memmgr_t *manager, FILE *summary, report_window_t *window)
 {
-	size_t i;
-	for (i = 0; i < TLB_ENTRIES; i++)
-	{
-		if (tlb->pages[i] == page)
-		{
-			statistics.tlb_hits++;
-			*frame = tlb->frames[i];
-			return i;
-		}
-	}
-
-	return TLB_ENTRIES;
+	statistics_t total;
+	memmgr_statistics(manager, &total);
+
+	size_t faults = total.page_faults - window->before.page_faults;
+	size_t hits = total.tlb_hits - window->before.tlb_hits;
+	fprintf(summary, "%zu %zu %zu %lf %zu %lf %zu %lf\n", window->number, window->references, faults, (double) faults / window->references,
+		hits, (double) hits / window->references, total.write_backs - window->before.write_backs, window_seconds(window));
+	fflush(summary);
+
+	window->number++;
+	window->references = 0;
+	window->before = total;
+	clock_gettime(CLOCK_MONOTONIC, &window->start);
 }
 
-physical_address_t get_physical_address_from_page_table(page_table_t *ptable, virtual_components_t *components)
+double window_seconds(report_window_t *window)
 {
-	return get_physical_address(ptable->table[components->page].frame, components->offset);
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - window->start.tv_sec) + (now.tv_nsec - window->start.tv_nsec) / 1e9;
 }
 
-physical_address_t get_physical_address(frame_number_t frame, offset_t offset)
+void interrupt_stream(int signal)
 {
-	return frame * FRAME_BYTES + offset;
+	interrupted = 1;
 }
 
 status_t error_message(status_t error)
@@ -583,6 +344,15 @@ status_t error_message(status_t error)
 		case ARGS_ERROR:
 			fprintf(stderr, "Error: please include input files as command line arguments.\n");
 			break;
+		case OPTN_ERROR:
+			fprintf(stderr, "Error: invalid command line or configuration option.\n");
+			break;
+		case GEOM_ERROR:
+			fprintf(stderr, "Error: invalid memory geometry. The page size must be a power of two no larger than the address space, which may be at most %d bits along with the numbers of several processes, the TLB entries must split into a power of two sets of the TLB ways each, at most 2^%d pages of every process together may be told apart, a flat page table may have at most 2^%d entries, local replacement needs a frame for every process, and a huge page must be a power of two larger than a page which fits in the address space and in the frames of a process.\n", MAX_ADDRESS_BITS, MAX_TAG_BITS, MAX_FLAT_BITS);
+			break;
+		case ALOC_ERROR:
+			fprintf(stderr, "Error: could not allocate memory.\n");
+			break;
 		case OPEN_ERROR:
 			fprintf(stderr, "Error: could not open file.\n");
 			break;
@@ -595,6 +365,12 @@ status_t error_message(status_t error)
 		case READ_ERROR:
 			fprintf(stderr, "Error: could not read from file.\n");
 			break;
+		case WRIT_ERROR:
+			fprintf(stderr, "Error: could not write to file.\n");
+			break;
+		case FORM_ERROR:
+			fprintf(stderr, "Error: not a valid binary trace or snapshot, or a binary trace which is not a regular file.\n");
+			break;
 		default:
 			fprintf(stderr, "Error: unknown error.\n");
 			break;
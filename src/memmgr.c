@@ -0,0 +1,3469 @@
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "../include/backing_store.h"
+#include "../include/dedup.h"
+#include "../include/huge_pages.h"
+#include "../include/instrument.h"
+#include "../include/memmgr.h"
+#include "../include/mrc.h"
+#include "../include/options.h"
+#include "../include/output.h"
+#include "../include/page_table.h"
+#include "../include/pipeline.h"
+#include "../include/policy.h"
+#include "../include/prefetch.h"
+#include "../include/resident_set.h"
+#include "../include/schedule.h"
+#include "../include/snapshot.h"
+#include "../include/status.h"
+#include "../include/trace.h"
+#include "../include/work_pool.h"
+#include "../include/write_back.h"
+#include "../include/zswap.h"
+
+/**
+  * The most pages of an address space for which a flat page table is chosen when no design is
+  * given
+  */
+#define MAX_PAGE_BITS     28
+#define INVALID_PAGE      UINT64_MAX
+
+/**
+  * A tag, at most MAX_TAG_BITS wide, must stay below INVALID_PAGE. The TLB entry of a huge page is
+  * tagged with the tag of its first page shifted down by geometry.huge_shift, with HUGE_TAG_BIT set
+  * so that it can never match the tag of a base page
+  */
+#define HUGE_TAG_BIT      ((page_number_t) 1 << MAX_TAG_BITS)
+
+/**
+  * Each set of the TLB is padded out to a multiple of this many entries, so that its tags can be
+  * compared a whole vector register at a time, and TLB_MISS is returned by a failed lookup
+  */
+#define TLB_LANES 4
+#define TLB_MISS  -1
+
+/**
+  * The TLB replacement policy used in each set when none is given and the TLB is set associative;
+  * a fully associative TLB uses DEFAULT_POLICY
+  */
+#define DEFAULT_SET_POLICY "plru"
+
+/**
+  * With several cores, the frames are split into shards of their own replacement policy and lock,
+  * about SHARDS_PER_CORE for each core so that two cores rarely want the same one. A TLB queues up
+  * to TLB_SHOOTDOWNS pages shot down by other cores, and beyond that is flushed entirely
+  */
+#define SHARDS_PER_CORE 4
+#define TLB_SHOOTDOWNS  32
+
+/**
+  * When the backing store is read through a pipeline, the references up to PIPELINE_LOOKAHEAD
+  * ahead of the one being simulated are decoded and their missing pages issued
+  */
+#define PIPELINE_LOOKAHEAD 1024
+
+/**
+  * The bytes a snapshot keeps for the name of each replacement policy
+  */
+#define SNAPSHOT_NAME_BYTES 16
+
+typedef uint64_t virtual_address_t;
+
+/**
+  * Used to hold the number of a page, in the range 0 to geometry.max_page_number
+  */
+typedef uint64_t page_number_t;
+
+/**
+  * Used to hold the offset from the beginning of a page/frame that a data value begins at, in the
+  * range 0 to geometry.max_offset
+  */
+typedef uint32_t offset_t;
+
+/**
+  * Used to hold the number of a process, which doubles as its address space identifier, in the
+  * range 0 to geometry.number_processes - 1
+  */
+typedef uint32_t process_t;
+
+/**
+  * Holds the components of a virtual address: the process it belongs to, the page number and the
+  * offset within the page. The tag is the page number with the process above it, which tells the
+  * pages of every process apart in the TLB and in the frame table; with a single process it is
+  * simply the page number
+  */
+typedef struct
+{
+	process_t process;
+	page_number_t page;
+	page_number_t tag;
+	offset_t offset;
+} virtual_components_t;
+
+/**
+  * Used to hold a physical address value, in the range 0 to number_frames * page_bytes - 1
+  */
+typedef uint64_t physical_address_t;
+
+/**
+  * Used to hold a frame number, from 0 to geometry.number_frames - 1
+  */
+typedef uint32_t frame_number_t;
+
+/**
+  * A single, individual value in a frame.
+  */
+typedef int8_t frameval_t;
+
+/**
+  * Holds the information on the TLB, including which pages are in it, which entries are free, and
+  * the replacement policies which decide which entry is to be replaced next. Pages are held by
+  * their tags, so that the translations of several processes can stay in the TLB across a context
+  * switch. The TLB is split into geometry.tlb_sets sets of geometry.tlb_ways entries, and a page
+  * may only be held in the set picked out by the low bits of its number; a fully associative TLB
+  * has a single set. The tags of each set are stored together, padded with INVALID_PAGE out to
+  * geometry.tlb_stride, and each set has its own free entries and its own replacement policy over
+  * its ways. An entry is numbered set * geometry.tlb_stride + way. Note that TLB does not need to
+  * contain dirty bit information because page table is always consulted for this. Pages which
+  * other cores evict are queued in shootdowns, under shootdown_lock, until the core that owns the
+  * TLB gets round to removing them; pending counts them, and is past TLB_SHOOTDOWNS once there
+  * were too many to queue
+  */
+typedef struct
+{
+	page_number_t *tags;
+	frame_number_t *frames;
+	int *free_entries;
+	int *free_count;
+	policy_t *policies;
+	pthread_mutex_t shootdown_lock;
+	page_number_t shootdowns[TLB_SHOOTDOWNS];
+	size_t pending;
+} tlb_t;
+
+/**
+  * The frame table data structure. Holds the actual physical memory and the replacement policies
+  * which decide which frame is to be used next upon a page fault. The contents of each frame are
+  * reached through contents, which points either at the frame's own part of table or, when the
+  * backing store is used without copying, straight at the page in the mapped backing store. The
+  * frames are split into partitions, the frames first_frame[p] up to first_frame[p + 1] - 1, each
+  * with its own replacement policy over its own frames: a single partition shared by every process
+  * under global replacement, one per process under local replacement, or, with several cores, a
+  * power of two shards picked out by the low bits of the page number, each with its own lock.
+  * page_for_frame holds the tag of the page in each frame, and tlbs are the TLBs of every core,
+  * which may all hold translations to these frames. When writes are simulated, write_back takes
+  * dirty pages back to the backing store and pages are read through it. When pages are read ahead,
+  * prefetch predicts which. When the backing store is read by I/O workers, pages are read through
+  * pipeline. When huge pages are mapped, huge counts the resident pages of each and decides which
+  * to promote; each page of a huge page is still held in a frame of its own. When the resident set
+  * of each process is managed, resident tracks it and the frames released from it wait in
+  * free_frames, which only a single partition ever has, to be filled before any other. When evicted
+  * pages are compressed, zswap keeps them and a fault looks there before the backing store. When
+  * pages are deduplicated, dedup lists the pages sharing each frame and finds frames by the hash of
+  * their contents, and the frame a page was read into before it was found to share another's
+  * waits in free_frames too
+  */
+typedef struct
+{
+	size_t partitions;
+	uint8_t sharded;
+	pthread_mutex_t *locks;
+	tlb_t *tlbs;
+	size_t number_tlbs;
+	write_back_t *write_back;
+	prefetch_t *prefetch;
+	pipeline_t *pipeline;
+	huge_pages_t *huge;
+	resident_set_t *resident;
+	zswap_t *zswap;
+	dedup_t *dedup;
+	frame_number_t *free_frames;
+	size_t number_free;
+	frame_number_t *first_frame;
+	frame_number_t *used_frames;
+	frameval_t *table;
+	frameval_t **contents;
+	page_number_t *page_for_frame;
+	policy_t *policies;
+} frame_table_t;
+
+/**
+  * The statistics of each process of the memory the thread is simulating, those of the manager it
+  * was last called on. Each core thread points statistics at its own
+  */
+static _Thread_local statistics_t *statistics;
+
+/**
+  * What the probes of the thread record, or NULL when instrumentation is off. The cores of
+  * --cores each record their own, which are added together once they have all finished
+  */
+static _Thread_local instrument_t *instrument;
+
+/**
+  * Holds the sizes of pages, frames, the address space and the TLB, decided at startup from the
+  * command line. Page sizes are restricted to powers of two so that splitting an address stays a
+  * shift and a mask. Note that frames are always the same size as pages. The references of several
+  * processes carry the number of their process above address_bits; process_mask picks it out and
+  * virtual_mask clears it again, and with a single process neither touches the address at all.
+  * page_table is the design of the page table, decided from the width of a tag when none is given.
+  * A huge page covers 2^huge_shift pages, and huge_shift is 0 when there are no huge pages. Each
+  * thread has a geometry of its own, that of the manager it was last called on, so that managers
+  * of different geometries can be used side by side
+  */
+typedef struct
+{
+	size_t page_bytes;
+	unsigned int offset_bits;
+	offset_t max_offset;
+	unsigned int address_bits;
+	unsigned int page_bits;
+	size_t number_pages;
+	page_number_t max_page_number;
+	size_t number_processes;
+	uint64_t process_mask;
+	uint64_t virtual_mask;
+	page_number_t tag_mask;
+	unsigned int tag_bits;
+	page_table_kind_t page_table;
+	unsigned int huge_shift;
+	size_t number_frames;
+	size_t tlb_entries;
+	size_t tlb_ways;
+	size_t tlb_sets;
+	size_t tlb_stride;
+} geometry_t;
+
+static _Thread_local geometry_t geometry;
+
+/**
+  * What memmgr_enter binds a thread to. The entry points which simulate memories of their own save
+  * it first and give it back when they are done, so that a manager the calling thread was using
+  * is left as it was
+  */
+typedef struct
+{
+	geometry_t geometry;
+	statistics_t *statistics;
+	instrument_t *instrument;
+} binding_t;
+
+/**
+  * A simulated core, which replays its own address file through its own TLB, sharing the frames
+  * and the page table with every other core, in the geometry of the thread which started it
+  */
+typedef struct
+{
+	pthread_t thread;
+	const geometry_t *geometry;
+	trace_file_t *file;
+	tlb_t *tlb;
+	frame_table_t *frames;
+	page_table_t *page_table;
+	backing_store_t *backing;
+	statistics_t statistics;
+	instrument_t *instrument;
+	status_t error;
+} core_t;
+
+/**
+  * A point of a parameter sweep: the geometry and the replacement policy it is simulated with,
+  * and once it has been, the totals of its statistics and the seconds of processor time it took
+  */
+typedef struct
+{
+	geometry_t geometry;
+	const char *policy;
+	statistics_t total;
+	double seconds;
+} sweep_point_t;
+
+/**
+  * A parameter sweep. The trace is read once and shared, read only, by every point, as is the
+  * next-use index of it which offline policies need, when any point has one. Each point is
+  * simulated on its own, through a manager of its own, starting from the same options
+  */
+typedef struct
+{
+	trace_t *trace;
+	uint32_t *next_use;
+	options_t *options;
+	backing_store_t *backing;
+	sweep_point_t *points;
+	size_t number_points;
+} sweep_t;
+
+/**
+  * What a manager has to share with the one which saved a snapshot to restore it: the geometry,
+  * the partitions of the frames and the replacement policies of the frames and of the TLB
+  */
+typedef struct
+{
+	uint64_t page_bytes;
+	uint64_t address_bits;
+	uint64_t number_processes;
+	uint64_t number_frames;
+	uint64_t partitions;
+	uint64_t tlb_entries;
+	uint64_t tlb_ways;
+	uint64_t page_table;
+	char policy[SNAPSHOT_NAME_BYTES];
+	char tlb_policy[SNAPSHOT_NAME_BYTES];
+} snapshot_header_t;
+
+/**
+  * A simulated memory, given references a batch at a time: its geometry, the statistics of each
+  * of its processes and what its probes record, which are made the thread's own at every call, and
+  * the frame table, page table and TLB, along with whatever the options add to them. Each line is
+  * printed to out. An offline policy is given next_use, the future of the trace, and position, the
+  * number of references translated since. running is the process referenced last, and a reference
+  * of any other is a context switch
+  */
+struct memmgr_t
+{
+	geometry_t geometry;
+	statistics_t *statistics;
+	instrument_t *instrument;
+	instrument_t recorded;
+	options_t *options;
+	backing_store_t *backing;
+	output_t *out;
+	frame_table_t frames;
+	page_table_t page_table;
+	tlb_t tlb;
+	prefetch_t prefetch;
+	huge_pages_t huge;
+	resident_set_t resident;
+	zswap_t zswap;
+	dedup_t dedup;
+	pipeline_t pipeline;
+	uint32_t *next_use;
+	size_t position;
+	process_t running;
+	size_t context_switches;
+};
+
+/**
+  * The writer of a manager opened without one, which prints nothing and so is never written to
+  */
+static output_t silent = { NULL, OUTPUT_NONE, NULL, 0, SUCCESS };
+
+//DRIVER FUNCTIONS---------------------------------------------------------------------------------
+	/**
+	  * Makes the geometry, statistics and instrumentation of a manager those of the calling thread,
+	  * which every call on the manager does first
+	  * @param manager the manager
+	  */
+	static void memmgr_enter(memmgr_t *manager);
+
+	/**
+	  * Saves what the calling thread is bound to
+	  * @param binding out param which will hold the binding
+	  */
+	static void binding_save(binding_t *binding);
+
+	/**
+	  * Binds the calling thread to what binding_save saved again
+	  * @param binding the binding
+	  */
+	static void binding_restore(binding_t *binding);
+
+	/**
+	  * Gives the offline policies of a manager the future of a trace, counting the references
+	  * translated from then on as its positions
+	  * @param manager  the manager
+	  * @param next_use the next-use index of the trace
+	  */
+	static void memmgr_use_future(memmgr_t *manager, const uint32_t *next_use);
+
+	/**
+	  * Finds whether the whole state of a manager can be saved in a snapshot, which it can unless
+	  * it simulates something kept outside the frame table, page table and TLB, or its policies
+	  * depend on the future of a particular trace
+	  * @param manager the manager
+	  * @return whether the manager can be saved and restored
+	  */
+	static uint8_t memmgr_snapshottable(memmgr_t *manager);
+
+	/**
+	  * Describes the geometry and policies of a manager, as the header of its snapshots
+	  * @param manager the manager
+	  * @param header  out param which will hold the description
+	  */
+	static void memmgr_describe(memmgr_t *manager, snapshot_header_t *header);
+
+	/**
+	  * Decodes the references of a batch from start up to end, or until the pipeline has no room
+	  * left, and issues the pages among them which are not resident now. Whether a page is
+	  * resident may change before its reference is simulated; the pipeline only decides when a
+	  * page is read, never which pages are evicted
+	  * @param addresses   the addresses of the batch being simulated
+	  * @param count       the number of references in the batch
+	  * @param start       the first reference to decode
+	  * @param end         one past the last reference to decode
+	  * @param frames      the frame table, whose pipeline the pages are issued to
+	  * @param page_table  the page table of every process
+	  * @return the first reference which has not been decoded
+	  */
+	static size_t issue_ahead(const uint64_t *addresses, size_t count, size_t start, size_t end, frame_table_t *frames, page_table_t *page_table);
+
+	/**
+	  * Simulates the cores of memmgr_run_cores, binding the calling thread to their geometry
+	  * @param schedule   the schedule holding the address file of every core
+	  * @param backing    the backing store
+	  * @param write_back where dirty pages are written back, or NULL when writes are not simulated
+	  * @param options    the options
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t simulate_cores(schedule_t *schedule, backing_store_t *backing, write_back_t *write_back, options_t *options);
+
+	/**
+	  * The thread of a single core, which replays its address file a batch at a time, holding the
+	  * lock of the page's shard for each reference
+	  * @param argument the core
+	  * @return NULL
+	  */
+	static void *run_core(void *argument);
+
+	/**
+	  * Simulates the points of memmgr_run_sweep, the calling thread taking some of them itself
+	  * @param schedule the schedule from which the memory addresses of every process will be read
+	  * @param backing  the backing store
+	  * @param options  the options
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t simulate_sweep(schedule_t *schedule, backing_store_t *backing, options_t *options);
+
+	/**
+	  * Simulates a single point of a sweep on the calling thread; run by the pool of memmgr_run_sweep
+	  * @param context the sweep
+	  * @param task    the number of the point
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t run_sweep_point(void *context, size_t task);
+
+	/**
+	  * For a single virtual address, this function will perform all necessary calculations and
+	  * retrieves to ultimately print out the value at the address
+	  * @param backing     the backing store
+	  * @param out         the writer to print the value to
+	  * @param address     the virtual address being accesses, with its process above address_bits
+	  * @param frames      the frame table
+	  * @param page_table  the page table of every process
+	  * @param tlb         the current tlb
+	  * @param is_write    whether the current memory access is a write or not
+	  * @param value       out param which will hold the value at the address
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t print_for_address(backing_store_t *backing, output_t *out, uint64_t address, frame_table_t *frames, page_table_t *page_table, tlb_t *tlb, uint8_t is_write, frameval_t *value);
+
+	/**
+	  * Prints the statistics of a process or of the whole run
+	  * @param summary    the file to print to
+	  * @param indent     printed at the start of every line
+	  * @param statistics the statistics to print
+	  */
+	static void print_statistics(FILE *summary, const char *indent, statistics_t *statistics);
+
+	/**
+	  * Prints how many pages were read ahead and what became of them
+	  * @param summary    the file to print to
+	  * @param indent     printed at the start of every line
+	  * @param statistics the statistics to print
+	  */
+	static void print_prefetch_statistics(FILE *summary, const char *indent, statistics_t *statistics);
+
+	/**
+	  * Prints how many times the page table was walked and how many of its entries each walk read
+	  * @param summary    the file to print to
+	  * @param indent     printed at the start of every line
+	  * @param statistics the statistics to print
+	  */
+	static void print_page_table_statistics(FILE *summary, const char *indent, statistics_t *statistics);
+
+	/**
+	  * Prints how many huge pages were promoted and split up again, the TLB hits they gave and the
+	  * pages read in to complete them which were never referenced
+	  * @param summary    the file to print to
+	  * @param indent     printed at the start of every line
+	  * @param statistics the statistics to print
+	  */
+	static void print_huge_page_statistics(FILE *summary, const char *indent, statistics_t *statistics);
+
+	/**
+	  * Prints the frames a resident set held on average and at most, its space-time product and how
+	  * many frames were released from it
+	  * @param summary  the file to print to
+	  * @param indent   printed at the start of every line
+	  * @param resident the resident set of a process or of the whole run
+	  */
+	static void print_resident_statistics(FILE *summary, const char *indent, resident_process_t *resident);
+
+	/**
+	  * Prints what the pool of compressed pages stored, refused, served and pushed out, how well the
+	  * pages compressed, and the time spent compressing and decompressing them
+	  * @param summary the file to print to
+	  * @param zswap   the pool
+	  */
+	static void print_zswap_statistics(FILE *summary, zswap_t *zswap);
+
+	/**
+	  * Prints how many frames sharing pages saved, now and at most, how many pages were merged into
+	  * a frame and copied out of one again, and the time spent hashing each page read in
+	  * @param summary the file to print to
+	  * @param dedup   the deduplication
+	  */
+	static void print_dedup_statistics(FILE *summary, dedup_t *dedup);
+
+	/**
+	  * Adds the statistics of a process or a core into a total
+	  * @param total      the total to add to
+	  * @param statistics the statistics to add
+	  */
+	static void add_statistics(statistics_t *total, statistics_t *statistics);
+
+	/**
+	  * Writes what the probes recorded to a file as JSON
+	  * @param recorded the instrumentation to write
+	  * @param path     the path of the file
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t write_instrumentation(instrument_t *recorded, const char *path);
+//END DRIVER FUNCTIONS------------------------------------------------------------------------------
+
+//GEOMETRY FUNCTIONS--------------------------------------------------------------------------------
+	/**
+	  * Derives the memory geometry from the command line options, checking that the sizes are
+	  * consistent with each other
+	  * @param geometry the geometry to fill in
+	  * @param options  the parsed command line options
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t geometry_initialize(geometry_t *geometry, options_t *options);
+//END GEOMETRY FUNCTIONS----------------------------------------------------------------------------
+
+//OPTION CHECK FUNCTIONS----------------------------------------------------------------------------
+	/**
+	  * Returns whether the options ask for an offline page replacement or TLB policy
+	  * @param options the options
+	  * @return whether either policy is offline
+	  */
+	static uint8_t offline_policies(options_t *options);
+
+	/**
+	  * Returns whether the options ask for a sweep over frames, TLB entries or policies
+	  * @param options the options
+	  * @return whether a sweep is asked for
+	  */
+	static uint8_t sweeping(options_t *options);
+
+	/**
+	  * A trace reported on as it streams in is never stored whole, as an offline policy needs it to
+	  * be, and the cores, the miss-ratio curve and the points of a sweep report only once they are
+	  * done
+	  * @param options the options
+	  * @return whether reporting windows can be used with the rest of the options
+	  */
+	static uint8_t check_windows(options_t *options);
+
+	/**
+	  * The points of a sweep would all write back to the one copy of the backing store and record
+	  * into the one instrumentation, and each simulates a single core with no pipeline of its own
+	  * @param options the options
+	  * @return whether a sweep can be used with the rest of the options
+	  */
+	static uint8_t check_sweep(options_t *options);
+
+	/**
+	  * The miss-ratio curve is of a single address stream
+	  * @param options the options
+	  * @return whether the miss-ratio curve can be used with the rest of the options
+	  */
+	static uint8_t check_mrc(options_t *options);
+
+	/**
+	  * The cores share neither a schedule to partition the frames by nor a single future for an
+	  * offline policy, and the miss-ratio curve simulates no cores
+	  * @param options the options
+	  * @return whether the cores can be used with the rest of the options
+	  */
+	static uint8_t check_cores(options_t *options);
+
+	/**
+	  * The processes of several address files would all write their page p back to page p of the
+	  * one copy of the backing store, and read it from there, so that a write of one process would
+	  * show through in the page of another once it was evicted. The cores share one address space
+	  * @param options the options
+	  * @return whether write-back can be used with the rest of the options
+	  */
+	static uint8_t check_write_back(options_t *options);
+
+	/**
+	  * Pages read ahead are not in the future an offline policy is given, and would belong to shards
+	  * a core has not locked
+	  * @param options the options
+	  * @return whether prefetching can be used with the rest of the options
+	  */
+	static uint8_t check_prefetch(options_t *options);
+
+	/**
+	  * The pages of a huge page span every shard, and those read in to complete one are not in the
+	  * future an offline policy is given
+	  * @param options the options
+	  * @return whether huge pages can be used with the rest of the options
+	  */
+	static uint8_t check_huge_pages(options_t *options);
+
+	/**
+	  * A page read early by an I/O worker could miss a write-back made after it was read, and the
+	  * cores have no pipeline of their own
+	  * @param options the options
+	  * @return whether I/O workers can be used with the rest of the options
+	  */
+	static uint8_t check_io_workers(options_t *options);
+
+	/**
+	  * The miss-ratio curve simulates nothing to instrument, and without INSTRUMENT there are no
+	  * probes
+	  * @param options the options
+	  * @return whether instrumentation can be used with the rest of the options
+	  */
+	static uint8_t check_instrument(options_t *options);
+
+	/**
+	  * Resident sets are of every frame of a single memory, and a frame released goes back to the
+	  * one free list, free to any process
+	  * @param options the options
+	  * @return whether resident sets can be used with the rest of the options
+	  */
+	static uint8_t check_resident(options_t *options);
+
+	/**
+	  * The pool of compressed pages is not shared between cores, and a page found in it leaves a
+	  * read issued by an I/O worker unclaimed
+	  * @param options the options
+	  * @return whether compressed swap can be used with the rest of the options
+	  */
+	static uint8_t check_zswap(options_t *options);
+
+	/**
+	  * A snapshot holds the frame table, page table and TLB of a single memory, and none of the
+	  * state of writes, prefetching, huge pages, resident sets or compressed swap, nor the future of
+	  * a trace
+	  * @param options the options
+	  * @return whether snapshots can be used with the rest of the options
+	  */
+	static uint8_t check_snapshot(options_t *options);
+
+	/**
+	  * Pages sharing a frame must all leave it together, so deduplication keeps to a single
+	  * partition of a single memory, whose frames hold no pages read ahead, completing a huge page,
+	  * in a resident set, decompressed or read by an I/O worker, and which maps a page table entry
+	  * per page rather than per frame. Every page in a frame needs the same future, a snapshot
+	  * would not hold which pages share, and a sweep would not report what it saved
+	  * @param options the options
+	  * @return whether deduplication can be used with the rest of the options
+	  */
+	static uint8_t check_dedup(options_t *options);
+//END OPTION CHECK FUNCTIONS------------------------------------------------------------------------
+
+//VIRTUAL ADDRESS FUNCTIONS-------------------------------------------------------------------------
+	/**
+	  * Pulls out the components, the process, the page and the offset, of the virtual address
+	  * @param address the virtual address of which to get the components
+	  * @return a structure containing the components of the address
+	  */
+	static virtual_components_t get_components(uint64_t address);
+
+	/**
+	  * Pulls out the process of the virtual address
+	  * @param address the virtual address of which to get the process
+	  * @return the process of the address
+	  */
+	static process_t get_process(uint64_t address);
+
+	/**
+	  * Pulls out the offset of the virtual address
+	  * @param address the virtual address of which to get the offset
+	  * @return the offset of the address
+	  */
+	static offset_t get_offset(uint64_t address);
+
+	/**
+	  * Pulls out the page number of the virtual address
+	  * @param address the virtual address of which to get the page number
+	  * @return the page number of the address
+	  */
+	static page_number_t get_page(uint64_t address);
+//END VIRTUAL ADDRESS FUNCTIONS---------------------------------------------------------------------
+
+//FRAME TABLE FUNCTIONS-----------------------------------------------------------------------------
+	/**
+	  * Initializes a frame table data structure after it has been declared
+	  * @param frames     the frame table to initialize
+	  * @param policy     the name of the replacement policy to use
+	  * @param partitions the number of partitions to split the frames into, each replaced
+	  *                   separately
+	  * @param sharded    whether the partitions are shards shared by several cores, which must be
+	  *                   a power of two
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_initialize(frame_table_t *frames, const char *policy, size_t partitions, uint8_t sharded);
+
+	/**
+	  * Uninitializes a frame table data structure after it is no longer needed.
+	  * @param frames the frame table to uninitialize
+	  */
+	static void frame_table_uninitialize(frame_table_t *frames);
+
+	/**
+	  * Finds the partition which a page is placed in
+	  * @param frames the frame table
+	  * @param tag    the tag of the page
+	  * @return the partition
+	  */
+	static size_t frame_table_partition(frame_table_t *frames, page_number_t tag);
+
+	/**
+	  * Records a reference to a frame with the replacement policy of its partition
+	  * @param frames   the frame table
+	  * @param frame    the frame which was referenced
+	  * @param is_write whether the current memory access is a write or not
+	  */
+	static void frame_table_hit(frame_table_t *frames, frame_number_t frame, uint8_t is_write);
+
+	/**
+	  * If the page given by the components is not already loaded into a frame, this function will
+	  * load it into a frame from the backing store, updating the page table and the TLB as
+	  * necessary; if the page is already loaded, this function only records the reference with the
+	  * replacement policy. Every process reads its pages from the same backing store, as if each
+	  * had mapped the same file
+	  * @param page_table  the page table of every process
+	  * @param components  the components of the address whose page needs to be loaded
+	  * @param ftable      the current frame table
+	  * @param tlb         the current tlb, from which the page of an evicted frame is removed
+	  * @param backing     the backing store holding all memory information
+	  * @param is_write    whether the current memory access is a write or not
+	  * @param frame       out param which will hold the frame the page is in
+	  * @param observed    out param which is set when the reference either faulted or was the first
+	  *                    to a page which was read ahead, the references the prefetcher watches
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t load_if_necessary(page_table_t *page_table, virtual_components_t *components, frame_table_t *ftable, tlb_t *tlb, backing_store_t *backing, uint8_t is_write, frame_number_t *frame, uint8_t *observed);
+
+	/**
+	  * Loads a page which is not in any frame from the backing store, into a free frame of its
+	  * partition or else into the frame of a victim chosen by the partition's replacement policy,
+	  * and updates the page tables and the TLBs
+	  * @param page_table  the page table of every process
+	  * @param components  the components of an address in the page to load
+	  * @param frames      the current frame table
+	  * @param tlb         the current tlb, from which the page of an evicted frame is removed
+	  * @param backing     the backing store holding all memory information
+	  * @param is_write    whether the current memory access is a write or not
+	  * @param prefetched  whether the page is being read ahead rather than referenced, in which case
+	  *                    it is inserted as the partition's next victim
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_load(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, backing_store_t *backing, uint8_t is_write, uint8_t prefetched);
+
+	/**
+	  * Finds a frame for a page about to be brought in: a free frame of its partition if there is
+	  * one, or else the frame of a victim chosen by the partition's replacement policy, which is
+	  * evicted
+	  * @param page_table  the page table of every process
+	  * @param components  the components of an address in the page to bring in
+	  * @param frames      the current frame table
+	  * @param tlb         the current tlb, from which the page of an evicted frame is removed
+	  * @param frame       out param which will hold the frame
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_allocate(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, frame_number_t *frame);
+
+	/**
+	  * Gives a page which shares its frame with others a frame of its own, with a copy of the
+	  * contents, before it is written, and updates the page table and the TLB
+	  * @param page_table  the page table of every process
+	  * @param components  the components of the address being written
+	  * @param frames      the current frame table
+	  * @param tlb         the current tlb
+	  * @param frame       the frame the page shares, which will hold the frame of its copy
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_copy_on_write(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, frame_number_t *frame);
+
+	/**
+	  * Empties a frame, unmapping its page, and any others sharing it, and removing it from every
+	  * TLB, and writing it back if it is dirty. The replacement policy is left to the caller
+	  * @param page_table  the page table of every process
+	  * @param frames      the current frame table
+	  * @param tlb         the current tlb; the TLBs of other cores are sent shootdowns
+	  * @param frame       the frame to empty
+	  * @param process     the process the shootdowns are charged to
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_evict(page_table_t *page_table, frame_table_t *frames, tlb_t *tlb, frame_number_t frame, process_t process);
+
+	/**
+	  * Records a reference in the resident set of its process, and releases the frames of the pages
+	  * which have left it, so that they are filled before any page is evicted
+	  * @param page_table  the page table of every process
+	  * @param components  the components of the address which was referenced
+	  * @param frames      the current frame table
+	  * @param tlb         the current tlb
+	  * @param frame       the frame which was referenced
+	  * @param faulted     whether the reference faulted
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_resize(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, frame_number_t frame, uint8_t faulted);
+
+	/**
+	  * Reads ahead the pages which the prefetcher predicts will follow a reference, skipping those
+	  * already in a frame
+	  * @param page_table  the page table of every process
+	  * @param components  the components of the address which was referenced
+	  * @param frames      the current frame table
+	  * @param tlb         the current tlb
+	  * @param backing     the backing store holding all memory information
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_prefetch(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, backing_store_t *backing);
+
+	/**
+	  * Promotes the huge page holding a page if enough of its pages are resident, reading in the
+	  * rest of them and replacing their translations in the TLBs. The huge page is left as base
+	  * pages if reading in the rest evicts any of its pages
+	  * @param page_table  the page table of every process
+	  * @param components  the components of the address which was referenced
+	  * @param frames      the current frame table
+	  * @param tlb         the current tlb
+	  * @param backing     the backing store holding all memory information
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_promote(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, backing_store_t *backing);
+
+	/**
+	  * Counts the pages still in a frame which were read in to complete a huge page and have not been
+	  * referenced, as wasted
+	  * @param frames      the frame table
+	  * @param page_table  the page table of every process
+	  * @param counted     the statistics to count them in, of each process or of them all
+	  * @param by_process  whether counted holds the statistics of each process, rather than one total
+	  */
+	static void frame_table_count_unreferenced(frame_table_t *frames, page_table_t *page_table, statistics_t *counted, uint8_t by_process);
+
+	/**
+	  * Writes the frame table to a snapshot: the frames in use in each partition, with the page in
+	  * each and its contents, the entries of those pages in the page table, and the policy of each
+	  * partition
+	  * @param frames     the frame table
+	  * @param page_table the page table of every process
+	  * @param writer     the snapshot being written
+	  * @return an indication of whether an error occurred; any error writing is left in the writer
+	  */
+	static status_t frame_table_save(frame_table_t *frames, page_table_t *page_table, snapshot_writer_t *writer);
+
+	/**
+	  * Fills an empty frame table, and its page table, with those read from a snapshot. As on a
+	  * fault, a frame refers to its page in the backing store in place when the backing store is
+	  * mapped and writes are not simulated, and otherwise is given the contents saved. Each frame in
+	  * use must hold a page of one of the processes, mapped to that frame and to no other
+	  * @param frames     the frame table
+	  * @param page_table the page table of every process
+	  * @param backing    the backing store
+	  * @param reader     the snapshot being read
+	  * @return FORM_ERROR if the frames read could not have been saved, or otherwise an indication
+	  * of whether an error occurred
+	  */
+	static status_t frame_table_restore(frame_table_t *frames, page_table_t *page_table, backing_store_t *backing, snapshot_reader_t *reader);
+
+	/**
+	  * Writes back every dirty page still in a frame or in the pool of compressed pages, so that the
+	  * backing store ends up holding every write. These are not counted as write-backs
+	  * @param frames      the frame table
+	  * @param page_table  the page table of every process
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_flush(frame_table_t *frames, page_table_t *page_table);
+
+	/**
+	  * Counts a dirty page leaving memory as a write-back, charged to the process which owned it, and
+	  * writes it to the backing store if writes are simulated
+	  * @param frames   the frame table
+	  * @param tag      the tag of the page
+	  * @param contents the contents of the page
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t frame_table_write_back(frame_table_t *frames, page_number_t tag, const frameval_t *contents);
+
+	/**
+	  * Writes back a dirty page pushed out of the pool of compressed pages, as a write-back of the
+	  * process which owned it; passed to zswap_store
+	  * @param context  the frame table
+	  * @param tag      the tag of the page
+	  * @param contents the contents of the page
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t write_back_swapped(void *context, uint64_t tag, const int8_t *contents);
+
+	/**
+	  * Writes back a dirty page still in the pool of compressed pages at the end of the run, which is
+	  * not counted as a write-back; passed to zswap_flush
+	  * @param context  the frame table
+	  * @param tag      the tag of the page
+	  * @param contents the contents of the page
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t flush_swapped(void *context, uint64_t tag, const int8_t *contents);
+
+	/**
+	  * Gets the value from the frame table at the particular address
+	  * @param frames    the frame table
+	  * @param phys_addr the physical address from which the value is being retrieved
+	  * @return the value at the given physical address
+	  */
+	static frameval_t get_value_at_address(frame_table_t *frames, physical_address_t phys_addr);
+
+	/**
+	  * Stores a value into the frame table at the particular address
+	  * @param frames    the frame table
+	  * @param phys_addr the physical address at which the value is stored
+	  * @param value     the value to store
+	  */
+	static void set_value_at_address(frame_table_t *frames, physical_address_t phys_addr, frameval_t value);
+//END FRAME TABLE FUNCTIONS------------------------------------------------------------------------
+
+//TLB FUNCTIONS------------------------------------------------------------------------------------
+	/**
+	  * Initializes a TLB data structure after it has been declared
+	  * @param tlb    the TLB to be initialized
+	  * @param policy the name of the replacement policy to use in each set, or NULL for the
+	  *               default
+	  * @return an indication of whether an error occurred
+	  */
+	static status_t tlb_initialize(tlb_t *tlb, const char *policy);
+
+	/**
+	  * Uninitializes a TLB data structure after it is no longer needed
+	  * @param tlb the TLB to be uninitialized
+	  */
+	static void tlb_uninitialize(tlb_t *tlb);
+
+	/**
+	  * Finds the entry holding the given page in its set of the TLB, comparing the tags of the set
+	  * a vector register at a time
+	  * @param tlb the tlb to be searched
+	  * @param tag the tag of the page
+	  * @return the number of the entry holding the page, or TLB_MISS if it is not in the TLB
+	  */
+	static int tlb_find(tlb_t *tlb, page_number_t tag);
+
+	/**
+	  * Tries to get the frame for the given page from the given TLB. Places the frame in frame and
+	  * returns the index in the TLB of the discovered entry, upon success. Upon failure, returns
+	  * TLB_MISS
+	  * @param tlb   the tlb to be searched
+	  * @param tag   the tag of the page for which the frame is to be found
+	  * @param frame out param which will hold the frame number for the page upon success
+	  * @return if the frame is successfully found, returns the index in the tlb of the tlb entry;
+	  * otherwise, returns TLB_MISS
+	  */
+	static int get_frame_from_tlb(tlb_t *tlb, page_number_t tag, frame_number_t *frame);
+
+	/**
+	  * Tries to get the frame for the given page from the TLB entry of its huge page. The pages of a
+	  * huge page each still have a frame of their own, so the entry only gives the reach of the huge
+	  * page, and the frame is then looked up in the page table without counting a walk
+	  * @param tlb        the tlb to be searched
+	  * @param page_table the page table of every process
+	  * @param components the components of the address
+	  * @param frame      out param which will hold the frame number for the page upon success
+	  * @return if the huge page is found, returns the index in the tlb of its entry; otherwise,
+	  * returns TLB_MISS
+	  */
+	static int get_frame_from_huge_tlb(tlb_t *tlb, page_table_t *page_table, virtual_components_t *components, frame_number_t *frame);
+
+	/**
+	  * Records a reference to a TLB entry with the replacement policy of its set
+	  * @param tlb      the tlb
+	  * @param entry    the entry which was referenced
+	  * @param is_write whether the current memory access is a write or not
+	  */
+	static void tlb_hit(tlb_t *tlb, int entry, uint8_t is_write);
+
+	/**
+	  * Places the translation of a page into its set of the TLB, in a free entry if there is one
+	  * and otherwise in the entry chosen by the set's replacement policy
+	  * @param tlb      the tlb to update
+	  * @param tag      the tag of the page
+	  * @param frame    the frame holding the page
+	  * @param is_write whether the current memory access is a write or not
+	  */
+	static void tlb_insert(tlb_t *tlb, page_number_t tag, frame_number_t frame, uint8_t is_write);
+
+	/**
+	  * Removes the translation of a page from the TLB, if it is there, freeing its entry
+	  * @param tlb the tlb to update
+	  * @param tag the tag of the page
+	  */
+	static void tlb_invalidate(tlb_t *tlb, page_number_t tag);
+
+	/**
+	  * Removes every translation from the TLB, as an untagged TLB must on a context switch
+	  * @param tlb the tlb to flush
+	  */
+	static void tlb_flush(tlb_t *tlb);
+
+	/**
+	  * Asks the core that owns a TLB to remove the translation of a page, which another core has
+	  * just evicted. May be called from any thread
+	  * @param tlb the tlb to update
+	  * @param tag the tag of the page
+	  */
+	static void tlb_shootdown(tlb_t *tlb, page_number_t tag);
+
+	/**
+	  * Removes every translation which other cores have shot down since the last call. Called
+	  * only by the core that owns the TLB
+	  * @param tlb the tlb to update
+	  */
+	static void tlb_drain(tlb_t *tlb);
+
+	/**
+	  * Finds how much memory the translations now in the TLB cover
+	  * @param tlb          the tlb
+	  * @param huge_entries out param which will hold the number of entries which are of huge pages
+	  * @return the number of bytes covered
+	  */
+	static size_t tlb_reach(tlb_t *tlb, size_t *huge_entries);
+
+	/**
+	  * Writes the entries of a TLB, its free entries and the policy of each set to a snapshot
+	  * @param tlb    the tlb
+	  * @param writer the snapshot being written
+	  * @return an indication of whether an error occurred; any error writing is left in the writer
+	  */
+	static status_t tlb_save(tlb_t *tlb, snapshot_writer_t *writer);
+
+	/**
+	  * Replaces the entries of a TLB, its free entries and the policy of each set with those read
+	  * from a snapshot. Each entry in use must be in the set of its page and hold the frame the page
+	  * table maps that page to, and the free entries must be exactly the rest
+	  * @param tlb        the tlb
+	  * @param page_table the page table of every process, already restored
+	  * @param reader     the snapshot being read
+	  * @return FORM_ERROR if the entries read could not have been saved, or otherwise an indication
+	  * of whether an error occurred
+	  */
+	static status_t tlb_restore(tlb_t *tlb, page_table_t *page_table, snapshot_reader_t *reader);
+//END TLB FUNCTIONS--------------------------------------------------------------------------------
+
+//PHYSICAL ADDRESS FUNCTIONS-----------------------------------------------------------------------
+	/**
+	  * Given a frame number and an offset, returns the corresponding physical address
+	  * @param frame  the frame number
+	  * @param offset the offset from the beginning of the frame
+	  * @return the physical address corresponding to the frame and the offset
+	  */
+	static physical_address_t get_physical_address(frame_number_t frame, offset_t offset);
+//PHYSICAL ADDRESS FUNCTIONS-----------------------------------------------------------------------
+
+status_t memmgr_check(options_t *options)
+{
+	geometry_t checked;
+	status_t error;
+	if ((error = geometry_initialize(&checked, options)) != SUCCESS)
+	{
+		return error;
+	}
+
+	if (!check_windows(options) || !check_sweep(options) || !check_mrc(options) || !check_cores(options) ||
+		!check_write_back(options) || !check_prefetch(options) || !check_huge_pages(options) || !check_io_workers(options) ||
+		!check_instrument(options) || !check_resident(options) || !check_zswap(options) || !check_snapshot(options) ||
+		!check_dedup(options))
+	{
+		return OPTN_ERROR;
+	}
+	return SUCCESS;
+}
+
+status_t memmgr_open(memmgr_t **manager, options_t *options, backing_store_t *backing, write_back_t *write_back, output_t *out)
+{
+	status_t error;
+	if ((error = memmgr_check(options)) != SUCCESS)
+	{
+		return error;
+	}
+
+	memmgr_t *m;
+	if ((m = calloc(1, sizeof *m)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	//every failure unwinds through memmgr_close, which skips whatever was never initialized
+	if ((error = geometry_initialize(&m->geometry, options)) != SUCCESS)
+	{
+		memmgr_close(m);
+		return error;
+	}
+	if ((m->statistics = calloc(m->geometry.number_processes, sizeof *m->statistics)) == NULL)
+	{
+		memmgr_close(m);
+		return ALOC_ERROR;
+	}
+	m->options = options;
+	m->backing = backing;
+	m->out = out != NULL ? out : &silent;
+	memmgr_enter(m);
+
+	frame_table_t *frames = &m->frames;
+	if ((error = frame_table_initialize(frames, options->policy, options->local_frames ? geometry.number_processes : 1, 0)) != SUCCESS)
+	{
+		memmgr_close(m);
+		return error;
+	}
+
+	//the pages of every process share one page table, told apart by their tags
+	if ((error = page_table_initialize(&m->page_table, geometry.page_table, geometry.tag_bits, geometry.number_frames, 0)) != SUCCESS)
+	{
+		memmgr_close(m);
+		return error;
+	}
+
+	//each process is a stream of its own to the prefetcher
+	if ((error = prefetch_initialize(&m->prefetch, geometry.number_processes, options->prefetch_degree)) != SUCCESS ||
+		(error = tlb_initialize(&m->tlb, options->tlb_policy)) != SUCCESS)
+	{
+		memmgr_close(m);
+		return error;
+	}
+	frames->tlbs = &m->tlb;
+	frames->number_tlbs = 1;
+	frames->write_back = write_back;
+	frames->prefetch = options->prefetch_degree > 0 ? &m->prefetch : NULL;
+
+	//a huge page is promoted once half its pages are resident unless told otherwise
+	if (geometry.huge_shift > 0)
+	{
+		size_t threshold = options->huge_threshold == 0 ? ((size_t) 1 << geometry.huge_shift) / 2 : options->huge_threshold;
+		if ((error = huge_pages_initialize(&m->huge, geometry.huge_shift, threshold)) != SUCCESS)
+		{
+			memmgr_close(m);
+			return error;
+		}
+		frames->huge = &m->huge;
+	}
+
+	if (options->resident_policy != RESIDENT_OFF)
+	{
+		if ((error = resident_set_initialize(&m->resident, options->resident_policy, options->resident_window, geometry.number_frames, geometry.number_processes)) != SUCCESS)
+		{
+			memmgr_close(m);
+			return error;
+		}
+		frames->resident = &m->resident;
+	}
+
+	if (options->zswap_bytes > 0)
+	{
+		if ((error = zswap_initialize(&m->zswap, codec_find(options->codec), options->zswap_bytes, geometry.page_bytes)) != SUCCESS)
+		{
+			memmgr_close(m);
+			return error;
+		}
+		frames->zswap = &m->zswap;
+	}
+
+	if (options->dedup)
+	{
+		if ((error = dedup_initialize(&m->dedup, geometry.number_frames, geometry.page_bytes)) != SUCCESS)
+		{
+			memmgr_close(m);
+			return error;
+		}
+		frames->dedup = &m->dedup;
+	}
+
+	//a zero-copy frame points into the backing store and is never read into, so has nothing to
+	//overlap
+	if (options->io_workers > 0 && backing->mode != BACKING_ZERO_COPY)
+	{
+		if ((error = pipeline_initialize(&m->pipeline, backing, options->io_workers)) != SUCCESS)
+		{
+			memmgr_close(m);
+			return error;
+		}
+		frames->pipeline = &m->pipeline;
+	}
+
+	//the pages written back by the final flush are timed too
+	if (options->instrument_file != NULL)
+	{
+		if ((error = instrument_initialize(&m->recorded)) != SUCCESS)
+		{
+			memmgr_close(m);
+			return error;
+		}
+		m->instrument = &m->recorded;
+	}
+
+	*manager = m;
+	return SUCCESS;
+}
+
+void memmgr_close(memmgr_t *manager)
+{
+	memmgr_enter(manager);
+	frame_table_t *frames = &manager->frames;
+	if (frames->pipeline != NULL)
+	{
+		pipeline_uninitialize(&manager->pipeline);
+	}
+	if (frames->dedup != NULL)
+	{
+		dedup_uninitialize(&manager->dedup);
+	}
+	if (frames->zswap != NULL)
+	{
+		zswap_uninitialize(&manager->zswap);
+	}
+	if (frames->resident != NULL)
+	{
+		resident_set_uninitialize(&manager->resident);
+	}
+	if (frames->huge != NULL)
+	{
+		huge_pages_uninitialize(&manager->huge);
+	}
+	if (manager->instrument != NULL)
+	{
+		instrument_uninitialize(manager->instrument);
+	}
+	tlb_uninitialize(&manager->tlb);
+	prefetch_uninitialize(&manager->prefetch);
+	page_table_uninitialize(&manager->page_table);
+	frame_table_uninitialize(frames);
+	free(manager->next_use);
+	free(manager->statistics);
+	free(manager);
+
+	//the thread is left with nothing of the manager to reach by mistake
+	statistics = NULL;
+	instrument = NULL;
+}
+
+status_t memmgr_flush(memmgr_t *manager)
+{
+	memmgr_enter(manager);
+	status_t error;
+	if (manager->frames.write_back != NULL && (error = frame_table_flush(&manager->frames, &manager->page_table)) != SUCCESS)
+	{
+		return error;
+	}
+	if (manager->instrument != NULL)
+	{
+		return write_instrumentation(manager->instrument, manager->options->instrument_file);
+	}
+	return SUCCESS;
+}
+
+uint8_t memmgr_offline(memmgr_t *manager)
+{
+	return manager->frames.policies[0].ops->offline || manager->tlb.policies[0].ops->offline;
+}
+
+status_t memmgr_set_future(memmgr_t *manager, trace_t *trace)
+{
+	memmgr_enter(manager);
+	free(manager->next_use);
+	manager->next_use = NULL;
+
+	status_t error;
+	if ((error = trace_next_use(trace, geometry.offset_bits, geometry.tag_mask, &manager->next_use)) != SUCCESS)
+	{
+		return error;
+	}
+	memmgr_use_future(manager, manager->next_use);
+	return SUCCESS;
+}
+
+status_t memmgr_translate_batch(memmgr_t *manager, const uint64_t *addresses, const uint8_t *writes, size_t count, int8_t *values)
+{
+	memmgr_enter(manager);
+	frame_table_t *frames = &manager->frames;
+	status_t error;
+	frameval_t value;
+	size_t ahead = 0;
+	size_t position;
+	for (position = 0; position < count; position++)
+	{
+		if (frames->pipeline != NULL)
+		{
+			ahead = issue_ahead(addresses, count, ahead > position ? ahead : position, position + PIPELINE_LOOKAHEAD, frames, &manager->page_table);
+		}
+
+		//a tagged TLB keeps the translations of every process across a context switch, while an
+		//untagged one has to be flushed
+		if (geometry.number_processes > 1 && get_process(addresses[position]) != manager->running)
+		{
+			manager->running = get_process(addresses[position]);
+			manager->context_switches++;
+			if (manager->options->tlb_flush)
+			{
+				tlb_flush(&manager->tlb);
+			}
+		}
+
+		if ((error = print_for_address(manager->backing, manager->out, addresses[position], frames, &manager->page_table, &manager->tlb,
+			writes != NULL && writes[position], values != NULL ? &values[position] : &value)) != SUCCESS)
+		{
+			return error;
+		}
+		manager->position++;
+	}
+
+	return SUCCESS;
+}
+
+void memmgr_statistics(memmgr_t *manager, statistics_t *total)
+{
+	memmgr_enter(manager);
+	memset(total, 0, sizeof *total);
+	size_t process;
+	for (process = 0; process < geometry.number_processes; process++)
+	{
+		add_statistics(total, &statistics[process]);
+	}
+	if (manager->frames.huge != NULL)
+	{
+		frame_table_count_unreferenced(&manager->frames, &manager->page_table, total, 0);
+	}
+}
+
+status_t memmgr_print_statistics(memmgr_t *manager, FILE *summary)
+{
+	memmgr_enter(manager);
+	frame_table_t *frames = &manager->frames;
+	options_t *options = manager->options;
+
+	//the pages never referenced are counted into a copy, so that printing again counts them once
+	statistics_t *counted;
+	if ((counted = malloc(geometry.number_processes * sizeof *counted)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	memcpy(counted, statistics, geometry.number_processes * sizeof *counted);
+	if (frames->huge != NULL)
+	{
+		frame_table_count_unreferenced(frames, &manager->page_table, counted, 1);
+	}
+
+	size_t process;
+	statistics_t total = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+	for (process = 0; process < geometry.number_processes; process++)
+	{
+		add_statistics(&total, &counted[process]);
+	}
+
+	print_statistics(summary, "", &total);
+	if (frames->prefetch != NULL)
+	{
+		print_prefetch_statistics(summary, "", &total);
+	}
+	if (options->page_table != PAGE_TABLE_AUTO)
+	{
+		print_page_table_statistics(summary, "", &total);
+		fprintf(summary, "Page Table Footprint = %zu bytes\n", manager->page_table.footprint);
+	}
+	if (frames->huge != NULL)
+	{
+		size_t huge_entries;
+		size_t reach = tlb_reach(&manager->tlb, &huge_entries);
+		print_huge_page_statistics(summary, "", &total);
+		fprintf(summary, "TLB Reach = %zu bytes (huge entries = %zu)\n", reach, huge_entries);
+	}
+	if (frames->resident != NULL)
+	{
+		//the whole run is a resident set of its own, of every frame in use
+		resident_set_t *rs = frames->resident;
+		resident_process_t run = { rs->time, 0, rs->in_use, rs->peak, 0, rs->space_time };
+		for (process = 0; process < geometry.number_processes; process++)
+		{
+			run.released += rs->processes[process].released;
+		}
+		print_resident_statistics(summary, "", &run);
+		fprintf(summary, "Frames in Use over Time (every %" PRIu64 " references) =", rs->interval);
+		size_t sample;
+		for (sample = 0; sample < rs->number_samples; sample++)
+		{
+			fprintf(summary, " %zu", rs->samples[sample]);
+		}
+		fprintf(summary, "\n");
+	}
+	if (frames->zswap != NULL)
+	{
+		print_zswap_statistics(summary, frames->zswap);
+	}
+	if (frames->dedup != NULL)
+	{
+		print_dedup_statistics(summary, frames->dedup);
+	}
+	if (geometry.number_processes > 1)
+	{
+		fprintf(summary, "Context Switches = %zu\n", manager->context_switches);
+		for (process = 0; process < geometry.number_processes; process++)
+		{
+			fprintf(summary, "Process %zu (%s):\n", process, options->input_files[process]);
+			print_statistics(summary, "  ", &counted[process]);
+			if (frames->prefetch != NULL)
+			{
+				print_prefetch_statistics(summary, "  ", &counted[process]);
+			}
+			if (options->page_table != PAGE_TABLE_AUTO)
+			{
+				print_page_table_statistics(summary, "  ", &counted[process]);
+			}
+			if (frames->huge != NULL)
+			{
+				print_huge_page_statistics(summary, "  ", &counted[process]);
+			}
+			if (frames->resident != NULL)
+			{
+				print_resident_statistics(summary, "  ", &frames->resident->processes[process]);
+			}
+		}
+	}
+
+	free(counted);
+	return SUCCESS;
+}
+
+status_t memmgr_save(memmgr_t *manager, const char *path)
+{
+	memmgr_enter(manager);
+	if (!memmgr_snapshottable(manager))
+	{
+		return OPTN_ERROR;
+	}
+
+	snapshot_header_t header;
+	memmgr_describe(manager, &header);
+	snapshot_writer_t writer;
+	status_t error;
+	if ((error = snapshot_create(&writer, path)) != SUCCESS)
+	{
+		return error;
+	}
+
+	snapshot_write(&writer, &header, sizeof header);
+	snapshot_write(&writer, statistics, geometry.number_processes * sizeof *statistics);
+	snapshot_write(&writer, &manager->running, sizeof manager->running);
+	snapshot_write(&writer, &manager->context_switches, sizeof manager->context_switches);
+	if ((error = frame_table_save(&manager->frames, &manager->page_table, &writer)) != SUCCESS ||
+		(error = tlb_save(&manager->tlb, &writer)) != SUCCESS)
+	{
+		snapshot_finish(&writer);
+		return error;
+	}
+	return snapshot_finish(&writer);
+}
+
+status_t memmgr_restore(memmgr_t *manager, const char *path)
+{
+	memmgr_enter(manager);
+	if (!memmgr_snapshottable(manager) || manager->position > 0)
+	{
+		return OPTN_ERROR;
+	}
+
+	snapshot_reader_t reader;
+	status_t error;
+	if ((error = snapshot_open(&reader, path)) != SUCCESS)
+	{
+		return error;
+	}
+
+	snapshot_header_t header;
+	memmgr_describe(manager, &header);
+	const snapshot_header_t *saved;
+	if ((saved = snapshot_section(&reader, sizeof *saved)) == NULL || memcmp(saved, &header, sizeof header) != 0)
+	{
+		snapshot_close(&reader);
+		return saved == NULL ? FORM_ERROR : OPTN_ERROR;
+	}
+
+	snapshot_read(&reader, statistics, geometry.number_processes * sizeof *statistics);
+	snapshot_read(&reader, &manager->running, sizeof manager->running);
+	snapshot_read(&reader, &manager->context_switches, sizeof manager->context_switches);
+	if (manager->running >= geometry.number_processes)
+	{
+		snapshot_close(&reader);
+		return FORM_ERROR;
+	}
+	if ((error = frame_table_restore(&manager->frames, &manager->page_table, manager->backing, &reader)) != SUCCESS ||
+		(error = tlb_restore(&manager->tlb, &manager->page_table, &reader)) != SUCCESS)
+	{
+		snapshot_close(&reader);
+		return error;
+	}
+	return snapshot_close(&reader);
+}
+
+status_t memmgr_run_mrc(schedule_t *schedule, options_t *options)
+{
+	geometry_t mrc;
+	status_t error;
+	if ((error = geometry_initialize(&mrc, options)) != SUCCESS)
+	{
+		return error;
+	}
+	return mrc_run(&schedule->files[0], mrc.offset_bits, mrc.max_page_number, stdout);
+}
+
+static void memmgr_enter(memmgr_t *manager)
+{
+	geometry = manager->geometry;
+	statistics = manager->statistics;
+	instrument = manager->instrument;
+}
+
+static void binding_save(binding_t *binding)
+{
+	binding->geometry = geometry;
+	binding->statistics = statistics;
+	binding->instrument = instrument;
+}
+
+static void binding_restore(binding_t *binding)
+{
+	geometry = binding->geometry;
+	statistics = binding->statistics;
+	instrument = binding->instrument;
+}
+
+static void memmgr_use_future(memmgr_t *manager, const uint32_t *next_use)
+{
+	size_t partition;
+	for (partition = 0; partition < manager->frames.partitions; partition++)
+	{
+		policy_set_future(&manager->frames.policies[partition], next_use, &manager->position);
+	}
+	size_t set;
+	for (set = 0; set < geometry.tlb_sets; set++)
+	{
+		policy_set_future(&manager->tlb.policies[set], next_use, &manager->position);
+	}
+	manager->position = 0;
+}
+
+static uint8_t memmgr_snapshottable(memmgr_t *manager)
+{
+	frame_table_t *frames = &manager->frames;
+	return frames->write_back == NULL && frames->prefetch == NULL && frames->huge == NULL && frames->resident == NULL &&
+		frames->zswap == NULL && frames->dedup == NULL && !memmgr_offline(manager);
+}
+
+static void memmgr_describe(memmgr_t *manager, snapshot_header_t *header)
+{
+	memset(header, 0, sizeof *header);
+	header->page_bytes = geometry.page_bytes;
+	header->address_bits = geometry.address_bits;
+	header->number_processes = geometry.number_processes;
+	header->number_frames = geometry.number_frames;
+	header->partitions = manager->frames.partitions;
+	header->tlb_entries = geometry.tlb_entries;
+	header->tlb_ways = geometry.tlb_ways;
+	header->page_table = geometry.page_table;
+	strncpy(header->policy, manager->frames.policies[0].ops->name, SNAPSHOT_NAME_BYTES - 1);
+	strncpy(header->tlb_policy, manager->tlb.policies[0].ops->name, SNAPSHOT_NAME_BYTES - 1);
+}
+
+static size_t issue_ahead(const uint64_t *addresses, size_t count, size_t start, size_t end, frame_table_t *frames, page_table_t *page_table)
+{
+	size_t position;
+	for (position = start; position < end && position < count; position++)
+	{
+		virtual_components_t components = get_components(addresses[position]);
+		page_entry_t *entry = page_table_find(page_table, components.tag, NULL);
+		if ((entry == NULL || !entry->valid) && !pipeline_issue(frames->pipeline, components.page))
+		{
+			break;
+		}
+	}
+	return position;
+}
+
+status_t memmgr_run_cores(schedule_t *schedule, backing_store_t *backing, write_back_t *write_back, options_t *options)
+{
+	binding_t caller;
+	binding_save(&caller);
+	status_t error = simulate_cores(schedule, backing, write_back, options);
+	binding_restore(&caller);
+	return error;
+}
+
+static status_t simulate_cores(schedule_t *schedule, backing_store_t *backing, write_back_t *write_back, options_t *options)
+{
+	status_t error;
+	if ((error = geometry_initialize(&geometry, options)) != SUCCESS)
+	{
+		return error;
+	}
+
+	//shards are picked out by the low bits of the page number, so their number is a power of two,
+	//and each needs at least one frame
+	size_t shards = 1;
+	while (shards < schedule->number * SHARDS_PER_CORE && shards * 2 <= geometry.number_frames)
+	{
+		shards *= 2;
+	}
+
+	frame_table_t frames;
+	if ((error = frame_table_initialize(&frames, options->policy, shards, 1)) != SUCCESS)
+	{
+		return error;
+	}
+
+	page_table_t page_table;
+	core_t *cores = calloc(schedule->number, sizeof *cores);
+	tlb_t *tlbs = malloc(schedule->number * sizeof *tlbs);
+	if (cores == NULL || tlbs == NULL)
+	{
+		free(tlbs);
+		free(cores);
+		frame_table_uninitialize(&frames);
+		return ALOC_ERROR;
+	}
+	//a chain of a hashed page table only ever holds pages of one shard, so that it is only changed
+	//under the lock of that shard
+	unsigned int shard_bits = 0;
+	while (((size_t) 1 << shard_bits) < shards)
+	{
+		shard_bits++;
+	}
+	if ((error = page_table_initialize(&page_table, geometry.page_table, geometry.tag_bits, geometry.number_frames, shard_bits)) != SUCCESS)
+	{
+		free(tlbs);
+		free(cores);
+		frame_table_uninitialize(&frames);
+		return error;
+	}
+
+	size_t core;
+	for (core = 0; core < schedule->number; core++)
+	{
+		if ((error = tlb_initialize(&tlbs[core], options->tlb_policy)) != SUCCESS)
+		{
+			break;
+		}
+	}
+	frames.tlbs = tlbs;
+	frames.number_tlbs = core;
+	frames.write_back = write_back;
+
+	//each core records into its own instrumentation, so the probes never contend
+	instrument_t *recorded = NULL;
+	size_t instrumented = 0;
+	if (error == SUCCESS && options->instrument_file != NULL)
+	{
+		if ((recorded = malloc(schedule->number * sizeof *recorded)) == NULL)
+		{
+			error = ALOC_ERROR;
+		}
+		for (; error == SUCCESS && instrumented < schedule->number; instrumented++)
+		{
+			if ((error = instrument_initialize(&recorded[instrumented])) != SUCCESS)
+			{
+				break;
+			}
+			cores[instrumented].instrument = &recorded[instrumented];
+		}
+	}
+
+	size_t started = 0;
+	if (error == SUCCESS)
+	{
+		for (started = 0; started < schedule->number; started++)
+		{
+			cores[started].geometry = &geometry;
+			cores[started].file = &schedule->files[started];
+			cores[started].tlb = &tlbs[started];
+			cores[started].frames = &frames;
+			cores[started].page_table = &page_table;
+			cores[started].backing = backing;
+			if (pthread_create(&cores[started].thread, NULL, run_core, &cores[started]) != 0)
+			{
+				error = ALOC_ERROR;
+				break;
+			}
+		}
+	}
+
+	//the first core to fail decides the error
+	statistics_t total = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+	for (core = 0; core < started; core++)
+	{
+		pthread_join(cores[core].thread, NULL);
+		if (error == SUCCESS)
+		{
+			error = cores[core].error;
+		}
+		add_statistics(&total, &cores[core].statistics);
+	}
+
+	//the final flush is made on this thread, and is timed along with the first core
+	instrument = recorded;
+	if (error == SUCCESS && write_back != NULL)
+	{
+		error = frame_table_flush(&frames, &page_table);
+	}
+	instrument = NULL;
+
+	for (core = 1; error == SUCCESS && core < instrumented; core++)
+	{
+		error = instrument_add(&recorded[0], &recorded[core]);
+	}
+	if (error == SUCCESS && recorded != NULL)
+	{
+		error = write_instrumentation(&recorded[0], options->instrument_file);
+	}
+	for (core = 0; core < instrumented; core++)
+	{
+		instrument_uninitialize(&recorded[core]);
+	}
+	free(recorded);
+
+	if (error == SUCCESS)
+	{
+		print_statistics(stdout, "", &total);
+		printf("TLB Shootdowns = %zu\n", total.shootdowns);
+		if (options->page_table != PAGE_TABLE_AUTO)
+		{
+			print_page_table_statistics(stdout, "", &total);
+			printf("Page Table Footprint = %zu bytes\n", page_table.footprint);
+		}
+		for (core = 0; core < schedule->number; core++)
+		{
+			printf("Core %zu (%s):\n", core, options->input_files[core]);
+			print_statistics(stdout, "  ", &cores[core].statistics);
+			printf("  TLB Shootdowns = %zu\n", cores[core].statistics.shootdowns);
+			if (options->page_table != PAGE_TABLE_AUTO)
+			{
+				print_page_table_statistics(stdout, "  ", &cores[core].statistics);
+			}
+		}
+	}
+
+	for (core = 0; core < frames.number_tlbs; core++)
+	{
+		tlb_uninitialize(&tlbs[core]);
+	}
+	page_table_uninitialize(&page_table);
+	free(tlbs);
+	free(cores);
+	frame_table_uninitialize(&frames);
+	return error;
+}
+
+static void *run_core(void *argument)
+{
+	core_t *core = argument;
+	geometry = *core->geometry;
+	statistics = &core->statistics;
+	instrument = core->instrument;
+
+	//the references of several threads would come out in no particular order, so only the
+	//statistics are printed
+	trace_t trace;
+	frameval_t value;
+	trace_initialize(&trace);
+	while ((core->error = trace_read(&trace, core->file, TRACE_BATCH)) == SUCCESS && trace.length > 0)
+	{
+		size_t position;
+		for (position = 0; position < trace.length; position++)
+		{
+			//every change to a page, its frame and its page table entry is made under the lock of
+			//its shard, and a core evicting a page queues the shootdown while holding that lock, so
+			//draining the queue once the lock is held leaves no stale translation of the page
+			pthread_mutex_t *lock = &core->frames->locks[frame_table_partition(core->frames, get_components(trace.addresses[position]).tag)];
+			pthread_mutex_lock(lock);
+			tlb_drain(core->tlb);
+			core->error = print_for_address(core->backing, &silent, trace.addresses[position], core->frames, core->page_table, core->tlb, trace.writes[position], &value);
+			pthread_mutex_unlock(lock);
+
+			if (core->error != SUCCESS)
+			{
+				break;
+			}
+		}
+
+		if (core->error != SUCCESS)
+		{
+			break;
+		}
+	}
+	trace_uninitialize(&trace);
+	return NULL;
+}
+
+status_t memmgr_run_sweep(schedule_t *schedule, backing_store_t *backing, options_t *options)
+{
+	binding_t caller;
+	binding_save(&caller);
+	status_t error = simulate_sweep(schedule, backing, options);
+	binding_restore(&caller);
+	return error;
+}
+
+static status_t simulate_sweep(schedule_t *schedule, backing_store_t *backing, options_t *options)
+{
+	//a dimension which is not swept takes the single value of its option
+	size_t *frame_counts = options->sweep_frames != NULL ? options->sweep_frames : &options->number_frames;
+	size_t number_frame_counts = options->sweep_frames != NULL ? options->number_sweep_frames : 1;
+	size_t *tlb_sizes = options->sweep_tlb != NULL ? options->sweep_tlb : &options->tlb_entries;
+	size_t number_tlb_sizes = options->sweep_tlb != NULL ? options->number_sweep_tlb : 1;
+	const char **policies = options->sweep_policies != NULL ? options->sweep_policies : &options->policy;
+	size_t number_policies = options->sweep_policies != NULL ? options->number_sweep_policies : 1;
+
+	sweep_t grid;
+	grid.options = options;
+	grid.backing = backing;
+	grid.next_use = NULL;
+	grid.number_points = number_frame_counts * number_tlb_sizes * number_policies;
+	if ((grid.points = malloc(grid.number_points * sizeof *grid.points)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	//every point is checked before any is simulated, in the order of the table: by frame count,
+	//then by TLB size, then by policy. Pages read ahead, and those read in to complete a huge page,
+	//are not in the future an offline policy is given
+	status_t error = SUCCESS;
+	uint8_t offline = options->tlb_policy != NULL && policy_find(options->tlb_policy)->offline;
+	size_t index = 0;
+	size_t f, t, p;
+	for (f = 0; f < number_frame_counts && error == SUCCESS; f++)
+	{
+		for (t = 0; t < number_tlb_sizes && error == SUCCESS; t++)
+		{
+			for (p = 0; p < number_policies && error == SUCCESS; p++)
+			{
+				options_t point = *options;
+				point.number_frames = frame_counts[f];
+				point.tlb_entries = tlb_sizes[t];
+				point.policy = policies[p];
+				if (policy_find(point.policy)->offline && (options->prefetch_degree > 0 || options->huge_bytes > 0))
+				{
+					error = OPTN_ERROR;
+				}
+				else if ((error = geometry_initialize(&grid.points[index].geometry, &point)) == SUCCESS)
+				{
+					grid.points[index].policy = point.policy;
+					offline = offline || policy_find(point.policy)->offline;
+					index++;
+				}
+			}
+		}
+	}
+
+	//the trace is decoded once, along with its future if any point needs it, and only read from
+	//then on
+	if (error == SUCCESS)
+	{
+		error = schedule_read(schedule, TRACE_ALL, &grid.trace);
+	}
+	if (error == SUCCESS && offline)
+	{
+		error = trace_next_use(grid.trace, grid.points[0].geometry.offset_bits, grid.points[0].geometry.tag_mask, &grid.next_use);
+	}
+
+	//there is no use in more threads than points
+	size_t threads = options->threads;
+	if (threads == 0)
+	{
+		long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = processors < 1 ? 1 : processors > MAX_WORK_THREADS ? MAX_WORK_THREADS : (size_t) processors;
+	}
+	if (threads > grid.number_points)
+	{
+		threads = grid.number_points;
+	}
+
+	size_t steals = 0;
+	if (error == SUCCESS)
+	{
+		error = work_pool_run(grid.number_points, threads, run_sweep_point, &grid, &steals);
+	}
+
+	if (error == SUCCESS)
+	{
+		printf("Number of Translated Addresses = %zu\n", grid.points[0].total.translated);
+		printf("Sweep Points = %zu on %zu threads (steals = %zu)\n", grid.number_points, threads, steals);
+		printf("Frames TLB_Entries Policy Page_Faults Fault_Rate TLB_Hits TLB_Hit_Ratio Write_Backs Prefetch_Hits Page_Table_Walks Huge_TLB_Hits Seconds\n");
+		for (index = 0; index < grid.number_points; index++)
+		{
+			sweep_point_t *point = &grid.points[index];
+			statistics_t *total = &point->total;
+			printf("%zu %zu %s %zu %lf %zu %lf %zu %zu %zu %zu %lf\n", point->geometry.number_frames, point->geometry.tlb_entries, point->policy,
+				total->page_faults, (double) total->page_faults / total->translated, total->tlb_hits, (double) total->tlb_hits / total->translated,
+				total->write_backs, total->prefetch_hits, total->walks, total->huge_tlb_hits, point->seconds);
+		}
+	}
+
+	free(grid.next_use);
+	free(grid.points);
+	return error;
+}
+
+static status_t run_sweep_point(void *context, size_t task)
+{
+	sweep_t *grid = context;
+	sweep_point_t *point = &grid->points[task];
+	options_t options = *grid->options;
+	options.number_frames = point->geometry.number_frames;
+	options.tlb_entries = point->geometry.tlb_entries;
+	options.policy = point->policy;
+
+	//the time is that of the thread's processor, which more threads than processors do not stretch
+	struct timespec start;
+	struct timespec end;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+	memmgr_t *manager;
+	status_t error;
+	if ((error = memmgr_open(&manager, &options, grid->backing, NULL, NULL)) != SUCCESS)
+	{
+		return error;
+	}
+	if (memmgr_offline(manager))
+	{
+		memmgr_use_future(manager, grid->next_use);
+	}
+	if ((error = memmgr_translate_batch(manager, grid->trace->addresses, grid->trace->writes, grid->trace->length, NULL)) == SUCCESS)
+	{
+		memmgr_statistics(manager, &point->total);
+	}
+	memmgr_close(manager);
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+	point->seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	return error;
+}
+
+static status_t print_for_address(backing_store_t *backing, output_t *out, uint64_t address, frame_table_t *frames, page_table_t *page_table, tlb_t *tlb, uint8_t is_write, frameval_t *value)
+{
+	//get the process, page and offset from the address
+	virtual_components_t components = get_components(address);
+	status_t error;
+	if (instrument_active(instrument) && (error = instrument_reference(instrument, components.tag)) != SUCCESS)
+	{
+		return error;
+	}
+	
+	frame_number_t frame;
+	physical_address_t phys_addr;
+	uint8_t observed = 0;
+	size_t faults = statistics[components.process].page_faults;
+	uint64_t start = instrument_start(instrument);
+	int tlb_entry = get_frame_from_tlb(tlb, components.tag, &frame);
+	if (tlb_entry == TLB_MISS && frames->huge != NULL)
+	{
+		tlb_entry = get_frame_from_huge_tlb(tlb, page_table, &components, &frame);
+	}
+	instrument_stop(instrument, PROBE_TLB, start);
+
+	if (tlb_entry != TLB_MISS)
+	{
+		phys_addr = get_physical_address(frame, components.offset);
+
+		//indicate that the tlb entry and the frame have just been referenced
+		tlb_hit(tlb, tlb_entry, is_write);
+		frame_table_hit(frames, frame, is_write);
+	}
+	else 
+	{
+		if ((error = load_if_necessary(page_table, &components, frames, tlb, backing, is_write, &frame, &observed)) != SUCCESS)
+		{
+			return error;
+		}
+
+		phys_addr = get_physical_address(frame, components.offset);
+
+		//update the tlb, with a single entry for the whole of a huge page
+		page_number_t region = components.tag >> geometry.huge_shift;
+		if (frames->huge != NULL && huge_pages_state(frames->huge, region) == HUGE_MAPPED)
+		{
+			tlb_insert(tlb, HUGE_TAG_BIT | region, frame, is_write);
+		}
+		else
+		{
+			tlb_insert(tlb, components.tag, frame, is_write);
+		}
+	}
+
+	//a page sharing its frame is given a copy of its own before it is written, and a frame being
+	//written can no longer be shared
+	if (is_write && frames->dedup != NULL)
+	{
+		if (dedup_count(frames->dedup, frame) > 1 &&
+			(error = frame_table_copy_on_write(page_table, &components, frames, tlb, &frame)) != SUCCESS)
+		{
+			return error;
+		}
+		dedup_unindex(frames->dedup, frame);
+		phys_addr = get_physical_address(frame, components.offset);
+	}
+
+	//actually retrieve the memory value at the given physical address
+	frameval_t memval = get_value_at_address(frames, phys_addr);
+	output_reference(out, (virtual_address_t) (address & geometry.virtual_mask), phys_addr, memval);
+	*value = memval;
+
+	//if it's a write, set the dirty bit after the memory access. Unless writes are simulated, the
+	//page is never actually written back out, because this program does not otherwise do any
+	//writing; when they are, the write adds one to the value
+	if (is_write)
+	{
+		page_table_find(page_table, components.tag, NULL)->dirty = 1;
+		if (frames->write_back != NULL)
+		{
+			set_value_at_address(frames, phys_addr, memval + 1);
+		}
+	}
+
+	//update the statistics
+	statistics[components.process].translated++;
+
+	//the pages which have left the resident set make room before any read ahead
+	if (frames->resident != NULL &&
+		(error = frame_table_resize(page_table, &components, frames, tlb, frame, statistics[components.process].page_faults != faults)) != SUCCESS)
+	{
+		return error;
+	}
+
+	//read ahead or complete a huge page only once the reference is over, so that the pages read
+	//cannot displace the one it needed before it was used
+	if (observed && frames->prefetch != NULL &&
+		(error = frame_table_prefetch(page_table, &components, frames, tlb, backing)) != SUCCESS)
+	{
+		return error;
+	}
+	if (observed && frames->huge != NULL &&
+		(error = frame_table_promote(page_table, &components, frames, tlb, backing)) != SUCCESS)
+	{
+		return error;
+	}
+
+	return SUCCESS;
+}
+
+static void add_statistics(statistics_t *total, statistics_t *statistics)
+{
+	total->translated += statistics->translated;
+	total->page_faults += statistics->page_faults;
+	total->tlb_hits += statistics->tlb_hits;
+	total->write_backs += statistics->write_backs;
+	total->shootdowns += statistics->shootdowns;
+	total->prefetches += statistics->prefetches;
+	total->prefetch_hits += statistics->prefetch_hits;
+	total->prefetch_wasted += statistics->prefetch_wasted;
+	total->walks += statistics->walks;
+	total->walk_references += statistics->walk_references;
+	total->huge_tlb_hits += statistics->huge_tlb_hits;
+	total->promotions += statistics->promotions;
+	total->demotions += statistics->demotions;
+	total->huge_fills += statistics->huge_fills;
+	total->huge_wasted += statistics->huge_wasted;
+}
+
+static void print_statistics(FILE *summary, const char *indent, statistics_t *statistics)
+{
+	fprintf(summary, "%sNumber of Translated Addresses = %zu\n", indent, statistics->translated);
+	fprintf(summary, "%sPercentage of Page Faults = %lf (absolute = %zu)\n", indent, (double) statistics->page_faults / statistics->translated, statistics->page_faults);
+	fprintf(summary, "%sTLB Hit Ratio = %lf (absolute = %zu)\n", indent, (double) statistics->tlb_hits / statistics->translated, statistics->tlb_hits);
+	fprintf(summary, "%sWrite-Backs = %lf (absolute = %zu)\n", indent, (double) statistics->write_backs / statistics->translated, statistics->write_backs);
+}
+
+static void print_prefetch_statistics(FILE *summary, const char *indent, statistics_t *statistics)
+{
+	fprintf(summary, "%sPrefetches Issued = %zu\n", indent, statistics->prefetches);
+	fprintf(summary, "%sPrefetch Hits = %lf (absolute = %zu)\n", indent, (double) statistics->prefetch_hits / statistics->prefetches, statistics->prefetch_hits);
+	fprintf(summary, "%sPrefetches Wasted = %lf (absolute = %zu)\n", indent, (double) statistics->prefetch_wasted / statistics->prefetches, statistics->prefetch_wasted);
+}
+
+static void print_page_table_statistics(FILE *summary, const char *indent, statistics_t *statistics)
+{
+	fprintf(summary, "%sPage Table Walks = %zu\n", indent, statistics->walks);
+	fprintf(summary, "%sPage Table References per Walk = %lf (absolute = %zu)\n", indent, (double) statistics->walk_references / statistics->walks, statistics->walk_references);
+}
+
+static void print_huge_page_statistics(FILE *summary, const char *indent, statistics_t *statistics)
+{
+	fprintf(summary, "%sHuge Page Promotions = %zu\n", indent, statistics->promotions);
+	fprintf(summary, "%sHuge Page Demotions = %zu\n", indent, statistics->demotions);
+	fprintf(summary, "%sHuge TLB Hits = %lf (absolute = %zu)\n", indent, (double) statistics->huge_tlb_hits / statistics->translated, statistics->huge_tlb_hits);
+	fprintf(summary, "%sPages Filled by Promotion = %zu\n", indent, statistics->huge_fills);
+	fprintf(summary, "%sFilled Pages Never Referenced = %lf (absolute = %zu, %zu bytes)\n", indent, (double) statistics->huge_wasted / statistics->huge_fills, statistics->huge_wasted, statistics->huge_wasted * geometry.page_bytes);
+}
+
+static void print_resident_statistics(FILE *summary, const char *indent, resident_process_t *resident)
+{
+	fprintf(summary, "%sMean Frames in Use = %lf (peak = %zu)\n", indent, (double) resident->space_time / resident->clock, resident->peak);
+	fprintf(summary, "%sSpace-Time Product = %" PRIu64 " frame-references\n", indent, resident->space_time);
+	fprintf(summary, "%sFrames Released = %zu\n", indent, resident->released);
+}
+
+static void print_zswap_statistics(FILE *summary, zswap_t *zswap)
+{
+	zswap_statistics_t *s = &zswap->statistics;
+	uint64_t compressions = s->offered - s->same_filled;
+	fprintf(summary, "Compressed Pages Stored = %" PRIu64 " of %" PRIu64 " (same-filled = %" PRIu64 ", incompressible = %" PRIu64 ")\n",
+		s->stored, s->offered, s->same_filled, s->incompressible);
+	fprintf(summary, "Compressed Page Loads = %" PRIu64 " (backing store reads saved)\n", s->loads);
+	fprintf(summary, "Compressed Pages Pushed Out = %" PRIu64 " (dirty = %" PRIu64 ")\n", s->evictions, s->dirty_evictions);
+	fprintf(summary, "Compression Ratio = %lf\n", s->compressed_bytes == 0 ? 0.0 : (double) s->raw_bytes / s->compressed_bytes);
+	fprintf(summary, "Compressed Pool = %zu bytes held in %zu of %zu slabs of %zu bytes\n", zswap->used_bytes, zswap->used_slabs, zswap->number_slabs, zswap->slab_bytes);
+	fprintf(summary, "Compression Time = %lf ns per page (%" PRIu64 " pages)\n", compressions == 0 ? 0.0 : (double) s->compress_ns / compressions, compressions);
+	fprintf(summary, "Decompression Time = %lf ns per page (%" PRIu64 " pages)\n", s->decompressions == 0 ? 0.0 : (double) s->decompress_ns / s->decompressions, s->decompressions);
+}
+
+static void print_dedup_statistics(FILE *summary, dedup_t *dedup)
+{
+	dedup_statistics_t *s = &dedup->statistics;
+	fprintf(summary, "Frames Saved by Sharing = %" PRIu64 " (peak = %" PRIu64 ")\n", s->shared, s->peak_shared);
+	fprintf(summary, "Pages Merged = %" PRIu64 " (copied on write = %" PRIu64 ")\n", s->merged, s->copies);
+	fprintf(summary, "Hashing Time = %lf ns per page (%" PRIu64 " pages)\n", s->hashed == 0 ? 0.0 : (double) s->hash_ns / s->hashed, s->hashed);
+}
+
+static virtual_components_t get_components(uint64_t address)
+{
+	virtual_components_t components = { get_process(address), get_page(address), 0, get_offset(address) };
+	components.tag = ((page_number_t) components.process << geometry.page_bits) | components.page;
+	return components;
+}
+
+static process_t get_process(uint64_t address)
+{
+	//a 64 bit address leaves no room for a process above it, and there is then only the one
+	return (address >> (geometry.address_bits & 63)) & geometry.process_mask;
+}
+
+static page_number_t get_page(uint64_t address)
+{
+	//shift right by the OFFSET_SIZE (because the offset takes up the lower bits), and than AND by
+	//the max value to get the value of the upper bits are
+	return (address >> geometry.offset_bits) & geometry.max_page_number;
+}
+
+static offset_t get_offset(uint64_t address)
+{
+	return address & geometry.max_offset;
+}
+
+static status_t geometry_initialize(geometry_t *geometry, options_t *options)
+{
+	//the page size must be a power of two so that an address splits cleanly into page and offset
+	if (options->page_bytes == 0 || (options->page_bytes & (options->page_bytes - 1)) != 0)
+	{
+		return GEOM_ERROR;
+	}
+
+	unsigned int offset_bits = 0;
+	while (((size_t) 1 << offset_bits) < options->page_bytes)
+	{
+		offset_bits++;
+	}
+
+	if (options->address_bits > MAX_ADDRESS_BITS || options->address_bits < offset_bits)
+	{
+		return GEOM_ERROR;
+	}
+
+	if (options->number_frames == 0 || options->number_frames > INT32_MAX ||
+		options->tlb_entries == 0 || options->tlb_entries > INT32_MAX)
+	{
+		return GEOM_ERROR;
+	}
+
+	//the process of a reference sits above its address, and above its page number in a tag; local
+	//replacement gives each process at least one frame of its own. Cores all share one process, as
+	//do the references given to a manager opened without any address files
+	size_t number_processes = options->cores || options->number_inputs == 0 ? 1 : options->number_inputs;
+	unsigned int process_bits = 0;
+	while (((size_t) 1 << process_bits) < number_processes)
+	{
+		process_bits++;
+	}
+	if (options->address_bits - offset_bits + process_bits > MAX_TAG_BITS ||
+		(process_bits > 0 && options->address_bits + process_bits > MAX_ADDRESS_BITS) ||
+		(options->local_frames && options->number_frames < number_processes))
+	{
+		return GEOM_ERROR;
+	}
+
+	//a flat page table would be far too large for a wide address space, which is given a radix one
+	//unless another design is asked for
+	geometry->page_table = options->page_table;
+	if (geometry->page_table == PAGE_TABLE_AUTO)
+	{
+		geometry->page_table = options->address_bits - offset_bits <= MAX_PAGE_BITS ? PAGE_TABLE_FLAT : PAGE_TABLE_RADIX;
+	}
+
+	geometry->page_bytes = options->page_bytes;
+	geometry->offset_bits = offset_bits;
+	geometry->max_offset = options->page_bytes - 1;
+	geometry->address_bits = options->address_bits;
+	geometry->page_bits = options->address_bits - offset_bits;
+	geometry->number_pages = (size_t) 1 << geometry->page_bits;
+	geometry->max_page_number = geometry->number_pages - 1;
+	geometry->number_processes = number_processes;
+	geometry->process_mask = ((uint64_t) 1 << process_bits) - 1;
+	geometry->virtual_mask = process_bits == 0 ? UINT64_MAX : ((uint64_t) 1 << options->address_bits) - 1;
+	geometry->tag_mask = ((page_number_t) 1 << (geometry->page_bits + process_bits)) - 1;
+	geometry->tag_bits = geometry->page_bits + process_bits;
+	geometry->number_frames = options->number_frames;
+	geometry->tlb_entries = options->tlb_entries;
+
+	//a huge page is a power of two pages, which must fit in the address space and in the frames of
+	//a single partition, or it could never be completed
+	geometry->huge_shift = 0;
+	if (options->huge_bytes > 0)
+	{
+		if ((options->huge_bytes & (options->huge_bytes - 1)) != 0 || options->huge_bytes <= options->page_bytes)
+		{
+			return GEOM_ERROR;
+		}
+		while ((options->page_bytes << geometry->huge_shift) < options->huge_bytes)
+		{
+			geometry->huge_shift++;
+		}
+		if (geometry->huge_shift > geometry->page_bits ||
+			((size_t) 1 << geometry->huge_shift) > options->number_frames / (options->local_frames ? number_processes : 1))
+		{
+			return GEOM_ERROR;
+		}
+	}
+
+	//a TLB of ways entries per set holds entries / ways sets, which must be a power of two so that
+	//the set of a page is picked out by a mask
+	geometry->tlb_ways = options->tlb_ways == 0 ? options->tlb_entries : options->tlb_ways;
+	if (geometry->tlb_ways > geometry->tlb_entries || geometry->tlb_entries % geometry->tlb_ways != 0)
+	{
+		return GEOM_ERROR;
+	}
+	geometry->tlb_sets = geometry->tlb_entries / geometry->tlb_ways;
+	if ((geometry->tlb_sets & (geometry->tlb_sets - 1)) != 0)
+	{
+		return GEOM_ERROR;
+	}
+	geometry->tlb_stride = (geometry->tlb_ways + TLB_LANES - 1) / TLB_LANES * TLB_LANES;
+
+	return SUCCESS;
+}
+
+static uint8_t offline_policies(options_t *options)
+{
+	return policy_find(options->policy)->offline || (options->tlb_policy != NULL && policy_find(options->tlb_policy)->offline);
+}
+
+static uint8_t sweeping(options_t *options)
+{
+	return options->sweep_frames != NULL || options->sweep_tlb != NULL || options->sweep_policies != NULL;
+}
+
+static uint8_t check_windows(options_t *options)
+{
+	return (options->report_references == 0 && options->report_seconds == 0) ||
+		!(options->mrc || options->cores || sweeping(options) || offline_policies(options));
+}
+
+static uint8_t check_sweep(options_t *options)
+{
+	return !sweeping(options) ||
+		!(options->mrc || options->cores || options->io_workers > 0 || options->write_back != WRITE_BACK_NONE || options->instrument_file != NULL);
+}
+
+static uint8_t check_mrc(options_t *options)
+{
+	return !options->mrc || options->number_inputs <= 1;
+}
+
+static uint8_t check_cores(options_t *options)
+{
+	return !options->cores || !(options->mrc || options->local_frames || offline_policies(options));
+}
+
+static uint8_t check_write_back(options_t *options)
+{
+	return options->write_back == WRITE_BACK_NONE || options->cores || options->number_inputs <= 1;
+}
+
+static uint8_t check_prefetch(options_t *options)
+{
+	return options->prefetch_degree == 0 || !(options->cores || policy_find(options->policy)->offline);
+}
+
+static uint8_t check_huge_pages(options_t *options)
+{
+	return options->huge_bytes == 0 || !(options->cores || offline_policies(options));
+}
+
+static uint8_t check_io_workers(options_t *options)
+{
+	return options->io_workers == 0 || !(options->cores || options->write_back != WRITE_BACK_NONE);
+}
+
+static uint8_t check_instrument(options_t *options)
+{
+	return options->instrument_file == NULL || !(options->mrc || !INSTRUMENT_PROBES);
+}
+
+static uint8_t check_resident(options_t *options)
+{
+	return options->resident_policy == RESIDENT_OFF || !(options->cores || options->local_frames || options->mrc);
+}
+
+static uint8_t check_zswap(options_t *options)
+{
+	return options->zswap_bytes == 0 || !(options->cores || options->mrc || options->io_workers > 0);
+}
+
+static uint8_t check_snapshot(options_t *options)
+{
+	return (options->snapshot_file == NULL && options->restore_file == NULL) ||
+		!(options->cores || options->mrc || sweeping(options) || options->write_back != WRITE_BACK_NONE || options->prefetch_degree > 0 ||
+		options->huge_bytes > 0 || options->resident_policy != RESIDENT_OFF || options->zswap_bytes > 0 || offline_policies(options));
+}
+
+static uint8_t check_dedup(options_t *options)
+{
+	return !options->dedup ||
+		!(options->cores || options->mrc || sweeping(options) || options->local_frames || options->prefetch_degree > 0 || options->huge_bytes > 0 ||
+		options->resident_policy != RESIDENT_OFF || options->zswap_bytes > 0 || options->io_workers > 0 || options->page_table == PAGE_TABLE_HASHED ||
+		options->snapshot_file != NULL || options->restore_file != NULL || policy_find(options->policy)->offline);
+}
+
+static status_t frame_table_initialize(frame_table_t *frames, const char *policy, size_t partitions, uint8_t sharded)
+{
+	frames->partitions = partitions;
+	frames->sharded = sharded;
+	frames->tlbs = NULL;
+	frames->number_tlbs = 0;
+	frames->write_back = NULL;
+	frames->prefetch = NULL;
+	frames->pipeline = NULL;
+	frames->huge = NULL;
+	frames->resident = NULL;
+	frames->zswap = NULL;
+	frames->dedup = NULL;
+	frames->number_free = 0;
+	frames->locks = sharded ? malloc(partitions * sizeof *frames->locks) : NULL;
+	frames->first_frame = malloc((partitions + 1) * sizeof *frames->first_frame);
+	frames->used_frames = calloc(partitions, sizeof *frames->used_frames);
+	frames->policies = malloc(partitions * sizeof *frames->policies);
+	frames->table = malloc(geometry.number_frames * geometry.page_bytes * sizeof *frames->table);
+	frames->contents = malloc(geometry.number_frames * sizeof *frames->contents);
+	frames->page_for_frame = malloc(geometry.number_frames * sizeof *frames->page_for_frame);
+	frames->free_frames = malloc(geometry.number_frames * sizeof *frames->free_frames);
+	if ((sharded && frames->locks == NULL) || frames->first_frame == NULL || frames->used_frames == NULL ||
+		frames->policies == NULL || frames->table == NULL || frames->contents == NULL || frames->page_for_frame == NULL ||
+		frames->free_frames == NULL)
+	{
+		free(frames->free_frames);
+		free(frames->locks);
+		free(frames->first_frame);
+		free(frames->used_frames);
+		free(frames->policies);
+		free(frames->table);
+		free(frames->contents);
+		free(frames->page_for_frame);
+		frames->policies = NULL;
+		return ALOC_ERROR;
+	}
+
+	//share the frames out as evenly as possible
+	size_t partition;
+	for (partition = 0; partition <= partitions; partition++)
+	{
+		frames->first_frame[partition] = partition * geometry.number_frames / partitions;
+	}
+
+	status_t error;
+	for (partition = 0; partition < partitions; partition++)
+	{
+		if ((error = policy_initialize(&frames->policies[partition], policy, frames->first_frame[partition + 1] - frames->first_frame[partition])) != SUCCESS)
+		{
+			while (partition-- > 0)
+			{
+				policy_uninitialize(&frames->policies[partition]);
+			}
+			free(frames->locks);
+			free(frames->first_frame);
+			free(frames->used_frames);
+			free(frames->policies);
+			free(frames->table);
+			free(frames->contents);
+			free(frames->page_for_frame);
+			free(frames->free_frames);
+			frames->policies = NULL;
+			return error;
+		}
+
+		if (sharded)
+		{
+			pthread_mutex_init(&frames->locks[partition], NULL);
+		}
+	}
+
+	return SUCCESS;
+}
+
+static void frame_table_uninitialize(frame_table_t *frames)
+{
+	//a frame table which never finished initializing has nothing left to free
+	if (frames->policies == NULL)
+	{
+		return;
+	}
+
+	size_t partition;
+	for (partition = 0; partition < frames->partitions; partition++)
+	{
+		policy_uninitialize(&frames->policies[partition]);
+		if (frames->sharded)
+		{
+			pthread_mutex_destroy(&frames->locks[partition]);
+		}
+	}
+	free(frames->free_frames);
+	free(frames->page_for_frame);
+	free(frames->contents);
+	free(frames->table);
+	free(frames->policies);
+	free(frames->used_frames);
+	free(frames->first_frame);
+	free(frames->locks);
+}
+
+static size_t frame_table_partition(frame_table_t *frames, page_number_t tag)
+{
+	if (frames->partitions == 1)
+	{
+		return 0;
+	}
+	//a shard is picked out by the low bits of the page, while under local replacement a page
+	//belongs to the partition of its process
+	return frames->sharded ? tag & (frames->partitions - 1) : tag >> geometry.page_bits;
+}
+
+static void frame_table_hit(frame_table_t *frames, frame_number_t frame, uint8_t is_write)
+{
+	size_t partition = frame_table_partition(frames, frames->page_for_frame[frame]);
+	policy_hit(&frames->policies[partition], frame - frames->first_frame[partition], is_write);
+}
+
+static status_t load_if_necessary(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, backing_store_t *backing, uint8_t is_write, frame_number_t *frame, uint8_t *observed)
+{
+	//a TLB miss walks the page table, whatever its design
+	size_t references = 0;
+	uint64_t start = instrument_start(instrument);
+	page_entry_t *entry = page_table_find(page_table, components->tag, &references);
+	instrument_stop(instrument, PROBE_WALK, start);
+
+	//a huge page which covers exactly a leaf node of a radix table is mapped one level up, as on
+	//x86-64
+	if (frames->huge != NULL && geometry.huge_shift == RADIX_BITS && page_table->kind == PAGE_TABLE_RADIX &&
+		page_table->levels > 1 && huge_pages_state(frames->huge, components->tag >> geometry.huge_shift) == HUGE_MAPPED)
+	{
+		references--;
+	}
+	statistics[components->process].walks++;
+	statistics[components->process].walk_references += references;
+	if (entry != NULL && entry->valid)
+	{
+		frame_table_hit(frames, entry->frame, is_write);
+		*frame = entry->frame;
+		entry->filled = 0;
+
+		//the first reference to a page read ahead is a fault which the prefetcher saved
+		*observed = entry->prefetched;
+		if (entry->prefetched)
+		{
+			statistics[components->process].prefetch_hits++;
+			entry->prefetched = 0;
+		}
+		return SUCCESS;
+	}
+
+	statistics[components->process].page_faults++;
+	*observed = 1;
+	status_t error;
+	if (instrument_active(instrument) && (error = instrument_fault(instrument, components->tag)) != SUCCESS)
+	{
+		return error;
+	}
+	start = instrument_start(instrument);
+	if ((error = frame_table_load(page_table, components, frames, tlb, backing, is_write, 0)) != SUCCESS)
+	{
+		return error;
+	}
+	instrument_stop(instrument, PROBE_FAULT, start);
+	*frame = page_table_find(page_table, components->tag, NULL)->frame;
+	return SUCCESS;
+}
+
+static status_t frame_table_load(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, backing_store_t *backing, uint8_t is_write, uint8_t prefetched)
+{
+	page_number_t page = components->page;
+	size_t partition = frame_table_partition(frames, components->tag);
+	frame_number_t first_frame = frames->first_frame[partition];
+	frame_number_t next_frame;
+	status_t error;
+	if ((error = frame_table_allocate(page_table, components, frames, tlb, &next_frame)) != SUCCESS)
+	{
+		return error;
+	}
+	//a page kept compressed is decompressed into the frame, and is still dirty if it was when it
+	//was evicted, since it has not been written back yet
+	uint8_t swapped = 0;
+	uint8_t swapped_dirty = 0;
+	if (frames->zswap != NULL)
+	{
+		frames->contents[next_frame] = frames->table + (size_t) next_frame * geometry.page_bytes;
+		if ((error = zswap_load(frames->zswap, components->tag, frames->contents[next_frame], &swapped, &swapped_dirty)) != SUCCESS)
+		{
+			return error;
+		}
+	}
+
+	//unless writes are simulated nothing is ever written to a frame, so when the backing store
+	//is mapped the frame can simply refer to the page in place; otherwise read the page into
+	//the frames table at the next available frame, through the write-back in case the page is
+	//still waiting to be written
+	if (!swapped && (frames->write_back != NULL || (frames->contents[next_frame] = backing_store_page(backing, page)) == NULL))
+	{
+		frames->contents[next_frame] = frames->table + (size_t) next_frame * geometry.page_bytes;
+		uint64_t start = instrument_start(instrument);
+		if (frames->write_back != NULL)
+		{
+			error = write_back_read(frames->write_back, page, frames->contents[next_frame]);
+		}
+		else if (frames->pipeline != NULL)
+		{
+			error = pipeline_read(frames->pipeline, page, frames->contents[next_frame]);
+		}
+		else
+		{
+			error = backing_store_read(backing, page, frames->contents[next_frame]);
+		}
+		if (error != SUCCESS)
+		{
+			return error;
+		}
+		instrument_stop(instrument, PROBE_IO, start);
+	}
+
+	//when pages are deduplicated a page read in is hashed, and if a frame already holds the same
+	//contents the page shares that frame instead, leaving its own free for the next page brought
+	//in. A page faulted in by a write is about to differ from every other, so is neither hashed
+	//nor shared
+	uint64_t hash = 0;
+	frame_number_t shared;
+	if (frames->dedup != NULL && !is_write && dedup_find(frames->dedup, frames->contents[next_frame], frames->contents, &hash, &shared))
+	{
+		frames->free_frames[frames->number_free++] = next_frame;
+		if (page_table_map(page_table, components->tag, shared) == NULL)
+		{
+			return ALOC_ERROR;
+		}
+		frame_table_hit(frames, shared, is_write);
+		return dedup_add(frames->dedup, shared, components->tag);
+	}
+
+	//then indicate the frame associated with the page and mark the table entry valid and
+	//undirty
+	page_entry_t *entry;
+	if ((entry = page_table_map(page_table, components->tag, next_frame)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	entry->prefetched = prefetched;
+	entry->dirty = swapped_dirty;
+	if (frames->huge != NULL && (error = huge_pages_map(frames->huge, components->tag >> geometry.huge_shift)) != SUCCESS)
+	{
+		return error;
+	}
+	//and associate the given frame with the new page
+	frames->page_for_frame[next_frame] = components->tag;
+	if (frames->resident != NULL)
+	{
+		resident_set_insert(frames->resident, components->process, next_frame);
+	}
+	if (prefetched)
+	{
+		policy_insert_cold(&frames->policies[partition], next_frame - first_frame, components->tag);
+	}
+	else
+	{
+		policy_insert(&frames->policies[partition], next_frame - first_frame, components->tag, is_write);
+	}
+	if (frames->dedup != NULL && (error = dedup_add(frames->dedup, next_frame, components->tag)) != SUCCESS)
+	{
+		return error;
+	}
+	if (frames->dedup != NULL && !is_write && (error = dedup_index(frames->dedup, next_frame, hash)) != SUCCESS)
+	{
+		return error;
+	}
+
+	return SUCCESS;
+}
+
+static status_t frame_table_allocate(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, frame_number_t *frame)
+{
+	size_t partition = frame_table_partition(frames, components->tag);
+	frame_number_t first_frame = frames->first_frame[partition];
+	if (frames->number_free > 0)
+	{
+		*frame = frames->free_frames[--frames->number_free];
+	}
+	else if (frames->used_frames[partition] < frames->first_frame[partition + 1] - first_frame)
+	{
+		*frame = first_frame + frames->used_frames[partition];
+		frames->used_frames[partition]++;
+	}
+	else
+	{
+		*frame = first_frame + policy_victim(&frames->policies[partition], components->tag);
+		return frame_table_evict(page_table, frames, tlb, *frame, components->process);
+	}
+
+	return SUCCESS;
+}
+
+static status_t frame_table_copy_on_write(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, frame_number_t *frame)
+{
+	//the page leaves the frame to the others, one of which the frame is now known by
+	frame_number_t shared = *frame;
+	const frameval_t *source = frames->contents[shared];
+	dedup_remove(frames->dedup, shared, components->tag);
+	frames->page_for_frame[shared] = dedup_pages(frames->dedup, shared)[0];
+	page_table_unmap(page_table, components->tag);
+	tlb_invalidate(tlb, components->tag);
+
+	//the copy takes a frame like any page brought in, which may evict the very frame it is copied
+	//from, whose contents are still there to copy
+	status_t error;
+	frame_number_t copy;
+	if ((error = frame_table_allocate(page_table, components, frames, tlb, &copy)) != SUCCESS)
+	{
+		return error;
+	}
+	frames->contents[copy] = frames->table + (size_t) copy * geometry.page_bytes;
+	if (frames->contents[copy] != source)
+	{
+		memcpy(frames->contents[copy], source, geometry.page_bytes);
+	}
+
+	if (page_table_map(page_table, components->tag, copy) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	frames->page_for_frame[copy] = components->tag;
+	size_t partition = frame_table_partition(frames, components->tag);
+	policy_insert(&frames->policies[partition], copy - frames->first_frame[partition], components->tag, 1);
+	tlb_insert(tlb, components->tag, copy, 1);
+	frames->dedup->statistics.copies++;
+	*frame = copy;
+	return dedup_add(frames->dedup, copy, components->tag);
+}
+
+static status_t frame_table_evict(page_table_t *page_table, frame_table_t *frames, tlb_t *tlb, frame_number_t frame, process_t process)
+{
+	//invalidate the page previously at the frame, which may belong to another process. When
+	//both the TLB and the frame table use LRU the page cannot be in the TLB, since it would
+	//have been used more recently than number_frames pages ago, but with any other pair of
+	//policies it may be. The TLBs of other cores are asked to remove it themselves
+	page_number_t prev_tag = frames->page_for_frame[frame];
+	process_t prev_process = prev_tag >> geometry.page_bits;
+	page_entry_t *prev_entry = page_table_find(page_table, prev_tag, NULL);
+	page_table_unmap(page_table, prev_tag);
+	if (prev_entry->prefetched)
+	{
+		statistics[prev_process].prefetch_wasted++;
+		prev_entry->prefetched = 0;
+	}
+	if (prev_entry->filled)
+	{
+		statistics[prev_process].huge_wasted++;
+		prev_entry->filled = 0;
+	}
+
+	//evicting any page of a huge page splits it back into base pages, whose translation goes too
+	page_number_t prev_huge = INVALID_PAGE;
+	if (frames->huge != NULL && huge_pages_unmap(frames->huge, prev_tag >> geometry.huge_shift) == HUGE_MAPPED)
+	{
+		statistics[prev_process].demotions++;
+		prev_huge = HUGE_TAG_BIT | (prev_tag >> geometry.huge_shift);
+	}
+	size_t core;
+	for (core = 0; core < frames->number_tlbs; core++)
+	{
+		if (&frames->tlbs[core] == tlb)
+		{
+			tlb_invalidate(tlb, prev_tag);
+			if (prev_huge != INVALID_PAGE)
+			{
+				tlb_invalidate(tlb, prev_huge);
+			}
+		}
+		else
+		{
+			tlb_shootdown(&frames->tlbs[core], prev_tag);
+			statistics[process].shootdowns++;
+			if (prev_huge != INVALID_PAGE)
+			{
+				tlb_shootdown(&frames->tlbs[core], prev_huge);
+				statistics[process].shootdowns++;
+			}
+		}
+	}
+
+	//any other pages sharing the frame leave with it. They are all clean, since a page is given a
+	//frame of its own before it is written
+	if (frames->dedup != NULL)
+	{
+		const uint64_t *pages = dedup_pages(frames->dedup, frame);
+		uint32_t i;
+		for (i = 0; i < dedup_count(frames->dedup, frame); i++)
+		{
+			if (pages[i] != prev_tag)
+			{
+				page_table_unmap(page_table, pages[i]);
+				tlb_invalidate(tlb, pages[i]);
+			}
+		}
+		dedup_clear(frames->dedup, frame);
+	}
+
+	//the pool takes the page in place of the backing store, so a dirty page kept there is only
+	//written back once the pool pushes it out in turn
+	status_t error;
+	uint8_t stored = 0;
+	if (frames->zswap != NULL && (error = zswap_store(frames->zswap, prev_tag, frames->contents[frame], prev_entry->dirty, &stored, write_back_swapped, frames)) != SUCCESS)
+	{
+		return error;
+	}
+	if (!stored && prev_entry->dirty && (error = frame_table_write_back(frames, prev_tag, frames->contents[frame])) != SUCCESS)
+	{
+		return error;
+	}
+
+	if (frames->resident != NULL)
+	{
+		resident_set_remove(frames->resident, frame);
+	}
+
+	return SUCCESS;
+}
+
+static status_t frame_table_write_back(frame_table_t *frames, page_number_t tag, const frameval_t *contents)
+{
+	statistics[tag >> geometry.page_bits].write_backs++;
+	if (frames->write_back != NULL)
+	{
+		status_t error;
+		uint64_t start = instrument_start(instrument);
+		if ((error = write_back_page(frames->write_back, tag & geometry.max_page_number, contents)) != SUCCESS)
+		{
+			return error;
+		}
+		instrument_stop(instrument, PROBE_IO, start);
+	}
+
+	return SUCCESS;
+}
+
+static status_t frame_table_resize(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, frame_number_t frame, uint8_t faulted)
+{
+	uint64_t cutoff = resident_set_reference(frames->resident, components->process, frame, faulted);
+	int32_t expired;
+	while (cutoff > 0 && (expired = resident_set_expired(frames->resident, components->process, cutoff)) != RESIDENT_NONE)
+	{
+		//a frame released joins the one free list any partition allocates from, which is why
+		//check_resident keeps resident sets to a single partition
+		size_t partition = frame_table_partition(frames, frames->page_for_frame[expired]);
+		status_t error;
+		if ((error = frame_table_evict(page_table, frames, tlb, expired, components->process)) != SUCCESS)
+		{
+			return error;
+		}
+		policy_remove(&frames->policies[partition], expired - frames->first_frame[partition]);
+		frames->free_frames[frames->number_free++] = expired;
+		frames->resident->processes[components->process].released++;
+	}
+
+	return SUCCESS;
+}
+
+static status_t frame_table_prefetch(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, backing_store_t *backing)
+{
+	uint64_t predicted[MAX_PREFETCH_DEGREE];
+	size_t count = prefetch_observe(frames->prefetch, components->process, components->page, geometry.number_pages, predicted);
+
+	size_t i;
+	for (i = 0; i < count; i++)
+	{
+		virtual_components_t ahead = { components->process, predicted[i], 0, 0 };
+		ahead.tag = ((page_number_t) ahead.process << geometry.page_bits) | ahead.page;
+		page_entry_t *entry = page_table_find(page_table, ahead.tag, NULL);
+		if (entry != NULL && entry->valid)
+		{
+			continue;
+		}
+
+		statistics[ahead.process].prefetches++;
+		status_t error;
+		if ((error = frame_table_load(page_table, &ahead, frames, tlb, backing, 0, 1)) != SUCCESS)
+		{
+			return error;
+		}
+	}
+
+	return SUCCESS;
+}
+
+static status_t frame_table_promote(page_table_t *page_table, virtual_components_t *components, frame_table_t *frames, tlb_t *tlb, backing_store_t *backing)
+{
+	page_number_t region = components->tag >> geometry.huge_shift;
+	if (!huge_pages_begin(frames->huge, region))
+	{
+		return SUCCESS;
+	}
+
+	//read in the pages of the huge page which are missing, as the kernel does when it collapses
+	//base pages into a huge page, stopping if that evicts any of its pages
+	page_number_t first = region << geometry.huge_shift;
+	size_t i;
+	for (i = 0; i < frames->huge->pages && huge_pages_state(frames->huge, region) == HUGE_PROMOTING; i++)
+	{
+		virtual_components_t fill = { components->process, (first + i) & geometry.max_page_number, first + i, 0 };
+		page_entry_t *entry = page_table_find(page_table, fill.tag, NULL);
+		if (entry != NULL && entry->valid)
+		{
+			continue;
+		}
+
+		statistics[fill.process].huge_fills++;
+		status_t error;
+		if ((error = frame_table_load(page_table, &fill, frames, tlb, backing, 0, 0)) != SUCCESS)
+		{
+			return error;
+		}
+		page_table_find(page_table, fill.tag, NULL)->filled = 1;
+	}
+
+	if (!huge_pages_finish(frames->huge, region))
+	{
+		return SUCCESS;
+	}
+	statistics[components->process].promotions++;
+
+	//the translations of the base pages are replaced by the one of the huge page, which the next
+	//reference to it walks the page table for
+	size_t core;
+	for (core = 0; core < frames->number_tlbs; core++)
+	{
+		for (i = 0; i < frames->huge->pages; i++)
+		{
+			tlb_invalidate(&frames->tlbs[core], first + i);
+		}
+	}
+
+	return SUCCESS;
+}
+
+static void frame_table_count_unreferenced(frame_table_t *frames, page_table_t *page_table, statistics_t *counted, uint8_t by_process)
+{
+	//a released frame still holds the tag of its last page, which may since be in another frame
+	size_t partition;
+	for (partition = 0; partition < frames->partitions; partition++)
+	{
+		frame_number_t frame;
+		for (frame = frames->first_frame[partition]; frame < frames->first_frame[partition] + frames->used_frames[partition]; frame++)
+		{
+			page_number_t tag = frames->page_for_frame[frame];
+			page_entry_t *entry = page_table_find(page_table, tag, NULL);
+			if (entry != NULL && entry->valid && entry->frame == frame && entry->filled)
+			{
+				counted[by_process ? tag >> geometry.page_bits : 0].huge_wasted++;
+			}
+		}
+	}
+}
+
+static status_t frame_table_save(frame_table_t *frames, page_table_t *page_table, snapshot_writer_t *writer)
+{
+	page_number_t *tags;
+	if ((tags = malloc(geometry.number_frames * sizeof *tags)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	//the frames of each partition are used from its first, so those in use are the first
+	//used_frames[partition] of them
+	snapshot_write(writer, frames->used_frames, frames->partitions * sizeof *frames->used_frames);
+	size_t count = 0;
+	size_t partition;
+	for (partition = 0; partition < frames->partitions; partition++)
+	{
+		frame_number_t frame;
+		for (frame = frames->first_frame[partition]; frame < frames->first_frame[partition] + frames->used_frames[partition]; frame++)
+		{
+			tags[count++] = frames->page_for_frame[frame];
+			snapshot_write(writer, &frames->page_for_frame[frame], sizeof *frames->page_for_frame);
+			snapshot_write(writer, frames->contents[frame], geometry.page_bytes);
+		}
+	}
+	page_table_save(page_table, tags, count, geometry.number_frames, writer);
+	free(tags);
+
+	status_t error;
+	for (partition = 0; partition < frames->partitions; partition++)
+	{
+		if ((error = policy_save(&frames->policies[partition], writer)) != SUCCESS)
+		{
+			return error;
+		}
+	}
+	return SUCCESS;
+}
+
+static status_t frame_table_restore(frame_table_t *frames, page_table_t *page_table, backing_store_t *backing, snapshot_reader_t *reader)
+{
+	page_number_t *tags;
+	uint8_t *occupied;
+	if ((tags = malloc(geometry.number_frames * sizeof *tags)) == NULL ||
+		(occupied = calloc(geometry.number_frames, sizeof *occupied)) == NULL)
+	{
+		free(tags);
+		return ALOC_ERROR;
+	}
+
+	snapshot_read(reader, frames->used_frames, frames->partitions * sizeof *frames->used_frames);
+	status_t error = SUCCESS;
+	size_t count = 0;
+	size_t partition;
+	for (partition = 0; partition < frames->partitions && error == SUCCESS; partition++)
+	{
+		if (frames->used_frames[partition] > frames->first_frame[partition + 1] - frames->first_frame[partition])
+		{
+			error = FORM_ERROR;
+			break;
+		}
+
+		frame_number_t frame;
+		for (frame = frames->first_frame[partition]; frame < frames->first_frame[partition] + frames->used_frames[partition]; frame++)
+		{
+			const frameval_t *contents;
+			snapshot_read(reader, &frames->page_for_frame[frame], sizeof *frames->page_for_frame);
+			page_number_t tag = frames->page_for_frame[frame];
+			if ((contents = snapshot_section(reader, geometry.page_bytes)) == NULL || (tag & ~geometry.tag_mask) != 0 ||
+				(tag >> geometry.page_bits) >= geometry.number_processes)
+			{
+				error = FORM_ERROR;
+				break;
+			}
+
+			tags[count++] = tag;
+			occupied[frame] = 1;
+			if (frames->write_back != NULL || (frames->contents[frame] = backing_store_page(backing, frames->page_for_frame[frame] & geometry.max_page_number)) == NULL)
+			{
+				frames->contents[frame] = frames->table + (size_t) frame * geometry.page_bytes;
+				memcpy(frames->contents[frame], contents, geometry.page_bytes);
+			}
+		}
+	}
+	if (error == SUCCESS)
+	{
+		error = page_table_restore(page_table, tags, count, geometry.number_frames, reader);
+	}
+	free(tags);
+
+	//a page mapped to any frame but the one holding it, or held in two frames, would be evicted
+	//from the wrong one
+	for (partition = 0; partition < frames->partitions && error == SUCCESS; partition++)
+	{
+		frame_number_t frame;
+		for (frame = frames->first_frame[partition]; frame < frames->first_frame[partition] + frames->used_frames[partition]; frame++)
+		{
+			page_entry_t *entry = page_table_find(page_table, frames->page_for_frame[frame], NULL);
+			if (entry == NULL || !entry->valid || entry->frame != frame)
+			{
+				error = FORM_ERROR;
+				break;
+			}
+		}
+	}
+
+	for (partition = 0; partition < frames->partitions && error == SUCCESS; partition++)
+	{
+		error = policy_restore(&frames->policies[partition], reader, occupied + frames->first_frame[partition]);
+	}
+	free(occupied);
+	return error == SUCCESS ? reader->error : error;
+}
+
+static frameval_t get_value_at_address(frame_table_t *frames, physical_address_t phys_addr)
+{
+	return frames->contents[phys_addr >> geometry.offset_bits][phys_addr & geometry.max_offset];
+}
+
+static void set_value_at_address(frame_table_t *frames, physical_address_t phys_addr, frameval_t value)
+{
+	frames->contents[phys_addr >> geometry.offset_bits][phys_addr & geometry.max_offset] = value;
+}
+
+static status_t frame_table_flush(frame_table_t *frames, page_table_t *page_table)
+{
+	size_t partition;
+	for (partition = 0; partition < frames->partitions; partition++)
+	{
+		frame_number_t frame;
+		for (frame = frames->first_frame[partition]; frame < frames->first_frame[partition] + frames->used_frames[partition]; frame++)
+		{
+			page_number_t tag = frames->page_for_frame[frame];
+			page_entry_t *entry = page_table_find(page_table, tag, NULL);
+			if (entry == NULL || !entry->valid || entry->frame != frame || !entry->dirty)
+			{
+				continue;
+			}
+
+			status_t error;
+			uint64_t start = instrument_start(instrument);
+			if ((error = write_back_page(frames->write_back, tag & geometry.max_page_number, frames->contents[frame])) != SUCCESS)
+			{
+				return error;
+			}
+			instrument_stop(instrument, PROBE_IO, start);
+		}
+	}
+
+	if (frames->zswap != NULL)
+	{
+		return zswap_flush(frames->zswap, flush_swapped, frames);
+	}
+
+	return SUCCESS;
+}
+
+static status_t write_back_swapped(void *context, uint64_t tag, const int8_t *contents)
+{
+	return frame_table_write_back(context, tag, contents);
+}
+
+static status_t flush_swapped(void *context, uint64_t tag, const int8_t *contents)
+{
+	frame_table_t *frames = context;
+	status_t error;
+	uint64_t start = instrument_start(instrument);
+	if ((error = write_back_page(frames->write_back, tag & geometry.max_page_number, contents)) != SUCCESS)
+	{
+		return error;
+	}
+	instrument_stop(instrument, PROBE_IO, start);
+	return SUCCESS;
+}
+
+static status_t tlb_initialize(tlb_t *tlb, const char *policy)
+{
+	size_t slots = geometry.tlb_sets * geometry.tlb_stride;
+	tlb->tags = aligned_alloc(TLB_LANES * sizeof *tlb->tags, slots * sizeof *tlb->tags);
+	tlb->frames = malloc(slots * sizeof *tlb->frames);
+	tlb->free_entries = malloc(geometry.tlb_entries * sizeof *tlb->free_entries);
+	tlb->free_count = malloc(geometry.tlb_sets * sizeof *tlb->free_count);
+	tlb->policies = malloc(geometry.tlb_sets * sizeof *tlb->policies);
+	if (tlb->tags == NULL || tlb->frames == NULL || tlb->free_entries == NULL || tlb->free_count == NULL || tlb->policies == NULL)
+	{
+		free(tlb->tags);
+		free(tlb->frames);
+		free(tlb->free_entries);
+		free(tlb->free_count);
+		free(tlb->policies);
+		tlb->policies = NULL;
+		return ALOC_ERROR;
+	}
+
+	if (policy == NULL)
+	{
+		policy = geometry.tlb_sets == 1 ? DEFAULT_POLICY : DEFAULT_SET_POLICY;
+	}
+
+	status_t error = SUCCESS;
+	size_t set;
+	for (set = 0; set < geometry.tlb_sets; set++)
+	{
+		if ((error = policy_initialize(&tlb->policies[set], policy, geometry.tlb_ways)) != SUCCESS)
+		{
+			while (set-- > 0)
+			{
+				policy_uninitialize(&tlb->policies[set]);
+			}
+			free(tlb->tags);
+			free(tlb->frames);
+			free(tlb->free_entries);
+			free(tlb->free_count);
+			free(tlb->policies);
+			tlb->policies = NULL;
+			return error;
+		}
+
+		//every entry starts out free, stacked so that they are handed out from way 0 upwards
+		size_t way;
+		for (way = 0; way < geometry.tlb_stride; way++)
+		{
+			tlb->tags[set * geometry.tlb_stride + way] = INVALID_PAGE;
+		}
+		for (way = 0; way < geometry.tlb_ways; way++)
+		{
+			tlb->free_entries[set * geometry.tlb_ways + way] = geometry.tlb_ways - way - 1;
+		}
+		tlb->free_count[set] = geometry.tlb_ways;
+	}
+
+	pthread_mutex_init(&tlb->shootdown_lock, NULL);
+	tlb->pending = 0;
+	return SUCCESS;
+}
+
+static void tlb_uninitialize(tlb_t *tlb)
+{
+	//a TLB which never finished initializing has nothing left to free
+	if (tlb->policies == NULL)
+	{
+		return;
+	}
+
+	size_t set;
+	for (set = 0; set < geometry.tlb_sets; set++)
+	{
+		policy_uninitialize(&tlb->policies[set]);
+	}
+	pthread_mutex_destroy(&tlb->shootdown_lock);
+	free(tlb->policies);
+	free(tlb->free_count);
+	free(tlb->free_entries);
+	free(tlb->frames);
+	free(tlb->tags);
+}
+
+static int tlb_find(tlb_t *tlb, page_number_t tag)
+{
+	size_t base = (tag & (geometry.tlb_sets - 1)) * geometry.tlb_stride;
+	const page_number_t *tags = tlb->tags + base;
+	size_t way;
+#if defined(__AVX2__)
+	__m256i key = _mm256_set1_epi64x(tag);
+	for (way = 0; way < geometry.tlb_stride; way += 4)
+	{
+		__m256i found = _mm256_cmpeq_epi64(_mm256_load_si256((const __m256i *) (tags + way)), key);
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(found));
+		if (mask != 0)
+		{
+			return base + way + __builtin_ctz(mask);
+		}
+	}
+#elif defined(__SSE2__)
+	//SSE2 can only compare 32 bits at a time, so a tag matches where both of its halves do
+	__m128i key = _mm_set1_epi64x(tag);
+	for (way = 0; way < geometry.tlb_stride; way += 2)
+	{
+		__m128i halves = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *) (tags + way)), key);
+		__m128i found = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+		int mask = _mm_movemask_pd(_mm_castsi128_pd(found));
+		if (mask != 0)
+		{
+			return base + way + __builtin_ctz(mask);
+		}
+	}
+#else
+	for (way = 0; way < geometry.tlb_ways; way++)
+	{
+		if (tags[way] == tag)
+		{
+			return base + way;
+		}
+	}
+#endif
+
+	return TLB_MISS;
+}
+
+static int get_frame_from_tlb(tlb_t *tlb, page_number_t tag, frame_number_t *frame)
+{
+	int entry;
+	if ((entry = tlb_find(tlb, tag)) != TLB_MISS)
+	{
+		statistics[tag >> geometry.page_bits].tlb_hits++;
+		*frame = tlb->frames[entry];
+	}
+
+	return entry;
+}
+
+static int get_frame_from_huge_tlb(tlb_t *tlb, page_table_t *page_table, virtual_components_t *components, frame_number_t *frame)
+{
+	int entry;
+	if ((entry = tlb_find(tlb, HUGE_TAG_BIT | (components->tag >> geometry.huge_shift))) != TLB_MISS)
+	{
+		page_entry_t *page = page_table_find(page_table, components->tag, NULL);
+		*frame = page->frame;
+		page->filled = 0;
+		statistics[components->process].tlb_hits++;
+		statistics[components->process].huge_tlb_hits++;
+	}
+
+	return entry;
+}
+
+static void tlb_hit(tlb_t *tlb, int entry, uint8_t is_write)
+{
+	policy_hit(&tlb->policies[entry / geometry.tlb_stride], entry % geometry.tlb_stride, is_write);
+}
+
+static void tlb_insert(tlb_t *tlb, page_number_t tag, frame_number_t frame, uint8_t is_write)
+{
+	size_t set = tag & (geometry.tlb_sets - 1);
+	int way;
+	if (tlb->free_count[set] > 0)
+	{
+		way = tlb->free_entries[set * geometry.tlb_ways + --tlb->free_count[set]];
+	}
+	else
+	{
+		way = policy_victim(&tlb->policies[set], tag);
+	}
+
+	int entry = set * geometry.tlb_stride + way;
+	tlb->tags[entry] = tag;
+	tlb->frames[entry] = frame;
+	policy_insert(&tlb->policies[set], way, tag, is_write);
+}
+
+static void tlb_invalidate(tlb_t *tlb, page_number_t tag)
+{
+	int entry;
+	if ((entry = tlb_find(tlb, tag)) != TLB_MISS)
+	{
+		size_t set = entry / geometry.tlb_stride;
+		int way = entry % geometry.tlb_stride;
+		tlb->tags[entry] = INVALID_PAGE;
+		policy_remove(&tlb->policies[set], way);
+		tlb->free_entries[set * geometry.tlb_ways + tlb->free_count[set]++] = way;
+	}
+}
+
+static void tlb_flush(tlb_t *tlb)
+{
+	size_t set;
+	for (set = 0; set < geometry.tlb_sets; set++)
+	{
+		size_t way;
+		for (way = 0; way < geometry.tlb_ways; way++)
+		{
+			int entry = set * geometry.tlb_stride + way;
+			if (tlb->tags[entry] != INVALID_PAGE)
+			{
+				tlb->tags[entry] = INVALID_PAGE;
+				policy_remove(&tlb->policies[set], way);
+				tlb->free_entries[set * geometry.tlb_ways + tlb->free_count[set]++] = way;
+			}
+		}
+	}
+}
+
+static void tlb_shootdown(tlb_t *tlb, page_number_t tag)
+{
+	pthread_mutex_lock(&tlb->shootdown_lock);
+	if (tlb->pending < TLB_SHOOTDOWNS)
+	{
+		tlb->shootdowns[tlb->pending] = tag;
+	}
+	__atomic_store_n(&tlb->pending, tlb->pending + 1, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&tlb->shootdown_lock);
+}
+
+static void tlb_drain(tlb_t *tlb)
+{
+	//nearly every reference finds nothing queued, which is checked without taking the lock
+	if (__atomic_load_n(&tlb->pending, __ATOMIC_ACQUIRE) == 0)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&tlb->shootdown_lock);
+	if (tlb->pending > TLB_SHOOTDOWNS)
+	{
+		tlb_flush(tlb);
+	}
+	else
+	{
+		size_t i;
+		for (i = 0; i < tlb->pending; i++)
+		{
+			tlb_invalidate(tlb, tlb->shootdowns[i]);
+		}
+	}
+	tlb->pending = 0;
+	pthread_mutex_unlock(&tlb->shootdown_lock);
+}
+
+static size_t tlb_reach(tlb_t *tlb, size_t *huge_entries)
+{
+	size_t entries = 0;
+	*huge_entries = 0;
+	size_t set;
+	for (set = 0; set < geometry.tlb_sets; set++)
+	{
+		size_t way;
+		for (way = 0; way < geometry.tlb_ways; way++)
+		{
+			page_number_t tag = tlb->tags[set * geometry.tlb_stride + way];
+			if (tag == INVALID_PAGE)
+			{
+				continue;
+			}
+			entries++;
+			if (tag & HUGE_TAG_BIT)
+			{
+				(*huge_entries)++;
+			}
+		}
+	}
+
+	return (entries - *huge_entries) * geometry.page_bytes + (*huge_entries << geometry.huge_shift) * geometry.page_bytes;
+}
+
+static status_t tlb_save(tlb_t *tlb, snapshot_writer_t *writer)
+{
+	size_t slots = geometry.tlb_sets * geometry.tlb_stride;
+	snapshot_write(writer, tlb->tags, slots * sizeof *tlb->tags);
+	snapshot_write(writer, tlb->frames, slots * sizeof *tlb->frames);
+	snapshot_write(writer, tlb->free_entries, geometry.tlb_entries * sizeof *tlb->free_entries);
+	snapshot_write(writer, tlb->free_count, geometry.tlb_sets * sizeof *tlb->free_count);
+
+	status_t error;
+	size_t set;
+	for (set = 0; set < geometry.tlb_sets; set++)
+	{
+		if ((error = policy_save(&tlb->policies[set], writer)) != SUCCESS)
+		{
+			return error;
+		}
+	}
+	return SUCCESS;
+}
+
+static status_t tlb_restore(tlb_t *tlb, page_table_t *page_table, snapshot_reader_t *reader)
+{
+	size_t slots = geometry.tlb_sets * geometry.tlb_stride;
+	snapshot_read(reader, tlb->tags, slots * sizeof *tlb->tags);
+	snapshot_read(reader, tlb->frames, slots * sizeof *tlb->frames);
+	snapshot_read(reader, tlb->free_entries, geometry.tlb_entries * sizeof *tlb->free_entries);
+	snapshot_read(reader, tlb->free_count, geometry.tlb_sets * sizeof *tlb->free_count);
+
+	uint8_t *occupied;
+	if ((occupied = malloc(2 * geometry.tlb_ways * sizeof *occupied)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	uint8_t *listed = occupied + geometry.tlb_ways;
+
+	status_t error = SUCCESS;
+	size_t set;
+	for (set = 0; set < geometry.tlb_sets && error == SUCCESS; set++)
+	{
+		//the padding past the ways is never filled, and every entry in use must be a translation the
+		//page table would give for a page of the set
+		memset(occupied, 0, 2 * geometry.tlb_ways * sizeof *occupied);
+		size_t in_use = 0;
+		size_t way;
+		for (way = 0; way < geometry.tlb_stride; way++)
+		{
+			size_t entry = set * geometry.tlb_stride + way;
+			page_number_t tag = tlb->tags[entry];
+			if (tag == INVALID_PAGE)
+			{
+				continue;
+			}
+
+			page_entry_t *page;
+			if (way >= geometry.tlb_ways || (tag & ~geometry.tag_mask) != 0 || (tag >> geometry.page_bits) >= geometry.number_processes ||
+				(tag & (geometry.tlb_sets - 1)) != set || (page = page_table_find(page_table, tag, NULL)) == NULL || !page->valid ||
+				page->frame != tlb->frames[entry])
+			{
+				error = FORM_ERROR;
+				break;
+			}
+			occupied[way] = 1;
+			in_use++;
+		}
+
+		//the free entries are the rest of the ways, each listed once
+		int free_count = tlb->free_count[set];
+		if (error == SUCCESS && (free_count < 0 || (size_t) free_count != geometry.tlb_ways - in_use))
+		{
+			error = FORM_ERROR;
+		}
+		int i;
+		for (i = 0; i < free_count && error == SUCCESS; i++)
+		{
+			int free_way = tlb->free_entries[set * geometry.tlb_ways + i];
+			if (free_way < 0 || (size_t) free_way >= geometry.tlb_ways || occupied[free_way] || listed[free_way])
+			{
+				error = FORM_ERROR;
+			}
+			else
+			{
+				listed[free_way] = 1;
+			}
+		}
+
+		if (error == SUCCESS)
+		{
+			error = policy_restore(&tlb->policies[set], reader, occupied);
+		}
+	}
+	free(occupied);
+	return error == SUCCESS ? reader->error : error;
+}
+
+static physical_address_t get_physical_address(frame_number_t frame, offset_t offset)
+{
+	return (physical_address_t) frame * geometry.page_bytes + offset;
+}
+
+static status_t write_instrumentation(instrument_t *recorded, const char *path)
+{
+	FILE *fout;
+	if ((fout = fopen(path, "w")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+
+	status_t error = instrument_write_json(recorded, fout, geometry.page_bits);
+	if (fclose(fout) != 0 && error == SUCCESS)
+	{
+		error = WRIT_ERROR;
+	}
+	return error;
+}
@@ -0,0 +1,97 @@
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/mrc.h"
+#include "../include/stack_distance.h"
+#include "../include/trace.h"
+
+#define MIN_HISTOGRAM 1024
+
+status_t mrc_run(trace_file_t *fin, unsigned int offset_bits, uint64_t page_mask, FILE *out)
+{
+	status_t error;
+	stack_distance_t sd;
+	if ((error = stack_distance_initialize(&sd)) != SUCCESS)
+	{
+		return error;
+	}
+
+	//histogram[d] counts the references with stack distance d; first references are counted apart
+	size_t capacity = MIN_HISTOGRAM;
+	uint64_t *histogram = calloc(capacity, sizeof *histogram);
+	if (histogram == NULL)
+	{
+		stack_distance_uninitialize(&sd);
+		return ALOC_ERROR;
+	}
+	uint64_t translated = 0;
+	uint64_t cold = 0;
+
+	trace_t trace;
+	trace_initialize(&trace);
+	while ((error = trace_read(&trace, fin, TRACE_BATCH)) == SUCCESS && trace.length > 0)
+	{
+		size_t i;
+		for (i = 0; i < trace.length; i++)
+		{
+			uint64_t distance;
+			if ((error = stack_distance_access(&sd, (trace.addresses[i] >> offset_bits) & page_mask, &distance)) != SUCCESS)
+			{
+				break;
+			}
+
+			translated++;
+			if (distance == STACK_DISTANCE_INFINITE)
+			{
+				cold++;
+				continue;
+			}
+
+			if (distance >= capacity)
+			{
+				//a distance is always less than the number of distinct pages, so doubling suffices
+				uint64_t *grown = realloc(histogram, 2 * capacity * sizeof *grown);
+				if (grown == NULL)
+				{
+					error = ALOC_ERROR;
+					break;
+				}
+				memset(grown + capacity, 0, capacity * sizeof *grown);
+				histogram = grown;
+				capacity *= 2;
+			}
+			histogram[distance]++;
+		}
+
+		if (error != SUCCESS)
+		{
+			break;
+		}
+	}
+	trace_uninitialize(&trace);
+
+	if (error == SUCCESS)
+	{
+		//a frame table of size s faults on the first references and on every distance of at least
+		//s, while a TLB of size s hits on every distance below s
+		fprintf(out, "Number of Translated Addresses = %" PRIu64 "\n", translated);
+		fprintf(out, "Distinct Pages = %" PRIu64 "\n", cold);
+		fprintf(out, "Size Page_Faults Fault_Rate TLB_Hits TLB_Hit_Ratio\n");
+
+		uint64_t faults = translated;
+		uint64_t hits = 0;
+		uint64_t size;
+		for (size = 1; size <= cold; size++)
+		{
+			uint64_t count = size - 1 < capacity ? histogram[size - 1] : 0;
+			faults -= count;
+			hits += count;
+			fprintf(out, "%" PRIu64 " %" PRIu64 " %lf %" PRIu64 " %lf\n", size, faults, (double) faults / translated, hits, (double) hits / translated);
+		}
+	}
+
+	free(histogram);
+	stack_distance_uninitialize(&sd);
+	return error;
+}
@@ -0,0 +1,750 @@
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../include/codec.h"
+#include "../include/memmgr.h"
+#include "../include/options.h"
+#include "../include/pipeline.h"
+#include "../include/policy.h"
+#include "../include/prefetch.h"
+#include "../include/work_pool.h"
+
+#define MIN_POSITIONAL 2
+
+/**
+  * Values identifying the options which have no short form
+  */
+#define OPTION_TLB_POLICY   256
+#define OPTION_MRC          257
+#define OPTION_BACKING      258
+#define OPTION_OUTPUT       259
+#define OPTION_STATS_ONLY   260
+#define OPTION_TLB_WAYS     261
+#define OPTION_QUANTUM      262
+#define OPTION_SCOPE        263
+#define OPTION_TLB_FLUSH    264
+#define OPTION_CORES        265
+#define OPTION_WRITE_BACK   266
+#define OPTION_STORE_COPY   267
+#define OPTION_PREFETCH     268
+#define OPTION_IO_WORKERS   269
+#define OPTION_PAGE_TABLE   270
+#define OPTION_HUGE_PAGES   271
+#define OPTION_PROMOTE      272
+#define OPTION_INSTRUMENT   273
+#define OPTION_RESIDENT     274
+#define OPTION_WINDOW       275
+#define OPTION_ZSWAP        276
+#define OPTION_CODEC        277
+#define OPTION_SWEEP_FRAMES 278
+#define OPTION_SWEEP_TLB    279
+#define OPTION_SWEEP_POLICY 280
+#define OPTION_THREADS      281
+#define OPTION_REPORT_EVERY 282
+#define OPTION_REPORT_TIME  283
+#define OPTION_SNAPSHOT     284
+#define OPTION_RESTORE      285
+#define OPTION_DEDUP        286
+
+/**
+  * The long command line options. Every option except config and help can also be given in a
+  * configuration file under the same name
+  */
+static const struct option long_options[] =
+{
+	{ "page-bytes",   required_argument, NULL, 'p' },
+	{ "frames",       required_argument, NULL, 'f' },
+	{ "address-bits", required_argument, NULL, 'a' },
+	{ "tlb-entries",  required_argument, NULL, 't' },
+	{ "policy",       required_argument, NULL, 'r' },
+	{ "tlb-ways",     required_argument, NULL, OPTION_TLB_WAYS },
+	{ "tlb-policy",   required_argument, NULL, OPTION_TLB_POLICY },
+	{ "mrc",          no_argument,       NULL, OPTION_MRC },
+	{ "backing-mode", required_argument, NULL, OPTION_BACKING },
+	{ "write-back",   required_argument, NULL, OPTION_WRITE_BACK },
+	{ "store-copy",   required_argument, NULL, OPTION_STORE_COPY },
+	{ "output",       required_argument, NULL, OPTION_OUTPUT },
+	{ "stats-only",   no_argument,       NULL, OPTION_STATS_ONLY },
+	{ "quantum",      required_argument, NULL, OPTION_QUANTUM },
+	{ "frame-scope",  required_argument, NULL, OPTION_SCOPE },
+	{ "tlb-flush",    no_argument,       NULL, OPTION_TLB_FLUSH },
+	{ "cores",        no_argument,       NULL, OPTION_CORES },
+	{ "prefetch",     required_argument, NULL, OPTION_PREFETCH },
+	{ "io-workers",   required_argument, NULL, OPTION_IO_WORKERS },
+	{ "page-table",   required_argument, NULL, OPTION_PAGE_TABLE },
+	{ "huge-pages",   required_argument, NULL, OPTION_HUGE_PAGES },
+	{ "promote",      required_argument, NULL, OPTION_PROMOTE },
+	{ "instrument",   required_argument, NULL, OPTION_INSTRUMENT },
+	{ "resident-set", required_argument, NULL, OPTION_RESIDENT },
+	{ "window",       required_argument, NULL, OPTION_WINDOW },
+	{ "zswap",        required_argument, NULL, OPTION_ZSWAP },
+	{ "codec",        required_argument, NULL, OPTION_CODEC },
+	{ "dedup",        no_argument,       NULL, OPTION_DEDUP },
+	{ "sweep-frames", required_argument, NULL, OPTION_SWEEP_FRAMES },
+	{ "sweep-tlb",    required_argument, NULL, OPTION_SWEEP_TLB },
+	{ "sweep-policy", required_argument, NULL, OPTION_SWEEP_POLICY },
+	{ "threads",      required_argument, NULL, OPTION_THREADS },
+	{ "report-every", required_argument, NULL, OPTION_REPORT_EVERY },
+	{ "report-time",  required_argument, NULL, OPTION_REPORT_TIME },
+	{ "snapshot",     required_argument, NULL, OPTION_SNAPSHOT },
+	{ "restore",      required_argument, NULL, OPTION_RESTORE },
+	{ "config",       required_argument, NULL, 'c' },
+	{ "help",         no_argument,       NULL, 'h' },
+	{ NULL,           0,                 NULL,  0  }
+};
+
+static const char short_options[] = "p:f:a:t:r:c:h";
+
+/**
+  * Sets a single named option from its string value
+  * @param options the options to update
+  * @param name    the long name of the option
+  * @param value   the string value of the option
+  * @return an indication of whether an error occurred
+  */
+static status_t options_set(options_t *options, const char *name, const char *value);
+
+/**
+  * Converts a string to a size, allowing a K, M or G suffix for powers of 1024
+  * @param s     the string to convert
+  * @param value out param which will hold the converted size
+  * @return an indication of whether an error occurred
+  */
+static status_t parse_size(const char *s, size_t *value);
+
+/**
+  * Converts a string to a positive number of seconds, which may have a fractional part
+  * @param s     the string to convert
+  * @param value out param which will hold the converted number of seconds
+  * @return an indication of whether an error occurred
+  */
+static status_t parse_seconds(const char *s, double *value);
+
+/**
+  * Converts a comma separated list of sizes, each as parse_size takes it
+  * @param s      the string to convert
+  * @param values out param which will hold the newly allocated sizes, replacing any list already
+  *               there
+  * @param count  out param which will hold the number of sizes
+  * @return an indication of whether an error occurred
+  */
+static status_t parse_size_list(const char *s, size_t **values, size_t *count);
+
+/**
+  * Converts a comma separated list of replacement policy names
+  * @param s        the string to convert
+  * @param policies out param which will hold the newly allocated names of the policies, replacing
+  *                 any list already there
+  * @param count    out param which will hold the number of policies
+  * @return an indication of whether an error occurred
+  */
+static status_t parse_policy_list(const char *s, const char ***policies, size_t *count);
+
+/**
+  * Converts a string to an on/off flag. A flag given on the command line has no value, which turns
+  * it on
+  * @param s     the string to convert, or NULL
+  * @param value out param which will hold the flag
+  * @return an indication of whether an error occurred
+  */
+static status_t parse_flag(const char *s, uint8_t *value);
+
+/**
+  * Removes leading and trailing whitespace from a string in place
+  * @param s the string to trim
+  * @return a pointer to the first non-whitespace character of s
+  */
+static char *trim(char *s);
+
+void options_initialize(options_t *options)
+{
+	options->page_bytes = DEFAULT_PAGE_BYTES;
+	options->number_frames = DEFAULT_NUMBER_FRAMES;
+	options->address_bits = DEFAULT_ADDRESS_BITS;
+	options->tlb_entries = DEFAULT_TLB_ENTRIES;
+	options->tlb_ways = 0;
+	options->policy = DEFAULT_POLICY;
+	options->tlb_policy = NULL;
+	options->mrc = 0;
+	options->backing_mode = BACKING_STDIO;
+	options->write_back = WRITE_BACK_NONE;
+	options->store_copy = NULL;
+	options->output_format = OUTPUT_TEXT;
+	options->stats_only = 0;
+	options->quantum = DEFAULT_QUANTUM;
+	options->local_frames = 0;
+	options->tlb_flush = 0;
+	options->cores = 0;
+	options->prefetch_degree = 0;
+	options->io_workers = 0;
+	options->page_table = PAGE_TABLE_AUTO;
+	options->huge_bytes = 0;
+	options->huge_threshold = 0;
+	options->instrument_file = NULL;
+	options->resident_policy = RESIDENT_OFF;
+	options->resident_window = DEFAULT_RESIDENT_WINDOW;
+	options->zswap_bytes = 0;
+	options->codec = DEFAULT_CODEC;
+	options->dedup = 0;
+	options->sweep_frames = NULL;
+	options->number_sweep_frames = 0;
+	options->sweep_tlb = NULL;
+	options->number_sweep_tlb = 0;
+	options->sweep_policies = NULL;
+	options->number_sweep_policies = 0;
+	options->threads = 0;
+	options->report_references = 0;
+	options->report_seconds = 0;
+	options->snapshot_file = NULL;
+	options->restore_file = NULL;
+	options->input_files = NULL;
+	options->number_inputs = 0;
+	options->backing_file = NULL;
+}
+
+status_t options_parse(options_t *options, int argc, char *argv[])
+{
+	int c;
+	int index;
+	while ((c = getopt_long(argc, argv, short_options, long_options, &index)) != -1)
+	{
+		status_t error = SUCCESS;
+		switch (c)
+		{
+			case 'c':
+				error = options_read_config(options, optarg);
+				break;
+			case 'h':
+			case '?':
+				return ARGS_ERROR;
+			default:
+			{
+				//map the short option back onto its long name so both go through options_set
+				const struct option *option;
+				for (option = long_options; option->name != NULL && option->val != c; option++);
+				error = options_set(options, option->name, optarg);
+				break;
+			}
+		}
+
+		if (error != SUCCESS)
+		{
+			return error;
+		}
+	}
+
+	if (argc - optind < MIN_POSITIONAL)
+	{
+		return ARGS_ERROR;
+	}
+	options->input_files = &argv[optind];
+	options->number_inputs = argc - optind - 1;
+	options->backing_file = argv[argc - 1];
+
+	return SUCCESS;
+}
+
+status_t options_read_config(options_t *options, const char *path)
+{
+	FILE *config;
+	if ((config = fopen(path, "r")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+
+	status_t error = SUCCESS;
+	char *line = NULL;
+	size_t size = 0;
+	while (error == SUCCESS && getline(&line, &size, config) > 0)
+	{
+		char *name = trim(line);
+		if (*name == '\0' || *name == '#')
+		{
+			continue;
+		}
+
+		char *value = strchr(name, '=');
+		if (value == NULL)
+		{
+			fprintf(stderr, "%s: %s\n", path, name);
+			error = OPTN_ERROR;
+			break;
+		}
+		*value++ = '\0';
+		error = options_set(options, trim(name), trim(value));
+	}
+
+	free(line);
+	fclose(config);
+	return error;
+}
+
+void options_usage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [options] <address file>... <backing store>\n", program);
+	fprintf(stderr, "  -p, --page-bytes N    bytes per page and frame, a power of two (default %d)\n", DEFAULT_PAGE_BYTES);
+	fprintf(stderr, "  -f, --frames N        number of physical frames (default %d)\n", DEFAULT_NUMBER_FRAMES);
+	fprintf(stderr, "  -a, --address-bits N  width of a virtual address in bits (default %d)\n", DEFAULT_ADDRESS_BITS);
+	fprintf(stderr, "  -t, --tlb-entries N   number of TLB entries (default %d)\n", DEFAULT_TLB_ENTRIES);
+	fprintf(stderr, "  -r, --policy NAME     frame replacement policy (default %s)\n", DEFAULT_POLICY);
+	fprintf(stderr, "      --tlb-ways N      entries in each set of the TLB (default all of them)\n");
+	fprintf(stderr, "      --tlb-policy NAME TLB replacement policy in each set (default %s, or plru when set associative)\n", DEFAULT_POLICY);
+	fprintf(stderr, "      --mrc             print the LRU miss-ratio curve for every size instead\n");
+	fprintf(stderr, "      --backing-mode M  read the backing store with stdio, mmap or zero-copy (default stdio)\n");
+	fprintf(stderr, "      --write-back M    write dirty pages to a copy of the backing store: none, sync or async\n");
+	fprintf(stderr, "      --store-copy FILE where to keep that copy (default a temporary file)\n");
+	fprintf(stderr, "      --output FORMAT   print each reference as text, csv, binary or none (default text)\n");
+	fprintf(stderr, "      --stats-only      print only the statistics, the same as --output none\n");
+	fprintf(stderr, "      --quantum N       references each process runs before the next (default %d)\n", DEFAULT_QUANTUM);
+	fprintf(stderr, "      --frame-scope S   replace frames across all processes (global) or each its own (local)\n");
+	fprintf(stderr, "      --tlb-flush       flush the TLB on every context switch instead of tagging it\n");
+	fprintf(stderr, "      --cores           replay each address file on its own core and thread instead\n");
+	fprintf(stderr, "      --prefetch N      read ahead up to N pages of a sequential or strided run (default 0, off)\n");
+	fprintf(stderr, "      --io-workers N    read upcoming missing pages on N threads while simulating (default 0, off)\n");
+	fprintf(stderr, "      --page-table T    page table design, flat, radix or hashed, and print its costs (default auto)\n");
+	fprintf(stderr, "      --huge-pages N    also map huge pages of N bytes, a power of two (default 0, off)\n");
+	fprintf(stderr, "      --promote N       resident pages of a huge page before it is promoted (default half)\n");
+	fprintf(stderr, "      --instrument FILE write latency histograms, reuse distances and page heat to FILE as JSON\n");
+	fprintf(stderr, "      --resident-set P  size each resident set by working set (ws) or fault frequency (pff), or only report it (fixed)\n");
+	fprintf(stderr, "      --window N        references in the working set window, or between faults for pff (default %d)\n", DEFAULT_RESIDENT_WINDOW);
+	fprintf(stderr, "      --zswap N         keep evicted pages compressed in a pool of N bytes (default 0, off)\n");
+	fprintf(stderr, "      --codec NAME      compress them with lz, or keep only same-filled pages with same (default %s)\n", DEFAULT_CODEC);
+	fprintf(stderr, "      --dedup           share a frame between pages of identical contents, copying on write\n");
+	fprintf(stderr, "      --sweep-frames L  simulate every frame count of the comma separated list L, printing one table\n");
+	fprintf(stderr, "      --sweep-tlb L     simulate every TLB size of the list L in that table\n");
+	fprintf(stderr, "      --sweep-policy L  simulate every replacement policy of the list L in that table\n");
+	fprintf(stderr, "      --threads N       threads a sweep runs on (default one per processor)\n");
+	fprintf(stderr, "      --report-every N  report the statistics of every N references as they stream in (default 0, off)\n");
+	fprintf(stderr, "      --report-time T   report the statistics of every T seconds as they stream in (default 0, off)\n");
+	fprintf(stderr, "      --snapshot FILE   save the whole state of the simulator to FILE once the trace is done\n");
+	fprintf(stderr, "      --restore FILE    start from the state saved in FILE instead of an empty memory\n");
+	fprintf(stderr, "  -c, --config FILE     read \"name = value\" options from FILE\n");
+	fprintf(stderr, "Policies: ");
+	policy_print_names(stderr);
+	fprintf(stderr, "\n");
+}
+
+static status_t options_set(options_t *options, const char *name, const char *value)
+{
+	status_t error = SUCCESS;
+	size_t size = 0;
+	if (strcmp(name, "page-bytes") == 0)
+	{
+		error = parse_size(value, &options->page_bytes);
+	}
+	else if (strcmp(name, "frames") == 0)
+	{
+		error = parse_size(value, &options->number_frames);
+	}
+	else if (strcmp(name, "address-bits") == 0)
+	{
+		//checked before it is narrowed, so that a huge width cannot wrap around to a valid one
+		if ((error = parse_size(value, &size)) == SUCCESS && size > MAX_ADDRESS_BITS)
+		{
+			error = OPTN_ERROR;
+		}
+		if (error == SUCCESS)
+		{
+			options->address_bits = size;
+		}
+	}
+	else if (strcmp(name, "tlb-entries") == 0)
+	{
+		error = parse_size(value, &options->tlb_entries);
+	}
+	else if (strcmp(name, "tlb-ways") == 0)
+	{
+		error = parse_size(value, &options->tlb_ways);
+	}
+	else if (strcmp(name, "policy") == 0 || strcmp(name, "tlb-policy") == 0)
+	{
+		const policy_ops_t *ops;
+		if ((ops = policy_find(value)) == NULL)
+		{
+			error = OPTN_ERROR;
+		}
+		else if (strcmp(name, "policy") == 0)
+		{
+			options->policy = ops->name;
+		}
+		else
+		{
+			options->tlb_policy = ops->name;
+		}
+	}
+	else if (strcmp(name, "mrc") == 0)
+	{
+		error = parse_flag(value, &options->mrc);
+	}
+	else if (strcmp(name, "backing-mode") == 0)
+	{
+		error = backing_mode_find(value, &options->backing_mode);
+	}
+	else if (strcmp(name, "write-back") == 0)
+	{
+		error = write_back_mode_find(value, &options->write_back);
+	}
+	else if (strcmp(name, "store-copy") == 0)
+	{
+		//a value from a configuration file lives in a line buffer which is about to be reused
+		free(options->store_copy);
+		if ((options->store_copy = strdup(value)) == NULL)
+		{
+			error = ALOC_ERROR;
+		}
+	}
+	else if (strcmp(name, "output") == 0)
+	{
+		error = output_format_find(value, &options->output_format);
+	}
+	else if (strcmp(name, "stats-only") == 0)
+	{
+		error = parse_flag(value, &options->stats_only);
+	}
+	else if (strcmp(name, "quantum") == 0)
+	{
+		error = parse_size(value, &options->quantum);
+		if (options->quantum == 0)
+		{
+			error = OPTN_ERROR;
+		}
+	}
+	else if (strcmp(name, "frame-scope") == 0)
+	{
+		if (strcmp(value, "global") == 0)
+		{
+			options->local_frames = 0;
+		}
+		else if (strcmp(value, "local") == 0)
+		{
+			options->local_frames = 1;
+		}
+		else
+		{
+			error = OPTN_ERROR;
+		}
+	}
+	else if (strcmp(name, "tlb-flush") == 0)
+	{
+		error = parse_flag(value, &options->tlb_flush);
+	}
+	else if (strcmp(name, "cores") == 0)
+	{
+		error = parse_flag(value, &options->cores);
+	}
+	else if (strcmp(name, "io-workers") == 0)
+	{
+		error = parse_size(value, &options->io_workers);
+		if (options->io_workers > MAX_PIPELINE_WORKERS)
+		{
+			error = OPTN_ERROR;
+		}
+	}
+	else if (strcmp(name, "prefetch") == 0)
+	{
+		error = parse_size(value, &options->prefetch_degree);
+		if (options->prefetch_degree > MAX_PREFETCH_DEGREE)
+		{
+			error = OPTN_ERROR;
+		}
+	}
+	else if (strcmp(name, "page-table") == 0)
+	{
+		error = page_table_kind_find(value, &options->page_table);
+	}
+	else if (strcmp(name, "huge-pages") == 0)
+	{
+		error = parse_size(value, &options->huge_bytes);
+	}
+	else if (strcmp(name, "promote") == 0)
+	{
+		error = parse_size(value, &options->huge_threshold);
+		if (options->huge_threshold == 0)
+		{
+			error = OPTN_ERROR;
+		}
+	}
+	else if (strcmp(name, "resident-set") == 0)
+	{
+		error = resident_policy_find(value, &options->resident_policy);
+	}
+	else if (strcmp(name, "window") == 0)
+	{
+		error = parse_size(value, &options->resident_window);
+		if (options->resident_window == 0)
+		{
+			error = OPTN_ERROR;
+		}
+	}
+	else if (strcmp(name, "zswap") == 0)
+	{
+		error = parse_size(value, &options->zswap_bytes);
+	}
+	else if (strcmp(name, "codec") == 0)
+	{
+		const codec_ops_t *ops;
+		if ((ops = codec_find(value)) == NULL)
+		{
+			error = OPTN_ERROR;
+		}
+		else
+		{
+			options->codec = ops->name;
+		}
+	}
+	else if (strcmp(name, "dedup") == 0)
+	{
+		error = parse_flag(value, &options->dedup);
+	}
+	else if (strcmp(name, "sweep-frames") == 0)
+	{
+		error = parse_size_list(value, &options->sweep_frames, &options->number_sweep_frames);
+	}
+	else if (strcmp(name, "sweep-tlb") == 0)
+	{
+		error = parse_size_list(value, &options->sweep_tlb, &options->number_sweep_tlb);
+	}
+	else if (strcmp(name, "sweep-policy") == 0)
+	{
+		error = parse_policy_list(value, &options->sweep_policies, &options->number_sweep_policies);
+	}
+	else if (strcmp(name, "threads") == 0)
+	{
+		error = parse_size(value, &options->threads);
+		if (options->threads == 0 || options->threads > MAX_WORK_THREADS)
+		{
+			error = OPTN_ERROR;
+		}
+	}
+	else if (strcmp(name, "report-every") == 0)
+	{
+		error = parse_size(value, &options->report_references);
+	}
+	else if (strcmp(name, "report-time") == 0)
+	{
+		error = parse_seconds(value, &options->report_seconds);
+	}
+	else if (strcmp(name, "instrument") == 0)
+	{
+		free(options->instrument_file);
+		if ((options->instrument_file = strdup(value)) == NULL)
+		{
+			error = ALOC_ERROR;
+		}
+	}
+	else if (strcmp(name, "snapshot") == 0)
+	{
+		free(options->snapshot_file);
+		if ((options->snapshot_file = strdup(value)) == NULL)
+		{
+			error = ALOC_ERROR;
+		}
+	}
+	else if (strcmp(name, "restore") == 0)
+	{
+		free(options->restore_file);
+		if ((options->restore_file = strdup(value)) == NULL)
+		{
+			error = ALOC_ERROR;
+		}
+	}
+	else
+	{
+		fprintf(stderr, "Unknown option: %s\n", name);
+		return OPTN_ERROR;
+	}
+
+	if (error != SUCCESS)
+	{
+		fprintf(stderr, "Invalid value for %s: %s\n", name, value == NULL ? "" : value);
+	}
+	return error;
+}
+
+static status_t parse_size(const char *s, size_t *value)
+{
+	char *end;
+	errno = 0;
+	unsigned long long parsed = strtoull(s, &end, 10);
+	if (end == s || errno != 0 || *s == '-')
+	{
+		return OPTN_ERROR;
+	}
+
+	unsigned int shift = 0;
+	switch (toupper((unsigned char) *end))
+	{
+		case 'G':
+			shift += 10;
+			//fall through
+		case 'M':
+			shift += 10;
+			//fall through
+		case 'K':
+			shift += 10;
+			end++;
+			break;
+	}
+
+	//a size whose suffix would shift bits off the top is refused rather than wrapped
+	if (*end != '\0' || parsed > (SIZE_MAX >> shift))
+	{
+		return OPTN_ERROR;
+	}
+	parsed <<= shift;
+
+	*value = parsed;
+	return SUCCESS;
+}
+
+static status_t parse_seconds(const char *s, double *value)
+{
+	char *end;
+	errno = 0;
+	double parsed = strtod(s, &end);
+	if (end == s || *end != '\0' || errno != 0 || !(parsed > 0))
+	{
+		return OPTN_ERROR;
+	}
+
+	*value = parsed;
+	return SUCCESS;
+}
+
+static status_t parse_size_list(const char *s, size_t **values, size_t *count)
+{
+	//a list of n items has n - 1 commas
+	size_t number = 1;
+	const char *c;
+	for (c = s; *c != '\0'; c++)
+	{
+		number += *c == ',';
+	}
+
+	char *copy = strdup(s);
+	size_t *parsed = malloc(number * sizeof *parsed);
+	if (copy == NULL || parsed == NULL)
+	{
+		free(parsed);
+		free(copy);
+		return ALOC_ERROR;
+	}
+
+	status_t error = SUCCESS;
+	char *item = copy;
+	size_t i;
+	for (i = 0; i < number && error == SUCCESS; i++)
+	{
+		char *comma = strchr(item, ',');
+		if (comma != NULL)
+		{
+			*comma = '\0';
+		}
+		error = parse_size(trim(item), &parsed[i]);
+		item = comma + 1;
+	}
+	free(copy);
+
+	if (error != SUCCESS)
+	{
+		free(parsed);
+		return error;
+	}
+	free(*values);
+	*values = parsed;
+	*count = number;
+	return SUCCESS;
+}
+
+static status_t parse_policy_list(const char *s, const char ***policies, size_t *count)
+{
+	size_t number = 1;
+	const char *c;
+	for (c = s; *c != '\0'; c++)
+	{
+		number += *c == ',';
+	}
+
+	char *copy = strdup(s);
+	const char **parsed = malloc(number * sizeof *parsed);
+	if (copy == NULL || parsed == NULL)
+	{
+		free(parsed);
+		free(copy);
+		return ALOC_ERROR;
+	}
+
+	//the names kept are those of the policies themselves, which outlive the copy
+	status_t error = SUCCESS;
+	char *item = copy;
+	size_t i;
+	for (i = 0; i < number && error == SUCCESS; i++)
+	{
+		char *comma = strchr(item, ',');
+		if (comma != NULL)
+		{
+			*comma = '\0';
+		}
+		const policy_ops_t *ops = policy_find(trim(item));
+		if (ops == NULL)
+		{
+			error = OPTN_ERROR;
+		}
+		else
+		{
+			parsed[i] = ops->name;
+		}
+		item = comma + 1;
+	}
+	free(copy);
+
+	if (error != SUCCESS)
+	{
+		free(parsed);
+		return error;
+	}
+	free(*policies);
+	*policies = parsed;
+	*count = number;
+	return SUCCESS;
+}
+
+static status_t parse_flag(const char *s, uint8_t *value)
+{
+	if (s == NULL || strcmp(s, "1") == 0 || strcasecmp(s, "yes") == 0 || strcasecmp(s, "true") == 0 || strcasecmp(s, "on") == 0)
+	{
+		*value = 1;
+	}
+	else if (strcmp(s, "0") == 0 || strcasecmp(s, "no") == 0 || strcasecmp(s, "false") == 0 || strcasecmp(s, "off") == 0)
+	{
+		*value = 0;
+	}
+	else
+	{
+		return OPTN_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+static char *trim(char *s)
+{
+	while (isspace((unsigned char) *s))
+	{
+		s++;
+	}
+
+	char *end = s + strlen(s);
+	while (end > s && isspace((unsigned char) end[-1]))
+	{
+		end--;
+	}
+	*end = '\0';
+
+	return s;
+}
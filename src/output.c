@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/output.h"
+
+/**
+  * The most bytes that output_reference writes for one reference, which is the text format with
+  * both addresses at their longest
+  */
+#define MAX_REFERENCE_BYTES 96
+
+/**
+  * The decimal digits of every number from 0 to 99, so that numbers are formatted two digits at a
+  * time
+  */
+static const char digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const char text_virtual[] = "Virtual address: ";
+static const char text_physical[] = " Physical address: ";
+static const char text_value[] = " Value: ";
+static const char csv_header[] = "virtual,physical,value\n";
+
+/**
+  * Copies a string without its terminator to the position, returning the position after it
+  */
+static char *put_string(char *p, const char *s, size_t length)
+{
+	memcpy(p, s, length);
+	return p + length;
+}
+
+/**
+  * Formats an unsigned number in decimal at the position, returning the position after it
+  */
+static char *put_unsigned(char *p, uint64_t value)
+{
+	//format from the least significant end into a scratch buffer big enough for 2^64 - 1
+	char digits[20];
+	char *start = digits + sizeof digits;
+	while (value >= 100)
+	{
+		start -= 2;
+		memcpy(start, digit_pairs + 2 * (value % 100), 2);
+		value /= 100;
+	}
+	if (value >= 10)
+	{
+		start -= 2;
+		memcpy(start, digit_pairs + 2 * value, 2);
+	}
+	else
+	{
+		*--start = '0' + value;
+	}
+
+	return put_string(p, start, digits + sizeof digits - start);
+}
+
+/**
+  * Formats a signed number in decimal at the position, returning the position after it
+  */
+static char *put_signed(char *p, int64_t value)
+{
+	if (value < 0)
+	{
+		*p++ = '-';
+		return put_unsigned(p, -(uint64_t) value);
+	}
+	return put_unsigned(p, value);
+}
+
+status_t output_format_find(const char *name, output_format_t *format)
+{
+	if (strcmp(name, "text") == 0)
+	{
+		*format = OUTPUT_TEXT;
+	}
+	else if (strcmp(name, "csv") == 0)
+	{
+		*format = OUTPUT_CSV;
+	}
+	else if (strcmp(name, "binary") == 0)
+	{
+		*format = OUTPUT_BINARY;
+	}
+	else if (strcmp(name, "none") == 0)
+	{
+		*format = OUTPUT_NONE;
+	}
+	else
+	{
+		return OPTN_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+status_t output_initialize(output_t *out, FILE *file, output_format_t format)
+{
+	out->file = file;
+	out->format = format;
+	out->length = 0;
+	out->error = SUCCESS;
+	if ((out->buffer = malloc(OUTPUT_BUFFER_BYTES)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	if (format == OUTPUT_CSV)
+	{
+		out->length = put_string(out->buffer, csv_header, sizeof csv_header - 1) - out->buffer;
+	}
+
+	return SUCCESS;
+}
+
+status_t output_uninitialize(output_t *out)
+{
+	status_t error = output_flush(out);
+	free(out->buffer);
+	return error;
+}
+
+status_t output_flush(output_t *out)
+{
+	if (out->length > 0 && fwrite(out->buffer, out->length, 1, out->file) < 1)
+	{
+		out->error = WRIT_ERROR;
+	}
+	out->length = 0;
+
+	if (fflush(out->file) != 0)
+	{
+		out->error = WRIT_ERROR;
+	}
+	return out->error;
+}
+
+void output_reference(output_t *out, uint64_t virtual_address, uint64_t physical_address, int8_t value)
+{
+	if (out->format == OUTPUT_NONE)
+	{
+		return;
+	}
+
+	if (out->length > OUTPUT_BUFFER_BYTES - MAX_REFERENCE_BYTES)
+	{
+		if (fwrite(out->buffer, out->length, 1, out->file) < 1)
+		{
+			out->error = WRIT_ERROR;
+		}
+		out->length = 0;
+	}
+
+	char *p = out->buffer + out->length;
+	switch (out->format)
+	{
+		case OUTPUT_TEXT:
+			p = put_string(p, text_virtual, sizeof text_virtual - 1);
+			p = put_unsigned(p, virtual_address);
+			p = put_string(p, text_physical, sizeof text_physical - 1);
+			p = put_unsigned(p, physical_address);
+			p = put_string(p, text_value, sizeof text_value - 1);
+			p = put_signed(p, value);
+			*p++ = '\n';
+			break;
+		case OUTPUT_CSV:
+			p = put_unsigned(p, virtual_address);
+			*p++ = ',';
+			p = put_unsigned(p, physical_address);
+			*p++ = ',';
+			p = put_signed(p, value);
+			*p++ = '\n';
+			break;
+		case OUTPUT_BINARY:
+		{
+			output_record_t record;
+			memset(&record, 0, sizeof record);
+			record.virtual_address = virtual_address;
+			record.physical_address = physical_address;
+			record.value = value;
+			p = put_string(p, (const char *) &record, sizeof record);
+			break;
+		}
+		case OUTPUT_NONE:
+			break;
+	}
+	out->length = p - out->buffer;
+}
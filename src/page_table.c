@@ -0,0 +1,496 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/page_table.h"
+
+/**
+  * The multiplier of the Fibonacci hash which spreads tags over the chains of a hashed table
+  */
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+/**
+  * Allocates a zeroed node of a radix table, counting it in the footprint
+  * @param table the page table
+  * @param bytes the size of the node
+  * @return the node, or NULL if it could not be allocated
+  */
+static void *radix_allocate(page_table_t *table, size_t bytes);
+
+/**
+  * Frees a node of a radix table and every node beneath it
+  * @param node  the node
+  * @param level the level of the node, 0 being the root
+  * @param table the page table
+  */
+static void radix_free(void **node, unsigned int level, page_table_t *table);
+
+/**
+  * Walks a radix table down to the entry of a page, optionally adding any missing levels
+  * @param table      the page table
+  * @param tag        the tag of the page
+  * @param create     whether to allocate missing levels rather than give up at the first
+  * @param references if not NULL, has the number of entries read added to it
+  * @return the entry of the page, or NULL if a level is missing and was not, or could not be,
+  * allocated
+  */
+static page_entry_t *radix_walk(page_table_t *table, uint64_t tag, uint8_t create, size_t *references);
+
+/**
+  * Picks the chain of a hashed table which holds a page
+  * @param table the page table
+  * @param tag   the tag of the page
+  * @return the number of the chain
+  */
+static size_t hashed_chain(page_table_t *table, uint64_t tag);
+
+/**
+  * Checks the chains of a hashed table read from a snapshot: each must run through distinct frames
+  * in range, whose entries are valid, map their own frame and have tags which hash to the chain
+  * @param table         the hashed page table
+  * @param count         the number of resident pages, which the chains must hold between them
+  * @param number_frames the number of frames
+  * @return FORM_ERROR if the chains are not ones the table could have built, ALOC_ERROR if there
+  * was not the memory to check them, and otherwise SUCCESS
+  */
+static status_t hashed_check(page_table_t *table, size_t count, size_t number_frames);
+
+/**
+  * Returns whether a tag read from a snapshot lies within the tags the table is indexed by
+  * @param table the page table
+  * @param tag   the tag
+  * @return whether the tag is in range
+  */
+static uint8_t tag_in_range(page_table_t *table, uint64_t tag);
+
+/**
+  * Counts the leaves of a radix table beneath a node, and writes down the tag of the first page
+  * under each one
+  * @param node   the node
+  * @param level  the level of the node, 0 being the root
+  * @param prefix the bits of the tag which lead to the node
+  * @param table  the page table
+  * @param leaves if not NULL, where the tags of the leaves are written, in order
+  * @return the number of leaves
+  */
+static size_t radix_leaves(void **node, unsigned int level, uint64_t prefix, page_table_t *table, uint64_t *leaves);
+
+status_t page_table_kind_find(const char *name, page_table_kind_t *kind)
+{
+	if (strcmp(name, "auto") == 0)
+	{
+		*kind = PAGE_TABLE_AUTO;
+	}
+	else if (strcmp(name, "flat") == 0)
+	{
+		*kind = PAGE_TABLE_FLAT;
+	}
+	else if (strcmp(name, "radix") == 0)
+	{
+		*kind = PAGE_TABLE_RADIX;
+	}
+	else if (strcmp(name, "hashed") == 0)
+	{
+		*kind = PAGE_TABLE_HASHED;
+	}
+	else
+	{
+		return OPTN_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+status_t page_table_initialize(page_table_t *table, page_table_kind_t kind, unsigned int tag_bits, size_t number_frames, unsigned int shard_bits)
+{
+	table->kind = kind;
+	table->tag_bits = tag_bits;
+	table->shard_bits = shard_bits;
+	table->flat = NULL;
+	table->root = NULL;
+	table->hashed = NULL;
+	table->anchors = NULL;
+	table->footprint = 0;
+
+	switch (kind)
+	{
+		case PAGE_TABLE_FLAT:
+			if (tag_bits > MAX_FLAT_BITS)
+			{
+				return GEOM_ERROR;
+			}
+			table->footprint = ((size_t) 1 << tag_bits) * sizeof *table->flat;
+			if ((table->flat = calloc((size_t) 1 << tag_bits, sizeof *table->flat)) == NULL)
+			{
+				return ALOC_ERROR;
+			}
+			break;
+		case PAGE_TABLE_RADIX:
+		{
+			//the root takes whatever bits are left over once every other level has its RADIX_BITS,
+			//and with a single level it is itself the leaf
+			table->levels = tag_bits <= RADIX_BITS ? 1 : (tag_bits + RADIX_BITS - 1) / RADIX_BITS;
+			table->root_bits = tag_bits - (table->levels - 1) * RADIX_BITS;
+			size_t entry_bytes = table->levels == 1 ? sizeof (page_entry_t) : sizeof (void *);
+			if ((table->root = radix_allocate(table, ((size_t) 1 << table->root_bits) * entry_bytes)) == NULL)
+			{
+				return ALOC_ERROR;
+			}
+			break;
+		}
+		case PAGE_TABLE_HASHED:
+		{
+			//twice as many chains as frames keeps them short, and there must be more chains than
+			//shards for the hash to have any bits to pick from
+			table->anchor_bits = shard_bits + 1;
+			while (((size_t) 1 << table->anchor_bits) < 2 * number_frames)
+			{
+				table->anchor_bits++;
+			}
+			size_t chains = (size_t) 1 << table->anchor_bits;
+			table->hashed = malloc(number_frames * sizeof *table->hashed);
+			table->anchors = malloc(chains * sizeof *table->anchors);
+			if (table->hashed == NULL || table->anchors == NULL)
+			{
+				free(table->hashed);
+				free(table->anchors);
+				table->hashed = NULL;
+				table->anchors = NULL;
+				return ALOC_ERROR;
+			}
+			memset(table->hashed, 0, number_frames * sizeof *table->hashed);
+			size_t chain;
+			for (chain = 0; chain < chains; chain++)
+			{
+				table->anchors[chain] = HASHED_END;
+			}
+			table->footprint = number_frames * sizeof *table->hashed + chains * sizeof *table->anchors;
+			break;
+		}
+		default:
+			return OPTN_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+void page_table_uninitialize(page_table_t *table)
+{
+	if (table->root != NULL)
+	{
+		radix_free(table->root, 0, table);
+	}
+	free(table->flat);
+	free(table->hashed);
+	free(table->anchors);
+}
+
+page_entry_t *page_table_find(page_table_t *table, uint64_t tag, size_t *references)
+{
+	switch (table->kind)
+	{
+		case PAGE_TABLE_FLAT:
+			if (references != NULL)
+			{
+				(*references)++;
+			}
+			return &table->flat[tag];
+		case PAGE_TABLE_RADIX:
+			return radix_walk(table, tag, 0, references);
+		default:
+		{
+			//one reference for the anchor, and one for every entry of the chain looked at
+			size_t chain = hashed_chain(table, tag);
+			size_t count = 1;
+			int32_t frame;
+			for (frame = table->anchors[chain]; frame != HASHED_END && table->hashed[frame].tag != tag; frame = table->hashed[frame].next)
+			{
+				count++;
+			}
+			if (references != NULL)
+			{
+				*references += count + (frame != HASHED_END);
+			}
+			return frame == HASHED_END ? NULL : &table->hashed[frame].entry;
+		}
+	}
+}
+
+page_entry_t *page_table_map(page_table_t *table, uint64_t tag, uint32_t frame)
+{
+	page_entry_t *entry;
+	switch (table->kind)
+	{
+		case PAGE_TABLE_FLAT:
+			entry = &table->flat[tag];
+			break;
+		case PAGE_TABLE_RADIX:
+			if ((entry = radix_walk(table, tag, 1, NULL)) == NULL)
+			{
+				return NULL;
+			}
+			break;
+		default:
+		{
+			size_t chain = hashed_chain(table, tag);
+			table->hashed[frame].tag = tag;
+			table->hashed[frame].next = table->anchors[chain];
+			table->anchors[chain] = frame;
+			entry = &table->hashed[frame].entry;
+			break;
+		}
+	}
+
+	entry->frame = frame;
+	entry->valid = 1;
+	entry->dirty = 0;
+	entry->prefetched = 0;
+	entry->filled = 0;
+	return entry;
+}
+
+void page_table_unmap(page_table_t *table, uint64_t tag)
+{
+	if (table->kind != PAGE_TABLE_HASHED)
+	{
+		page_table_find(table, tag, NULL)->valid = 0;
+		return;
+	}
+
+	int32_t *link = &table->anchors[hashed_chain(table, tag)];
+	while (table->hashed[*link].tag != tag)
+	{
+		link = &table->hashed[*link].next;
+	}
+	table->hashed[*link].entry.valid = 0;
+	*link = table->hashed[*link].next;
+}
+
+void page_table_save(page_table_t *table, const uint64_t *tags, size_t count, size_t number_frames, snapshot_writer_t *writer)
+{
+	//a hashed table is small and is saved whole, down to the order of every chain
+	if (table->kind == PAGE_TABLE_HASHED)
+	{
+		snapshot_write(writer, table->hashed, number_frames * sizeof *table->hashed);
+		snapshot_write(writer, table->anchors, ((size_t) 1 << table->anchor_bits) * sizeof *table->anchors);
+		return;
+	}
+
+	//a walk stops at the first missing level, so the leaves of a radix table which only hold pages
+	//evicted since have to come back too
+	if (table->kind == PAGE_TABLE_RADIX && table->levels > 1)
+	{
+		uint64_t number_leaves = radix_leaves(table->root, 0, 0, table, NULL);
+		uint64_t *leaves = malloc(number_leaves * sizeof *leaves);
+		if (leaves == NULL)
+		{
+			if (writer->error == SUCCESS)
+			{
+				writer->error = ALOC_ERROR;
+			}
+			return;
+		}
+		radix_leaves(table->root, 0, 0, table, leaves);
+		snapshot_write(writer, &number_leaves, sizeof number_leaves);
+		snapshot_write(writer, leaves, number_leaves * sizeof *leaves);
+		free(leaves);
+	}
+
+	size_t i;
+	for (i = 0; i < count; i++)
+	{
+		snapshot_write(writer, page_table_find(table, tags[i], NULL), sizeof (page_entry_t));
+	}
+}
+
+status_t page_table_restore(page_table_t *table, const uint64_t *tags, size_t count, size_t number_frames, snapshot_reader_t *reader)
+{
+	if (table->kind == PAGE_TABLE_HASHED)
+	{
+		snapshot_read(reader, table->hashed, number_frames * sizeof *table->hashed);
+		snapshot_read(reader, table->anchors, ((size_t) 1 << table->anchor_bits) * sizeof *table->anchors);
+		return reader->error != SUCCESS ? reader->error : hashed_check(table, count, number_frames);
+	}
+
+	if (table->kind == PAGE_TABLE_RADIX && table->levels > 1)
+	{
+		uint64_t number_leaves = 0;
+		snapshot_read(reader, &number_leaves, sizeof number_leaves);
+		const uint64_t *leaves;
+		if (number_leaves > reader->length / sizeof *leaves || (leaves = snapshot_section(reader, number_leaves * sizeof *leaves)) == NULL)
+		{
+			return FORM_ERROR;
+		}
+
+		uint64_t leaf;
+		for (leaf = 0; leaf < number_leaves; leaf++)
+		{
+			if (!tag_in_range(table, leaves[leaf]))
+			{
+				return FORM_ERROR;
+			}
+			if (radix_walk(table, leaves[leaf], 1, NULL) == NULL)
+			{
+				return ALOC_ERROR;
+			}
+		}
+	}
+
+	size_t i;
+	for (i = 0; i < count; i++)
+	{
+		const page_entry_t *saved;
+		page_entry_t *entry;
+		if ((saved = snapshot_section(reader, sizeof *saved)) == NULL || !tag_in_range(table, tags[i]) || !saved->valid ||
+			saved->frame >= number_frames)
+		{
+			return FORM_ERROR;
+		}
+		if ((entry = page_table_map(table, tags[i], saved->frame)) == NULL)
+		{
+			return ALOC_ERROR;
+		}
+		*entry = *saved;
+	}
+	return reader->error;
+}
+
+static void *radix_allocate(page_table_t *table, size_t bytes)
+{
+	void *node = calloc(1, bytes);
+	if (node != NULL)
+	{
+		__atomic_fetch_add(&table->footprint, bytes, __ATOMIC_RELAXED);
+	}
+	return node;
+}
+
+static void radix_free(void **node, unsigned int level, page_table_t *table)
+{
+	if (level + 1 < table->levels)
+	{
+		size_t entries = level == 0 ? (size_t) 1 << table->root_bits : RADIX_FANOUT;
+		size_t i;
+		for (i = 0; i < entries; i++)
+		{
+			if (node[i] != NULL)
+			{
+				radix_free(node[i], level + 1, table);
+			}
+		}
+	}
+	free(node);
+}
+
+static page_entry_t *radix_walk(page_table_t *table, uint64_t tag, uint8_t create, size_t *references)
+{
+	void **node = table->root;
+	unsigned int level;
+	for (level = 0; level + 1 < table->levels; level++)
+	{
+		if (references != NULL)
+		{
+			(*references)++;
+		}
+
+		unsigned int shift = (table->levels - 1 - level) * RADIX_BITS;
+		void **slot = &node[(tag >> shift) & (RADIX_FANOUT - 1)];
+		void **child = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+		if (child == NULL)
+		{
+			if (!create)
+			{
+				return NULL;
+			}
+
+			//another core may add the same level at the same time, in which case its node is kept
+			size_t entry_bytes = level + 2 == table->levels ? sizeof (page_entry_t) : sizeof (void *);
+			void **expected = NULL;
+			if ((child = radix_allocate(table, RADIX_FANOUT * entry_bytes)) == NULL)
+			{
+				return NULL;
+			}
+			if (!__atomic_compare_exchange_n(slot, &expected, child, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			{
+				__atomic_fetch_sub(&table->footprint, RADIX_FANOUT * entry_bytes, __ATOMIC_RELAXED);
+				free(child);
+				child = expected;
+			}
+		}
+		node = child;
+	}
+
+	if (references != NULL)
+	{
+		(*references)++;
+	}
+	return &((page_entry_t *) node)[tag & (RADIX_FANOUT - 1)];
+}
+
+static size_t radix_leaves(void **node, unsigned int level, uint64_t prefix, page_table_t *table, uint64_t *leaves)
+{
+	if (level + 1 == table->levels)
+	{
+		if (leaves != NULL)
+		{
+			*leaves = prefix << RADIX_BITS;
+		}
+		return 1;
+	}
+
+	size_t entries = level == 0 ? (size_t) 1 << table->root_bits : RADIX_FANOUT;
+	size_t count = 0;
+	size_t i;
+	for (i = 0; i < entries; i++)
+	{
+		if (node[i] != NULL)
+		{
+			count += radix_leaves(node[i], level + 1, prefix << RADIX_BITS | i, table, leaves == NULL ? NULL : leaves + count);
+		}
+	}
+	return count;
+}
+
+static size_t hashed_chain(page_table_t *table, uint64_t tag)
+{
+	unsigned int hash_bits = table->anchor_bits - table->shard_bits;
+	uint64_t shard = tag & (((uint64_t) 1 << table->shard_bits) - 1);
+	return ((tag * HASH_MULTIPLIER) >> (64 - hash_bits)) << table->shard_bits | shard;
+}
+
+static status_t hashed_check(page_table_t *table, size_t count, size_t number_frames)
+{
+	uint8_t *chained;
+	if ((chained = calloc(number_frames > 0 ? number_frames : 1, sizeof *chained)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	//a frame may only be reached once, or a chain could run round in a loop
+	size_t chains = (size_t) 1 << table->anchor_bits;
+	size_t mapped = 0;
+	status_t error = SUCCESS;
+	size_t chain;
+	for (chain = 0; chain < chains && error == SUCCESS; chain++)
+	{
+		int32_t frame = table->anchors[chain];
+		while (frame != HASHED_END)
+		{
+			if (frame < 0 || (size_t) frame >= number_frames || chained[frame] || hashed_chain(table, table->hashed[frame].tag) != chain ||
+				!table->hashed[frame].entry.valid || table->hashed[frame].entry.frame != (uint32_t) frame)
+			{
+				error = FORM_ERROR;
+				break;
+			}
+			chained[frame] = 1;
+			mapped++;
+			frame = table->hashed[frame].next;
+		}
+	}
+	free(chained);
+	return error == SUCCESS && mapped != count ? FORM_ERROR : error;
+}
+
+static uint8_t tag_in_range(page_table_t *table, uint64_t tag)
+{
+	return table->tag_bits >= 64 || (tag >> table->tag_bits) == 0;
+}
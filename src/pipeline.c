@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/pipeline.h"
+
+/**
+  * The states of a slot
+  */
+#define SLOT_FREE    0
+#define SLOT_QUEUED  1
+#define SLOT_READING 2
+#define SLOT_READY   3
+
+/**
+  * An I/O worker thread. Reads the queued page issued longest ago, until it is stopped
+  * @param argument the pipeline
+  * @return NULL
+  */
+static void *pipeline_work(void *argument);
+
+/**
+  * Finds the slot holding a page. Called with the lock held
+  * @param pipeline the pipeline
+  * @param page     the number of the page
+  * @return the slot, or PIPELINE_SLOTS if the page is in none
+  */
+static size_t pipeline_find(pipeline_t *pipeline, uint64_t page);
+
+status_t pipeline_initialize(pipeline_t *pipeline, backing_store_t *store, size_t number_workers)
+{
+	if (number_workers == 0 || number_workers > MAX_PIPELINE_WORKERS)
+	{
+		return OPTN_ERROR;
+	}
+
+	pipeline->store = store;
+	pipeline->issued = 0;
+	pipeline->queued = 0;
+	pipeline->stopping = 0;
+	pipeline->number_workers = 0;
+	memset(pipeline->states, SLOT_FREE, sizeof pipeline->states);
+	pipeline->buffers = malloc(PIPELINE_SLOTS * store->page_bytes);
+	pipeline->workers = malloc(number_workers * sizeof *pipeline->workers);
+	if (pipeline->buffers == NULL || pipeline->workers == NULL)
+	{
+		free(pipeline->workers);
+		free(pipeline->buffers);
+		return ALOC_ERROR;
+	}
+
+	pthread_mutex_init(&pipeline->lock, NULL);
+	pthread_cond_init(&pipeline->work, NULL);
+	pthread_cond_init(&pipeline->done, NULL);
+	for (pipeline->number_workers = 0; pipeline->number_workers < number_workers; pipeline->number_workers++)
+	{
+		if (pthread_create(&pipeline->workers[pipeline->number_workers], NULL, pipeline_work, pipeline) != 0)
+		{
+			pipeline_uninitialize(pipeline);
+			return ALOC_ERROR;
+		}
+	}
+
+	return SUCCESS;
+}
+
+void pipeline_uninitialize(pipeline_t *pipeline)
+{
+	pthread_mutex_lock(&pipeline->lock);
+	pipeline->stopping = 1;
+	pthread_cond_broadcast(&pipeline->work);
+	pthread_mutex_unlock(&pipeline->lock);
+
+	size_t worker;
+	for (worker = 0; worker < pipeline->number_workers; worker++)
+	{
+		pthread_join(pipeline->workers[worker], NULL);
+	}
+
+	pthread_cond_destroy(&pipeline->done);
+	pthread_cond_destroy(&pipeline->work);
+	pthread_mutex_destroy(&pipeline->lock);
+	free(pipeline->workers);
+	free(pipeline->buffers);
+}
+
+uint8_t pipeline_issue(pipeline_t *pipeline, uint64_t page)
+{
+	pthread_mutex_lock(&pipeline->lock);
+	size_t slot = pipeline_find(pipeline, page);
+	if (slot == PIPELINE_SLOTS)
+	{
+		for (slot = 0; slot < PIPELINE_SLOTS && pipeline->states[slot] != SLOT_FREE; slot++);
+		if (slot < PIPELINE_SLOTS)
+		{
+			pipeline->states[slot] = SLOT_QUEUED;
+			pipeline->pages[slot] = page;
+			pipeline->sequences[slot] = pipeline->issued++;
+			pipeline->queued++;
+			pthread_cond_signal(&pipeline->work);
+		}
+	}
+	pthread_mutex_unlock(&pipeline->lock);
+	return slot < PIPELINE_SLOTS;
+}
+
+status_t pipeline_read(pipeline_t *pipeline, uint64_t page, int8_t *dest)
+{
+	pthread_mutex_lock(&pipeline->lock);
+	size_t slot = pipeline_find(pipeline, page);
+	if (slot < PIPELINE_SLOTS && pipeline->states[slot] == SLOT_QUEUED)
+	{
+		//no worker has got to it yet, so reading it here is no slower than waiting
+		pipeline->states[slot] = SLOT_FREE;
+		pipeline->queued--;
+		slot = PIPELINE_SLOTS;
+	}
+	while (slot < PIPELINE_SLOTS && pipeline->states[slot] == SLOT_READING)
+	{
+		pthread_cond_wait(&pipeline->done, &pipeline->lock);
+	}
+
+	//a worker which failed to read its page frees the slot, leaving the fault to read the page
+	//and report the error itself
+	if (slot < PIPELINE_SLOTS && pipeline->states[slot] == SLOT_READY)
+	{
+		memcpy(dest, pipeline->buffers + slot * pipeline->store->page_bytes, pipeline->store->page_bytes);
+		pipeline->states[slot] = SLOT_FREE;
+		pthread_mutex_unlock(&pipeline->lock);
+		return SUCCESS;
+	}
+	pthread_mutex_unlock(&pipeline->lock);
+
+	return backing_store_read(pipeline->store, page, dest);
+}
+
+static void *pipeline_work(void *argument)
+{
+	pipeline_t *pipeline = argument;
+	size_t page_bytes = pipeline->store->page_bytes;
+
+	pthread_mutex_lock(&pipeline->lock);
+	while (1)
+	{
+		while (pipeline->queued == 0 && !pipeline->stopping)
+		{
+			pthread_cond_wait(&pipeline->work, &pipeline->lock);
+		}
+		if (pipeline->stopping)
+		{
+			break;
+		}
+
+		//the page issued longest ago is the one the simulation will reach first
+		size_t next = PIPELINE_SLOTS;
+		size_t slot;
+		for (slot = 0; slot < PIPELINE_SLOTS; slot++)
+		{
+			if (pipeline->states[slot] == SLOT_QUEUED && (next == PIPELINE_SLOTS || pipeline->sequences[slot] < pipeline->sequences[next]))
+			{
+				next = slot;
+			}
+		}
+		pipeline->states[next] = SLOT_READING;
+		pipeline->queued--;
+		uint64_t page = pipeline->pages[next];
+		pthread_mutex_unlock(&pipeline->lock);
+
+		status_t error = backing_store_read(pipeline->store, page, pipeline->buffers + next * page_bytes);
+
+		pthread_mutex_lock(&pipeline->lock);
+		pipeline->states[next] = error == SUCCESS ? SLOT_READY : SLOT_FREE;
+		pthread_cond_broadcast(&pipeline->done);
+	}
+	pthread_mutex_unlock(&pipeline->lock);
+
+	return NULL;
+}
+
+static size_t pipeline_find(pipeline_t *pipeline, uint64_t page)
+{
+	size_t slot;
+	for (slot = 0; slot < PIPELINE_SLOTS; slot++)
+	{
+		if (pipeline->states[slot] != SLOT_FREE && pipeline->pages[slot] == page)
+		{
+			break;
+		}
+	}
+	return slot;
+}
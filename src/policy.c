@@ -0,0 +1,363 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/lru_queue.h"
+#include "../include/policy.h"
+
+/**
+  * Every kind of policy, in the order their names are listed
+  */
+static const policy_ops_t *const all_policies[] =
+{
+	&lru_policy_ops,
+	&fifo_policy_ops,
+	&clock_policy_ops,
+	&second_chance_policy_ops,
+	&lfu_policy_ops,
+	&arc_policy_ops,
+	&two_queue_policy_ops,
+	&opt_policy_ops,
+	&plru_policy_ops
+};
+
+/**
+  * The state shared by the CLOCK and second-chance policies: a reference bit, a modified bit and a
+  * present bit per slot, and the position of the clock hand
+  */
+typedef struct
+{
+	uint8_t *referenced;
+	uint8_t *modified;
+	uint8_t *present;
+	int hand;
+} clock_state_t;
+
+const policy_ops_t *policy_find(const char *name)
+{
+	size_t i;
+	for (i = 0; i < sizeof all_policies / sizeof *all_policies; i++)
+	{
+		if (strcmp(all_policies[i]->name, name) == 0)
+		{
+			return all_policies[i];
+		}
+	}
+
+	return NULL;
+}
+
+void policy_print_names(FILE *out)
+{
+	size_t i;
+	for (i = 0; i < sizeof all_policies / sizeof *all_policies; i++)
+	{
+		fprintf(out, "%s%s", i == 0 ? "" : " ", all_policies[i]->name);
+	}
+}
+
+status_t policy_initialize(policy_t *policy, const char *name, int capacity)
+{
+	if ((policy->ops = policy_find(name)) == NULL)
+	{
+		return OPTN_ERROR;
+	}
+
+	policy->capacity = capacity;
+	policy->state = NULL;
+	policy->next_use = NULL;
+	policy->position = NULL;
+	return policy->ops->initialize(policy);
+}
+
+void policy_set_future(policy_t *policy, const uint32_t *next_use, const size_t *position)
+{
+	policy->next_use = next_use;
+	policy->position = position;
+}
+
+void policy_uninitialize(policy_t *policy)
+{
+	policy->ops->uninitialize(policy);
+}
+
+status_t policy_save(policy_t *policy, snapshot_writer_t *writer)
+{
+	if (policy->ops->save == NULL)
+	{
+		return OPTN_ERROR;
+	}
+
+	policy->ops->save(policy, writer);
+	return SUCCESS;
+}
+
+status_t policy_restore(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied)
+{
+	if (policy->ops->restore == NULL)
+	{
+		return OPTN_ERROR;
+	}
+
+	return policy->ops->restore(policy, reader, occupied);
+}
+
+/**
+  * Evicts the least recently referenced item, keeping every slot in an LRU queue
+  */
+static status_t lru_initialize(policy_t *policy)
+{
+	lru_queue_t *queue = malloc(sizeof *queue);
+	if (queue == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	status_t error;
+	if ((error = lru_queue_initialize(queue, policy->capacity)) != SUCCESS)
+	{
+		free(queue);
+		return error;
+	}
+	policy->state = queue;
+	return SUCCESS;
+}
+
+static void lru_uninitialize(policy_t *policy)
+{
+	lru_queue_uninitialize(policy->state);
+	free(policy->state);
+}
+
+static void lru_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+	lru_queue_update_existing(policy->state, slot);
+}
+
+static void lru_insert(policy_t *policy, int slot, uint64_t key, uint8_t is_write)
+{
+	lru_queue_insert_new(policy->state, slot);
+}
+
+static int lru_victim(policy_t *policy, uint64_t key)
+{
+	return lru_queue_poll(policy->state);
+}
+
+static void lru_remove(policy_t *policy, int slot)
+{
+	lru_queue_remove_existing(policy->state, slot);
+}
+
+static void lru_save(policy_t *policy, snapshot_writer_t *writer)
+{
+	lru_queue_save(policy->state, writer);
+}
+
+static status_t lru_restore(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied)
+{
+	status_t error;
+	if ((error = lru_queue_restore(policy->state, reader)) != SUCCESS)
+	{
+		return error;
+	}
+
+	int slot;
+	for (slot = 0; slot < policy->capacity; slot++)
+	{
+		if (lru_queue_contains(policy->state, slot) != occupied[slot])
+		{
+			return FORM_ERROR;
+		}
+	}
+	return SUCCESS;
+}
+
+const policy_ops_t lru_policy_ops =
+{
+	"lru", lru_initialize, lru_uninitialize, lru_hit, lru_insert, lru_victim, lru_remove, 0, NULL, lru_save, lru_restore
+};
+
+/**
+  * Evicts the item which was brought in longest ago, ignoring references after it arrives. It
+  * shares the LRU policy's queue, simply never moving a slot on a hit
+  */
+static void fifo_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+}
+
+const policy_ops_t fifo_policy_ops =
+{
+	"fifo", lru_initialize, lru_uninitialize, fifo_hit, lru_insert, lru_victim, lru_remove, 0, NULL, lru_save, lru_restore
+};
+
+/**
+  * Approximates LRU with a reference bit per slot: the hand sweeps the slots in order, clearing
+  * set reference bits, and evicts the first slot whose bit is already clear
+  */
+static status_t clock_initialize(policy_t *policy)
+{
+	clock_state_t *state = malloc(sizeof *state);
+	if (state == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	state->referenced = calloc(policy->capacity, sizeof *state->referenced);
+	state->modified = calloc(policy->capacity, sizeof *state->modified);
+	state->present = calloc(policy->capacity, sizeof *state->present);
+	state->hand = 0;
+	policy->state = state;
+	if (state->referenced == NULL || state->modified == NULL || state->present == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+static void clock_uninitialize(policy_t *policy)
+{
+	clock_state_t *state = policy->state;
+	if (state != NULL)
+	{
+		free(state->present);
+		free(state->modified);
+		free(state->referenced);
+		free(state);
+	}
+}
+
+static void clock_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+	clock_state_t *state = policy->state;
+	state->referenced[slot] = 1;
+	state->modified[slot] |= is_write;
+}
+
+static void clock_insert(policy_t *policy, int slot, uint64_t key, uint8_t is_write)
+{
+	clock_state_t *state = policy->state;
+	state->present[slot] = 1;
+	state->referenced[slot] = 1;
+	state->modified[slot] = is_write;
+}
+
+static void clock_insert_cold(policy_t *policy, int slot, uint64_t key)
+{
+	//with its reference bit clear, the slot goes the first time the hand reaches it
+	clock_state_t *state = policy->state;
+	state->present[slot] = 1;
+	state->referenced[slot] = 0;
+	state->modified[slot] = 0;
+}
+
+static int clock_victim(policy_t *policy, uint64_t key)
+{
+	clock_state_t *state = policy->state;
+	while (1)
+	{
+		int slot = state->hand;
+		state->hand = (state->hand + 1) % policy->capacity;
+		if (!state->present[slot])
+		{
+			continue;
+		}
+
+		if (!state->referenced[slot])
+		{
+			state->present[slot] = 0;
+			return slot;
+		}
+		state->referenced[slot] = 0;
+	}
+}
+
+static void clock_remove(policy_t *policy, int slot)
+{
+	clock_state_t *state = policy->state;
+	state->present[slot] = 0;
+	state->referenced[slot] = 0;
+}
+
+static void clock_save(policy_t *policy, snapshot_writer_t *writer)
+{
+	clock_state_t *state = policy->state;
+	snapshot_write(writer, state->referenced, policy->capacity * sizeof *state->referenced);
+	snapshot_write(writer, state->modified, policy->capacity * sizeof *state->modified);
+	snapshot_write(writer, state->present, policy->capacity * sizeof *state->present);
+	snapshot_write(writer, &state->hand, sizeof state->hand);
+}
+
+static status_t clock_restore(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied)
+{
+	clock_state_t *state = policy->state;
+	snapshot_read(reader, state->referenced, policy->capacity * sizeof *state->referenced);
+	snapshot_read(reader, state->modified, policy->capacity * sizeof *state->modified);
+	snapshot_read(reader, state->present, policy->capacity * sizeof *state->present);
+	snapshot_read(reader, &state->hand, sizeof state->hand);
+
+	//the second-chance sweeps match the modified bit against 0 and 1, so any other value would
+	//never be picked
+	if (state->hand < 0 || state->hand >= policy->capacity)
+	{
+		return FORM_ERROR;
+	}
+	int slot;
+	for (slot = 0; slot < policy->capacity; slot++)
+	{
+		if (state->referenced[slot] > 1 || state->modified[slot] > 1 || state->present[slot] != occupied[slot])
+		{
+			return FORM_ERROR;
+		}
+	}
+	return SUCCESS;
+}
+
+const policy_ops_t clock_policy_ops =
+{
+	"clock", clock_initialize, clock_uninitialize, clock_hit, clock_insert, clock_victim, clock_remove, 0, clock_insert_cold,
+	clock_save, clock_restore
+};
+
+/**
+  * The enhanced second-chance algorithm, which also weighs the dirty bit so that clean pages
+  * (which need no write-back) are preferred. The hand looks for the best class of slot in turn:
+  * first one neither referenced nor modified, leaving the bits alone; then one modified but not
+  * referenced, clearing reference bits as it passes. Since the second sweep clears every
+  * reference bit, repeating the two sweeps always finds a victim
+  */
+static int second_chance_victim(policy_t *policy, uint64_t key)
+{
+	clock_state_t *state = policy->state;
+	int pass;
+	for (pass = 0; ; pass = (pass + 1) % 2)
+	{
+		int i;
+		for (i = 0; i < policy->capacity; i++)
+		{
+			int slot = state->hand;
+			state->hand = (state->hand + 1) % policy->capacity;
+			if (!state->present[slot])
+			{
+				continue;
+			}
+
+			if (!state->referenced[slot] && state->modified[slot] == pass)
+			{
+				state->present[slot] = 0;
+				return slot;
+			}
+
+			if (pass == 1)
+			{
+				state->referenced[slot] = 0;
+			}
+		}
+	}
+}
+
+const policy_ops_t second_chance_policy_ops =
+{
+	"second-chance", clock_initialize, clock_uninitialize, clock_hit, clock_insert, second_chance_victim, clock_remove, 0, clock_insert_cold,
+	clock_save, clock_restore
+};
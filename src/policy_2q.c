@@ -0,0 +1,186 @@
+#include <stdlib.h>
+
+#include "../include/ghost_list.h"
+#include "../include/lru_queue.h"
+#include "../include/policy.h"
+
+/**
+  * The fractions of the capacity given to the A1in queue and to the A1out ghost list, as
+  * recommended by Johnson and Shasha
+  */
+#define TWO_QUEUE_IN_DIVISOR  4
+#define TWO_QUEUE_OUT_DIVISOR 2
+
+/**
+  * The state of the full 2Q policy (Johnson and Shasha, "2Q: A Low Overhead High Performance
+  * Buffer Management Replacement Algorithm"). New items enter the FIFO A1in; when they leave it
+  * their keys are remembered in A1out, and an item which returns while still remembered there is
+  * taken to be hot and placed in the LRU queue Am. Items referenced only once therefore never
+  * displace the hot items in Am
+  */
+typedef struct
+{
+	lru_queue_t a1in;
+	lru_queue_t am;
+	int a1in_size;
+	int am_size;
+	int a1in_target;
+	ghost_list_t a1out;
+	uint64_t *slot_keys;
+} two_queue_state_t;
+
+static status_t two_queue_initialize(policy_t *policy)
+{
+	two_queue_state_t *state = calloc(1, sizeof *state);
+	if (state == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	policy->state = state;
+
+	if ((state->slot_keys = malloc(policy->capacity * sizeof *state->slot_keys)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	int out_capacity = policy->capacity / TWO_QUEUE_OUT_DIVISOR;
+	status_t error;
+	if ((error = ghost_list_initialize(&state->a1out, out_capacity > 0 ? out_capacity : 1)) != SUCCESS)
+	{
+		return error;
+	}
+
+	state->a1in_target = policy->capacity / TWO_QUEUE_IN_DIVISOR;
+	if (state->a1in_target == 0)
+	{
+		state->a1in_target = 1;
+	}
+	if ((error = lru_queue_initialize(&state->a1in, policy->capacity)) != SUCCESS ||
+		(error = lru_queue_initialize(&state->am, policy->capacity)) != SUCCESS)
+	{
+		return error;
+	}
+	return SUCCESS;
+}
+
+static void two_queue_uninitialize(policy_t *policy)
+{
+	two_queue_state_t *state = policy->state;
+	lru_queue_uninitialize(&state->am);
+	lru_queue_uninitialize(&state->a1in);
+	ghost_list_uninitialize(&state->a1out);
+	free(state->slot_keys);
+	free(state);
+}
+
+static void two_queue_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+	//a reference to an item still in A1in is most likely correlated with the one which brought it
+	//in, so only references to items in Am count
+	two_queue_state_t *state = policy->state;
+	if (lru_queue_contains(&state->am, slot))
+	{
+		lru_queue_update_existing(&state->am, slot);
+	}
+}
+
+static void two_queue_insert(policy_t *policy, int slot, uint64_t key, uint8_t is_write)
+{
+	two_queue_state_t *state = policy->state;
+	state->slot_keys[slot] = key;
+	if (ghost_list_contains(&state->a1out, key))
+	{
+		ghost_list_remove(&state->a1out, key);
+		lru_queue_insert_new(&state->am, slot);
+		state->am_size++;
+	}
+	else
+	{
+		lru_queue_insert_new(&state->a1in, slot);
+		state->a1in_size++;
+	}
+}
+
+static int two_queue_victim(policy_t *policy, uint64_t key)
+{
+	two_queue_state_t *state = policy->state;
+	int slot;
+	if (state->a1in_size > state->a1in_target || state->am_size == 0)
+	{
+		slot = lru_queue_poll(&state->a1in);
+		state->a1in_size--;
+		ghost_list_push(&state->a1out, state->slot_keys[slot]);
+	}
+	else
+	{
+		slot = lru_queue_poll(&state->am);
+		state->am_size--;
+	}
+	return slot;
+}
+
+static void two_queue_remove(policy_t *policy, int slot)
+{
+	two_queue_state_t *state = policy->state;
+	if (lru_queue_contains(&state->am, slot))
+	{
+		lru_queue_remove_existing(&state->am, slot);
+		state->am_size--;
+	}
+	else
+	{
+		lru_queue_remove_existing(&state->a1in, slot);
+		state->a1in_size--;
+	}
+}
+
+static void two_queue_save(policy_t *policy, snapshot_writer_t *writer)
+{
+	two_queue_state_t *state = policy->state;
+	lru_queue_save(&state->a1in, writer);
+	lru_queue_save(&state->am, writer);
+	snapshot_write(writer, &state->a1in_size, sizeof state->a1in_size);
+	snapshot_write(writer, &state->am_size, sizeof state->am_size);
+	ghost_list_save(&state->a1out, writer);
+	snapshot_write(writer, state->slot_keys, policy->capacity * sizeof *state->slot_keys);
+}
+
+static status_t two_queue_restore(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied)
+{
+	two_queue_state_t *state = policy->state;
+	status_t error;
+	if ((error = lru_queue_restore(&state->a1in, reader)) != SUCCESS || (error = lru_queue_restore(&state->am, reader)) != SUCCESS)
+	{
+		return error;
+	}
+	snapshot_read(reader, &state->a1in_size, sizeof state->a1in_size);
+	snapshot_read(reader, &state->am_size, sizeof state->am_size);
+	if ((error = ghost_list_restore(&state->a1out, reader)) != SUCCESS)
+	{
+		return error;
+	}
+	snapshot_read(reader, state->slot_keys, policy->capacity * sizeof *state->slot_keys);
+
+	//every occupied slot is in exactly one of the queues, whose sizes must be their lengths
+	int a1in_size = 0;
+	int am_size = 0;
+	int slot;
+	for (slot = 0; slot < policy->capacity; slot++)
+	{
+		uint8_t in_a1in = lru_queue_contains(&state->a1in, slot);
+		uint8_t in_am = lru_queue_contains(&state->am, slot);
+		if ((in_a1in && in_am) || (in_a1in || in_am) != occupied[slot])
+		{
+			return FORM_ERROR;
+		}
+		a1in_size += in_a1in;
+		am_size += in_am;
+	}
+	return a1in_size == state->a1in_size && am_size == state->am_size ? SUCCESS : FORM_ERROR;
+}
+
+const policy_ops_t two_queue_policy_ops =
+{
+	"2q", two_queue_initialize, two_queue_uninitialize, two_queue_hit, two_queue_insert, two_queue_victim, two_queue_remove, 0, NULL,
+	two_queue_save, two_queue_restore
+};
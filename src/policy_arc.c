@@ -0,0 +1,285 @@
+#include <stdlib.h>
+
+#include "../include/ghost_list.h"
+#include "../include/lru_queue.h"
+#include "../include/policy.h"
+
+/**
+  * The state of the ARC policy (Megiddo and Modha, "ARC: A Self-Tuning, Low Overhead Replacement
+  * Cache"). T1 holds items referenced once since they were brought in and T2 items referenced
+  * more than once; B1 and B2 remember the keys recently evicted from each. The target size of T1,
+  * p, grows when an item evicted from T1 returns and shrinks when one evicted from T2 returns
+  */
+typedef struct
+{
+	lru_queue_t t1;
+	lru_queue_t t2;
+	int t1_size;
+	int t2_size;
+	ghost_list_t b1;
+	ghost_list_t b2;
+	int p;
+	uint64_t *slot_keys;
+	uint64_t victim_key;
+	uint8_t victim_pending;
+} arc_state_t;
+
+/**
+  * Moves p towards whichever of T1 or T2 the returning key was evicted from
+  * @param policy the ARC policy
+  * @param key    the key of the item being brought back in
+  */
+static void arc_adapt(policy_t *policy, uint64_t key)
+{
+	arc_state_t *state = policy->state;
+	if (ghost_list_contains(&state->b1, key))
+	{
+		int delta = state->b1.size >= state->b2.size ? 1 : state->b2.size / state->b1.size;
+		state->p = state->p + delta > policy->capacity ? policy->capacity : state->p + delta;
+	}
+	else if (ghost_list_contains(&state->b2, key))
+	{
+		int delta = state->b2.size >= state->b1.size ? 1 : state->b1.size / state->b2.size;
+		state->p = state->p - delta < 0 ? 0 : state->p - delta;
+	}
+}
+
+/**
+  * Forgets old ghost keys before a brand new key is brought in, so that T1 and B1 together hold at
+  * most capacity keys and all four lists at most twice that. Returns whether the LRU item of T1 has
+  * to be evicted without being remembered, because T1 alone fills the cache
+  * @param policy the ARC policy
+  * @return whether T1 fills the cache
+  */
+static int arc_trim(policy_t *policy)
+{
+	arc_state_t *state = policy->state;
+	if (state->t1_size + state->b1.size >= policy->capacity)
+	{
+		if (state->t1_size < policy->capacity)
+		{
+			ghost_list_drop_oldest(&state->b1);
+			return 0;
+		}
+		return 1;
+	}
+
+	if (state->t1_size + state->t2_size + state->b1.size + state->b2.size >= 2 * policy->capacity)
+	{
+		ghost_list_drop_oldest(&state->b2);
+	}
+	return 0;
+}
+
+/**
+  * Evicts the LRU item of T1 into B1 if T1 is over its target size, otherwise the LRU item of T2
+  * into B2
+  * @param policy the ARC policy
+  * @param in_b2  whether the key being brought in was found in B2
+  * @return the slot which was evicted
+  */
+static int arc_replace(policy_t *policy, uint8_t in_b2)
+{
+	arc_state_t *state = policy->state;
+	int slot;
+	if (state->t1_size > 0 && ((in_b2 && state->t1_size == state->p) || state->t1_size > state->p || state->t2_size == 0))
+	{
+		slot = lru_queue_poll(&state->t1);
+		state->t1_size--;
+		ghost_list_push(&state->b1, state->slot_keys[slot]);
+	}
+	else
+	{
+		slot = lru_queue_poll(&state->t2);
+		state->t2_size--;
+		ghost_list_push(&state->b2, state->slot_keys[slot]);
+	}
+	return slot;
+}
+
+static status_t arc_initialize(policy_t *policy)
+{
+	arc_state_t *state = calloc(1, sizeof *state);
+	if (state == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	policy->state = state;
+
+	if ((state->slot_keys = malloc(policy->capacity * sizeof *state->slot_keys)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	status_t error;
+	if ((error = ghost_list_initialize(&state->b1, 2 * policy->capacity)) != SUCCESS ||
+		(error = ghost_list_initialize(&state->b2, 2 * policy->capacity)) != SUCCESS)
+	{
+		return error;
+	}
+
+	if ((error = lru_queue_initialize(&state->t1, policy->capacity)) != SUCCESS ||
+		(error = lru_queue_initialize(&state->t2, policy->capacity)) != SUCCESS)
+	{
+		return error;
+	}
+	return SUCCESS;
+}
+
+static void arc_uninitialize(policy_t *policy)
+{
+	arc_state_t *state = policy->state;
+	lru_queue_uninitialize(&state->t2);
+	lru_queue_uninitialize(&state->t1);
+	ghost_list_uninitialize(&state->b2);
+	ghost_list_uninitialize(&state->b1);
+	free(state->slot_keys);
+	free(state);
+}
+
+static void arc_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+	arc_state_t *state = policy->state;
+	if (lru_queue_contains(&state->t1, slot))
+	{
+		lru_queue_remove_existing(&state->t1, slot);
+		state->t1_size--;
+		lru_queue_insert_new(&state->t2, slot);
+		state->t2_size++;
+	}
+	else
+	{
+		lru_queue_update_existing(&state->t2, slot);
+	}
+}
+
+static void arc_insert(policy_t *policy, int slot, uint64_t key, uint8_t is_write)
+{
+	arc_state_t *state = policy->state;
+
+	//when the cache was full, arc_victim has already adapted p and trimmed the ghost lists for
+	//this key; otherwise that is done here
+	uint8_t prepared = state->victim_pending && state->victim_key == key;
+	state->victim_pending = 0;
+
+	state->slot_keys[slot] = key;
+	if (ghost_list_contains(&state->b1, key) || ghost_list_contains(&state->b2, key))
+	{
+		if (!prepared)
+		{
+			arc_adapt(policy, key);
+		}
+		ghost_list_remove(&state->b1, key);
+		ghost_list_remove(&state->b2, key);
+		lru_queue_insert_new(&state->t2, slot);
+		state->t2_size++;
+	}
+	else
+	{
+		if (!prepared)
+		{
+			arc_trim(policy);
+		}
+		lru_queue_insert_new(&state->t1, slot);
+		state->t1_size++;
+	}
+}
+
+static int arc_victim(policy_t *policy, uint64_t key)
+{
+	arc_state_t *state = policy->state;
+	state->victim_key = key;
+	state->victim_pending = 1;
+
+	uint8_t in_b2 = ghost_list_contains(&state->b2, key);
+	if (in_b2 || ghost_list_contains(&state->b1, key))
+	{
+		arc_adapt(policy, key);
+		return arc_replace(policy, in_b2);
+	}
+
+	if (arc_trim(policy))
+	{
+		//T1 fills the whole cache and B1 is empty, so evict from T1 without remembering it
+		state->t1_size--;
+		return lru_queue_poll(&state->t1);
+	}
+	return arc_replace(policy, 0);
+}
+
+static void arc_remove(policy_t *policy, int slot)
+{
+	arc_state_t *state = policy->state;
+	if (lru_queue_contains(&state->t1, slot))
+	{
+		lru_queue_remove_existing(&state->t1, slot);
+		state->t1_size--;
+	}
+	else
+	{
+		lru_queue_remove_existing(&state->t2, slot);
+		state->t2_size--;
+	}
+}
+
+static void arc_save(policy_t *policy, snapshot_writer_t *writer)
+{
+	arc_state_t *state = policy->state;
+	lru_queue_save(&state->t1, writer);
+	lru_queue_save(&state->t2, writer);
+	snapshot_write(writer, &state->t1_size, sizeof state->t1_size);
+	snapshot_write(writer, &state->t2_size, sizeof state->t2_size);
+	ghost_list_save(&state->b1, writer);
+	ghost_list_save(&state->b2, writer);
+	snapshot_write(writer, &state->p, sizeof state->p);
+	snapshot_write(writer, state->slot_keys, policy->capacity * sizeof *state->slot_keys);
+	snapshot_write(writer, &state->victim_key, sizeof state->victim_key);
+	snapshot_write(writer, &state->victim_pending, sizeof state->victim_pending);
+}
+
+static status_t arc_restore(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied)
+{
+	arc_state_t *state = policy->state;
+	status_t error;
+	if ((error = lru_queue_restore(&state->t1, reader)) != SUCCESS || (error = lru_queue_restore(&state->t2, reader)) != SUCCESS)
+	{
+		return error;
+	}
+	snapshot_read(reader, &state->t1_size, sizeof state->t1_size);
+	snapshot_read(reader, &state->t2_size, sizeof state->t2_size);
+	if ((error = ghost_list_restore(&state->b1, reader)) != SUCCESS || (error = ghost_list_restore(&state->b2, reader)) != SUCCESS)
+	{
+		return error;
+	}
+	snapshot_read(reader, &state->p, sizeof state->p);
+	snapshot_read(reader, state->slot_keys, policy->capacity * sizeof *state->slot_keys);
+	snapshot_read(reader, &state->victim_key, sizeof state->victim_key);
+	snapshot_read(reader, &state->victim_pending, sizeof state->victim_pending);
+
+	//every occupied slot is in exactly one of T1 and T2, whose sizes must be their lengths, and the
+	//target size of T1 is no more than the whole cache
+	if (state->p < 0 || state->p > policy->capacity)
+	{
+		return FORM_ERROR;
+	}
+	int t1_size = 0;
+	int t2_size = 0;
+	int slot;
+	for (slot = 0; slot < policy->capacity; slot++)
+	{
+		uint8_t in_t1 = lru_queue_contains(&state->t1, slot);
+		uint8_t in_t2 = lru_queue_contains(&state->t2, slot);
+		if ((in_t1 && in_t2) || (in_t1 || in_t2) != occupied[slot])
+		{
+			return FORM_ERROR;
+		}
+		t1_size += in_t1;
+		t2_size += in_t2;
+	}
+	return t1_size == state->t1_size && t2_size == state->t2_size ? SUCCESS : FORM_ERROR;
+}
+
+const policy_ops_t arc_policy_ops =
+{
+	"arc", arc_initialize, arc_uninitialize, arc_hit, arc_insert, arc_victim, arc_remove, 0, NULL, arc_save, arc_restore
+};
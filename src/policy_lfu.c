@@ -0,0 +1,156 @@
+#include <stdlib.h>
+
+#include "../include/heap.h"
+#include "../include/policy.h"
+
+/**
+  * The number of low bits of a heap key used for the time of the last reference, which breaks ties
+  * between items referenced equally often in favour of evicting the least recently used one
+  */
+#define LFU_TIME_BITS 40
+#define LFU_TIME_MASK (((uint64_t) 1 << LFU_TIME_BITS) - 1)
+#define LFU_MAX_COUNT (((uint64_t) 1 << (64 - LFU_TIME_BITS)) - 1)
+
+/**
+  * The state of the LFU policy: a min-heap of slots keyed by reference count, the count of every
+  * slot, and a clock of references
+  */
+typedef struct
+{
+	heap_t heap;
+	uint64_t *counts;
+	uint64_t time;
+} lfu_state_t;
+
+/**
+  * Returns the heap key for a slot with the given reference count, last referenced now
+  * @param state the LFU state
+  * @param count the reference count of the slot
+  * @return the heap key
+  */
+static uint64_t lfu_key(lfu_state_t *state, uint64_t count)
+{
+	state->time++;
+	return (count << LFU_TIME_BITS) | (state->time & LFU_TIME_MASK);
+}
+
+/**
+  * Evicts the item referenced the fewest times since it was brought in, keeping the slots in a heap
+  * ordered by reference count so that both references and evictions cost O(log capacity)
+  */
+static status_t lfu_initialize(policy_t *policy)
+{
+	lfu_state_t *state = malloc(sizeof *state);
+	if (state == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	if ((state->counts = calloc(policy->capacity, sizeof *state->counts)) == NULL)
+	{
+		free(state);
+		return ALOC_ERROR;
+	}
+
+	heap_initialize(&state->heap, policy->capacity);
+	state->time = 0;
+	policy->state = state;
+	return SUCCESS;
+}
+
+static void lfu_uninitialize(policy_t *policy)
+{
+	lfu_state_t *state = policy->state;
+	heap_uninitialize(&state->heap);
+	free(state->counts);
+	free(state);
+}
+
+static void lfu_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+	lfu_state_t *state = policy->state;
+	if (state->counts[slot] < LFU_MAX_COUNT)
+	{
+		state->counts[slot]++;
+	}
+	heap_update(&state->heap, slot, lfu_key(state, state->counts[slot]));
+}
+
+static void lfu_insert(policy_t *policy, int slot, uint64_t key, uint8_t is_write)
+{
+	lfu_state_t *state = policy->state;
+	state->counts[slot] = 1;
+	heap_push(&state->heap, slot, lfu_key(state, state->counts[slot]));
+}
+
+static int lfu_victim(policy_t *policy, uint64_t key)
+{
+	lfu_state_t *state = policy->state;
+	return heap_pop(&state->heap);
+}
+
+static void lfu_remove(policy_t *policy, int slot)
+{
+	lfu_state_t *state = policy->state;
+	heap_remove(&state->heap, slot);
+}
+
+static void lfu_save(policy_t *policy, snapshot_writer_t *writer)
+{
+	lfu_state_t *state = policy->state;
+	snapshot_write(writer, state->heap.ids, policy->capacity * sizeof *state->heap.ids);
+	snapshot_write(writer, state->heap.positions, policy->capacity * sizeof *state->heap.positions);
+	snapshot_write(writer, state->heap.keys, policy->capacity * sizeof *state->heap.keys);
+	snapshot_write(writer, &state->heap.size, sizeof state->heap.size);
+	snapshot_write(writer, state->counts, policy->capacity * sizeof *state->counts);
+	snapshot_write(writer, &state->time, sizeof state->time);
+}
+
+static status_t lfu_restore(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied)
+{
+	//the heap is restored as it was laid out, so that equal keys still come out in the same order
+	lfu_state_t *state = policy->state;
+	snapshot_read(reader, state->heap.ids, policy->capacity * sizeof *state->heap.ids);
+	snapshot_read(reader, state->heap.positions, policy->capacity * sizeof *state->heap.positions);
+	snapshot_read(reader, state->heap.keys, policy->capacity * sizeof *state->heap.keys);
+	snapshot_read(reader, &state->heap.size, sizeof state->heap.size);
+	snapshot_read(reader, state->counts, policy->capacity * sizeof *state->counts);
+	snapshot_read(reader, &state->time, sizeof state->time);
+
+	//every position of the heap must hold an occupied slot which knows it is there, no slot may
+	//sort before its parent, and a slot missing from the heap must be empty
+	heap_t *heap = &state->heap;
+	if (heap->size < 0 || heap->size > policy->capacity)
+	{
+		return FORM_ERROR;
+	}
+	int position;
+	for (position = 0; position < heap->size; position++)
+	{
+		int slot = heap->ids[position];
+		if (slot < 0 || slot >= policy->capacity || heap->positions[slot] != position || !occupied[slot] ||
+			(position > 0 && heap->keys[slot] < heap->keys[heap->ids[(position - 1) / 2]]))
+		{
+			return FORM_ERROR;
+		}
+	}
+	int missing = heap->size;
+	int slot;
+	for (slot = 0; slot < policy->capacity; slot++)
+	{
+		if (occupied[slot])
+		{
+			missing--;
+		}
+		else if (heap_contains(heap, slot))
+		{
+			return FORM_ERROR;
+		}
+	}
+	return missing == 0 ? SUCCESS : FORM_ERROR;
+}
+
+const policy_ops_t lfu_policy_ops =
+{
+	"lfu", lfu_initialize, lfu_uninitialize, lfu_hit, lfu_insert, lfu_victim, lfu_remove, 0, NULL, lfu_save, lfu_restore
+};
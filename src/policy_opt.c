@@ -0,0 +1,64 @@
+#include <stdlib.h>
+
+#include "../include/heap.h"
+#include "../include/policy.h"
+
+/**
+  * Returns the heap key which puts the slot whose page is next used furthest in the future at the
+  * top of the min-heap
+  * @param policy the OPT policy
+  * @return the heap key for the page of the reference currently being simulated
+  */
+static uint64_t opt_key(policy_t *policy)
+{
+	return ~(uint64_t) policy->next_use[*policy->position];
+}
+
+/**
+  * Belady's optimal offline policy, which evicts the item whose next reference lies furthest in the
+  * future. The slots are kept in a heap keyed by the index of their next reference, taken from the
+  * next-use index of the trace, so that each reference and each eviction costs O(log capacity)
+  */
+static status_t opt_initialize(policy_t *policy)
+{
+	heap_t *heap = malloc(sizeof *heap);
+	if (heap == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	heap_initialize(heap, policy->capacity);
+	policy->state = heap;
+	return SUCCESS;
+}
+
+static void opt_uninitialize(policy_t *policy)
+{
+	heap_uninitialize(policy->state);
+	free(policy->state);
+}
+
+static void opt_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+	heap_update(policy->state, slot, opt_key(policy));
+}
+
+static void opt_insert(policy_t *policy, int slot, uint64_t key, uint8_t is_write)
+{
+	heap_push(policy->state, slot, opt_key(policy));
+}
+
+static int opt_victim(policy_t *policy, uint64_t key)
+{
+	return heap_pop(policy->state);
+}
+
+static void opt_remove(policy_t *policy, int slot)
+{
+	heap_remove(policy->state, slot);
+}
+
+const policy_ops_t opt_policy_ops =
+{
+	"opt", opt_initialize, opt_uninitialize, opt_hit, opt_insert, opt_victim, opt_remove, 1, NULL, NULL, NULL
+};
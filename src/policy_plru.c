@@ -0,0 +1,126 @@
+#include <stdlib.h>
+
+#include "../include/policy.h"
+
+/**
+  * The state of the tree pseudo-LRU policy used by hardware caches and TLBs. The slots are the
+  * leaves of a binary tree with one bit per internal node, pointing towards the half that was used
+  * less recently. A reference flips the bits on the path from its leaf to point away from it, and
+  * the victim is found by following the bits down from the root, so both cost O(log capacity) and
+  * the whole state is capacity - 1 bits. The tree is rounded up to a power of two leaves, and a walk
+  * never turns towards a half holding only leaves beyond the capacity
+  */
+typedef struct
+{
+	int leaves;
+	uint64_t bits[];
+} plru_state_t;
+
+#define PLRU_WORD_BITS 64
+
+static int plru_get(plru_state_t *state, int node)
+{
+	return (state->bits[node / PLRU_WORD_BITS] >> (node % PLRU_WORD_BITS)) & 1;
+}
+
+static void plru_set(plru_state_t *state, int node, int bit)
+{
+	uint64_t mask = (uint64_t) 1 << (node % PLRU_WORD_BITS);
+	state->bits[node / PLRU_WORD_BITS] = bit ? state->bits[node / PLRU_WORD_BITS] | mask : state->bits[node / PLRU_WORD_BITS] & ~mask;
+}
+
+/**
+  * Points every bit on the path from the root to a slot's leaf either towards or away from it
+  * @param policy  the PLRU policy
+  * @param slot    the slot
+  * @param towards whether the bits should point towards the slot, making it the next victim
+  */
+static void plru_point(policy_t *policy, int slot, int towards)
+{
+	plru_state_t *state = policy->state;
+	int node;
+	for (node = state->leaves + slot; node > 1; node /= 2)
+	{
+		//node is the right child of its parent when it is odd, which a bit of 1 points towards
+		plru_set(state, node / 2, towards ? node & 1 : !(node & 1));
+	}
+}
+
+static status_t plru_initialize(policy_t *policy)
+{
+	int leaves = 1;
+	while (leaves < policy->capacity)
+	{
+		leaves *= 2;
+	}
+
+	plru_state_t *state = calloc(1, sizeof *state + (leaves / PLRU_WORD_BITS + 1) * sizeof *state->bits);
+	if (state == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	state->leaves = leaves;
+	policy->state = state;
+	return SUCCESS;
+}
+
+static void plru_uninitialize(policy_t *policy)
+{
+	free(policy->state);
+}
+
+static void plru_hit(policy_t *policy, int slot, uint8_t is_write)
+{
+	plru_point(policy, slot, 0);
+}
+
+static void plru_insert(policy_t *policy, int slot, uint64_t key, uint8_t is_write)
+{
+	plru_point(policy, slot, 0);
+}
+
+static int plru_victim(policy_t *policy, uint64_t key)
+{
+	plru_state_t *state = policy->state;
+	int node = 1;
+	while (node < state->leaves)
+	{
+		int child = 2 * node + plru_get(state, node);
+
+		//the leftmost leaf under the right child lies beyond the capacity exactly when every leaf
+		//under it does
+		int leftmost = child;
+		while (leftmost < state->leaves)
+		{
+			leftmost *= 2;
+		}
+		node = leftmost - state->leaves < policy->capacity ? child : 2 * node;
+	}
+	return node - state->leaves;
+}
+
+static void plru_remove(policy_t *policy, int slot)
+{
+	plru_point(policy, slot, 1);
+}
+
+static void plru_save(policy_t *policy, snapshot_writer_t *writer)
+{
+	plru_state_t *state = policy->state;
+	snapshot_write(writer, state->bits, (state->leaves / PLRU_WORD_BITS + 1) * sizeof *state->bits);
+}
+
+static status_t plru_restore(policy_t *policy, snapshot_reader_t *reader, const uint8_t *occupied)
+{
+	//every pattern of bits is one the tree could have reached, and it keeps no record of which
+	//slots are occupied
+	plru_state_t *state = policy->state;
+	snapshot_read(reader, state->bits, (state->leaves / PLRU_WORD_BITS + 1) * sizeof *state->bits);
+	return SUCCESS;
+}
+
+const policy_ops_t plru_policy_ops =
+{
+	"plru", plru_initialize, plru_uninitialize, plru_hit, plru_insert, plru_victim, plru_remove, 0, NULL, plru_save, plru_restore
+};
@@ -0,0 +1,70 @@
+#include <stdlib.h>
+
+#include "../include/prefetch.h"
+
+status_t prefetch_initialize(prefetch_t *prefetch, size_t number_streams, size_t degree)
+{
+	if (degree > MAX_PREFETCH_DEGREE)
+	{
+		return OPTN_ERROR;
+	}
+
+	if ((prefetch->streams = calloc(number_streams, sizeof *prefetch->streams)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	prefetch->number_streams = number_streams;
+	prefetch->degree = degree;
+	return SUCCESS;
+}
+
+void prefetch_uninitialize(prefetch_t *prefetch)
+{
+	free(prefetch->streams);
+	prefetch->streams = NULL;
+	prefetch->number_streams = 0;
+}
+
+size_t prefetch_observe(prefetch_t *prefetch, size_t stream, uint64_t page, uint64_t number_pages, uint64_t *predicted)
+{
+	prefetch_stream_t *state = &prefetch->streams[stream];
+	if (!state->started)
+	{
+		state->started = 1;
+		state->last = page;
+		return 0;
+	}
+
+	//a sequential scan is recognised from two neighbouring pages, any other stride from three
+	//evenly spaced ones; anything else starts the count again from the new distance
+	int64_t stride = (int64_t) (page - state->last);
+	if (stride != 0 && stride == state->stride)
+	{
+		state->confidence++;
+	}
+	else
+	{
+		state->stride = stride;
+		state->confidence = stride == 1 || stride == -1 ? 1 : 0;
+	}
+	state->last = page;
+
+	if (state->confidence == 0 || state->stride == 0)
+	{
+		return 0;
+	}
+
+	//stop at either end of the address space
+	size_t count;
+	uint64_t next = page;
+	for (count = 0; count < prefetch->degree; count++)
+	{
+		next += state->stride;
+		if (next >= number_pages)
+		{
+			break;
+		}
+		predicted[count] = next;
+	}
+	return count;
+}
@@ -0,0 +1,184 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/resident_set.h"
+
+static const char *resident_policy_names[] = { "off", "fixed", "ws", "pff" };
+
+/**
+  * Unlinks a node from the list it is in
+  * @param rs   the resident sets
+  * @param node the node
+  */
+static void unlink_node(resident_set_t *rs, int32_t node);
+
+/**
+  * Links a node in at the head of the list of a process, as its most recently referenced frame
+  * @param rs      the resident sets
+  * @param process the process
+  * @param node    the node
+  */
+static void link_first(resident_set_t *rs, uint32_t process, int32_t node);
+
+status_t resident_policy_find(const char *name, resident_policy_t *policy)
+{
+	size_t i;
+	for (i = 0; i < sizeof resident_policy_names / sizeof *resident_policy_names; i++)
+	{
+		if (strcmp(name, resident_policy_names[i]) == 0)
+		{
+			*policy = i;
+			return SUCCESS;
+		}
+	}
+
+	return OPTN_ERROR;
+}
+
+status_t resident_set_initialize(resident_set_t *rs, resident_policy_t policy, uint64_t window, size_t number_frames, size_t number_processes)
+{
+	rs->policy = policy;
+	rs->window = window;
+	rs->number_frames = number_frames;
+	rs->number_processes = number_processes;
+	rs->in_use = 0;
+	rs->peak = 0;
+	rs->time = 0;
+	rs->space_time = 0;
+	rs->number_samples = 0;
+	rs->interval = 1;
+
+	size_t nodes = number_frames + number_processes;
+	rs->next = malloc(nodes * sizeof *rs->next);
+	rs->prev = malloc(nodes * sizeof *rs->prev);
+	rs->owner = malloc(number_frames * sizeof *rs->owner);
+	rs->last_reference = malloc(number_frames * sizeof *rs->last_reference);
+	rs->processes = calloc(number_processes, sizeof *rs->processes);
+	if (rs->next == NULL || rs->prev == NULL || rs->owner == NULL || rs->last_reference == NULL || rs->processes == NULL)
+	{
+		resident_set_uninitialize(rs);
+		return ALOC_ERROR;
+	}
+
+	//every list starts out empty, its head pointing at itself
+	size_t process;
+	for (process = 0; process < number_processes; process++)
+	{
+		int32_t head = number_frames + process;
+		rs->next[head] = head;
+		rs->prev[head] = head;
+	}
+
+	return SUCCESS;
+}
+
+void resident_set_uninitialize(resident_set_t *rs)
+{
+	free(rs->processes);
+	free(rs->last_reference);
+	free(rs->owner);
+	free(rs->prev);
+	free(rs->next);
+}
+
+void resident_set_insert(resident_set_t *rs, uint32_t process, uint32_t frame)
+{
+	resident_process_t *resident = &rs->processes[process];
+	rs->owner[frame] = process;
+	rs->last_reference[frame] = resident->clock;
+	link_first(rs, process, frame);
+
+	rs->in_use++;
+	if (rs->in_use > rs->peak)
+	{
+		rs->peak = rs->in_use;
+	}
+	resident->resident++;
+	if (resident->resident > resident->peak)
+	{
+		resident->peak = resident->resident;
+	}
+}
+
+void resident_set_remove(resident_set_t *rs, uint32_t frame)
+{
+	unlink_node(rs, frame);
+	rs->in_use--;
+	rs->processes[rs->owner[frame]].resident--;
+}
+
+uint64_t resident_set_reference(resident_set_t *rs, uint32_t process, uint32_t frame, uint8_t faulted)
+{
+	resident_process_t *resident = &rs->processes[process];
+	resident->clock++;
+	resident->space_time += resident->resident;
+	rs->last_reference[frame] = resident->clock;
+	unlink_node(rs, frame);
+	link_first(rs, process, frame);
+
+	//keep at most RESIDENT_SAMPLES of the frames in use, evenly spaced over the run so far
+	rs->time++;
+	rs->space_time += rs->in_use;
+	if (rs->time % rs->interval == 0)
+	{
+		if (rs->number_samples == RESIDENT_SAMPLES)
+		{
+			size_t i;
+			for (i = 0; i < RESIDENT_SAMPLES / 2; i++)
+			{
+				rs->samples[i] = rs->samples[2 * i + 1];
+			}
+			rs->number_samples = RESIDENT_SAMPLES / 2;
+			rs->interval *= 2;
+		}
+		if (rs->time % rs->interval == 0)
+		{
+			rs->samples[rs->number_samples++] = rs->in_use;
+		}
+	}
+
+	switch (rs->policy)
+	{
+		case RESIDENT_WS:
+			//the working set is the pages referenced in the last window references, this one included
+			return resident->clock > rs->window ? resident->clock - rs->window + 1 : 0;
+		case RESIDENT_PFF:
+		{
+			if (!faulted)
+			{
+				return 0;
+			}
+			uint64_t previous = resident->last_fault;
+			resident->last_fault = resident->clock;
+			return resident->clock - previous > rs->window ? previous : 0;
+		}
+		default:
+			return 0;
+	}
+}
+
+int32_t resident_set_expired(resident_set_t *rs, uint32_t process, uint64_t cutoff)
+{
+	int32_t last = rs->prev[rs->number_frames + process];
+	if (last == (int32_t) (rs->number_frames + process) || rs->last_reference[last] >= cutoff)
+	{
+		return RESIDENT_NONE;
+	}
+
+	return last;
+}
+
+static void unlink_node(resident_set_t *rs, int32_t node)
+{
+	rs->next[rs->prev[node]] = rs->next[node];
+	rs->prev[rs->next[node]] = rs->prev[node];
+}
+
+static void link_first(resident_set_t *rs, uint32_t process, int32_t node)
+{
+	int32_t head = rs->number_frames + process;
+	rs->next[node] = rs->next[head];
+	rs->prev[node] = head;
+	rs->prev[rs->next[head]] = node;
+	rs->next[head] = node;
+}
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+
+#include "../include/schedule.h"
+
+/**
+  * Passes the turn on to the next process which still has references, with a fresh quantum
+  * @param schedule the schedule
+  */
+static void schedule_advance(schedule_t *schedule)
+{
+	if (schedule->active > 0)
+	{
+		do
+		{
+			schedule->current = (schedule->current + 1) % schedule->number;
+		}
+		while (schedule->finished[schedule->current]);
+	}
+	schedule->remaining = schedule->quantum;
+}
+
+status_t schedule_open(schedule_t *schedule, char **paths, size_t number, size_t quantum, unsigned int address_bits)
+{
+	schedule->files = malloc(number * sizeof *schedule->files);
+	schedule->traces = malloc(number * sizeof *schedule->traces);
+	schedule->positions = calloc(number, sizeof *schedule->positions);
+	schedule->finished = calloc(number, sizeof *schedule->finished);
+	if (schedule->files == NULL || schedule->traces == NULL || schedule->positions == NULL || schedule->finished == NULL)
+	{
+		free(schedule->files);
+		free(schedule->traces);
+		free(schedule->positions);
+		free(schedule->finished);
+		return ALOC_ERROR;
+	}
+
+	size_t i;
+	for (i = 0; i < number; i++)
+	{
+		status_t error;
+		if ((error = trace_open(&schedule->files[i], paths[i])) != SUCCESS)
+		{
+			schedule->number = i;
+			schedule_close(schedule);
+			return error;
+		}
+		trace_initialize(&schedule->traces[i]);
+	}
+
+	schedule->number = number;
+	schedule->quantum = quantum;
+	schedule->current = 0;
+	schedule->remaining = quantum;
+	schedule->active = number;
+	schedule->address_bits = address_bits;
+	trace_initialize(&schedule->merged);
+	return SUCCESS;
+}
+
+void schedule_close(schedule_t *schedule)
+{
+	size_t i;
+	for (i = 0; i < schedule->number; i++)
+	{
+		trace_uninitialize(&schedule->traces[i]);
+		trace_close(&schedule->files[i]);
+	}
+	trace_uninitialize(&schedule->merged);
+	free(schedule->finished);
+	free(schedule->positions);
+	free(schedule->traces);
+	free(schedule->files);
+}
+
+status_t schedule_read(schedule_t *schedule, size_t max, trace_t **batch)
+{
+	status_t error;
+	if (schedule->number == 1)
+	{
+		*batch = &schedule->traces[0];
+		return trace_read(&schedule->traces[0], &schedule->files[0], max);
+	}
+
+	trace_t *merged = &schedule->merged;
+	uint64_t address_mask = ((uint64_t) 1 << schedule->address_bits) - 1;
+	merged->length = 0;
+	*batch = merged;
+	while (merged->length < max && schedule->active > 0)
+	{
+		size_t p = schedule->current;
+		trace_t *trace = &schedule->traces[p];
+		if (schedule->positions[p] == trace->length)
+		{
+			if ((error = trace_read(trace, &schedule->files[p], max == TRACE_ALL ? TRACE_ALL : TRACE_BATCH)) != SUCCESS)
+			{
+				return error;
+			}
+			schedule->positions[p] = 0;
+
+			if (trace->length == 0)
+			{
+				schedule->finished[p] = 1;
+				schedule->active--;
+				schedule_advance(schedule);
+				continue;
+			}
+		}
+
+		size_t count = trace->length - schedule->positions[p];
+		if (count > schedule->remaining)
+		{
+			count = schedule->remaining;
+		}
+		if (count > max - merged->length)
+		{
+			count = max - merged->length;
+		}
+
+		size_t i;
+		for (i = schedule->positions[p]; i < schedule->positions[p] + count; i++)
+		{
+			if ((error = trace_append(merged, ((uint64_t) p << schedule->address_bits) | (trace->addresses[i] & address_mask), trace->writes[i])) != SUCCESS)
+			{
+				return error;
+			}
+		}
+		schedule->positions[p] += count;
+
+		if ((schedule->remaining -= count) == 0)
+		{
+			schedule_advance(schedule);
+		}
+	}
+
+	return SUCCESS;
+}
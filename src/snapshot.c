@@ -0,0 +1,148 @@
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/snapshot.h"
+
+/**
+  * The bytes of a snapshot before its first field: the magic, then the version as a 32-bit number
+  * and 32 bits of padding
+  */
+#define SNAPSHOT_HEADER 16
+
+/**
+  * Returns the number of bytes a field takes up in a snapshot, once padded
+  * @param bytes the number of bytes in the field
+  * @return the bytes rounded up to a multiple of SNAPSHOT_ALIGN
+  */
+static size_t snapshot_padded(size_t bytes);
+
+status_t snapshot_create(snapshot_writer_t *writer, const char *path)
+{
+	writer->offset = 0;
+	writer->error = SUCCESS;
+	if ((writer->file = fopen(path, "wb")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+
+	uint8_t header[SNAPSHOT_HEADER] = { 0 };
+	uint32_t version = SNAPSHOT_VERSION;
+	memcpy(header, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC - 1);
+	memcpy(header + sizeof SNAPSHOT_MAGIC - 1, &version, sizeof version);
+	snapshot_write(writer, header, sizeof header);
+	return writer->error;
+}
+
+void snapshot_write(snapshot_writer_t *writer, const void *data, size_t bytes)
+{
+	static const uint8_t padding[SNAPSHOT_ALIGN] = { 0 };
+	size_t padded = snapshot_padded(bytes);
+	if (writer->error != SUCCESS)
+	{
+		return;
+	}
+
+	if (fwrite(data, 1, bytes, writer->file) != bytes || fwrite(padding, 1, padded - bytes, writer->file) != padded - bytes)
+	{
+		writer->error = WRIT_ERROR;
+		return;
+	}
+	writer->offset += padded;
+}
+
+status_t snapshot_finish(snapshot_writer_t *writer)
+{
+	if (fclose(writer->file) != 0 && writer->error == SUCCESS)
+	{
+		writer->error = WRIT_ERROR;
+	}
+	return writer->error;
+}
+
+status_t snapshot_open(snapshot_reader_t *reader, const char *path)
+{
+	reader->data = NULL;
+	reader->length = 0;
+	reader->offset = 0;
+	reader->error = SUCCESS;
+
+	int fd;
+	if ((fd = open(path, O_RDONLY)) < 0)
+	{
+		return OPEN_ERROR;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) < 0)
+	{
+		close(fd);
+		return OPEN_ERROR;
+	}
+	if (info.st_size < SNAPSHOT_HEADER)
+	{
+		close(fd);
+		return FORM_ERROR;
+	}
+
+	//the mapping outlives the descriptor, and is private so that nothing read from it can change
+	//the file
+	void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		return READ_ERROR;
+	}
+	reader->data = map;
+	reader->length = info.st_size;
+
+	uint32_t version;
+	memcpy(&version, reader->data + sizeof SNAPSHOT_MAGIC - 1, sizeof version);
+	if (memcmp(reader->data, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC - 1) != 0 || version != SNAPSHOT_VERSION)
+	{
+		snapshot_close(reader);
+		return FORM_ERROR;
+	}
+	reader->offset = SNAPSHOT_HEADER;
+	return SUCCESS;
+}
+
+const void *snapshot_section(snapshot_reader_t *reader, size_t bytes)
+{
+	size_t padded = snapshot_padded(bytes);
+	if (reader->error != SUCCESS || padded < bytes || reader->length - reader->offset < padded)
+	{
+		reader->error = FORM_ERROR;
+		return NULL;
+	}
+
+	const void *section = reader->data + reader->offset;
+	reader->offset += padded;
+	return section;
+}
+
+void snapshot_read(snapshot_reader_t *reader, void *data, size_t bytes)
+{
+	const void *section;
+	if ((section = snapshot_section(reader, bytes)) != NULL)
+	{
+		memcpy(data, section, bytes);
+	}
+}
+
+status_t snapshot_close(snapshot_reader_t *reader)
+{
+	if (reader->data != NULL)
+	{
+		munmap(reader->data, reader->length);
+		reader->data = NULL;
+	}
+	return reader->error;
+}
+
+static size_t snapshot_padded(size_t bytes)
+{
+	return (bytes + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
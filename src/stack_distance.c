@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include "../include/stack_distance.h"
+
+#define MIN_CAPACITY 1024
+
+/**
+  * Adds delta to the mark count of a slot in the Fenwick tree
+  * @param sd    the stack distance tracker
+  * @param slot  the slot, counting from 0
+  * @param delta the amount to add
+  */
+static void stack_distance_add(stack_distance_t *sd, size_t slot, int32_t delta);
+
+/**
+  * Returns the number of marked slots from slot 0 up to and including the given slot
+  * @param sd   the stack distance tracker
+  * @param slot the last slot to count
+  * @return the number of marked slots
+  */
+static size_t stack_distance_prefix(stack_distance_t *sd, size_t slot);
+
+/**
+  * Renumbers the marked slots densely from 0 in the same order, growing the tree if more than
+  * half of it would still be in use, and rebuilds the tree
+  * @param sd the stack distance tracker
+  * @return an indication of whether an error occurred
+  */
+static status_t stack_distance_compact(stack_distance_t *sd);
+
+status_t stack_distance_initialize(stack_distance_t *sd)
+{
+	status_t error;
+	if ((error = hash_map_initialize(&sd->last_slot, MIN_CAPACITY)) != SUCCESS)
+	{
+		return error;
+	}
+
+	sd->capacity = MIN_CAPACITY;
+	sd->tree = calloc(sd->capacity + 1, sizeof *sd->tree);
+	sd->slot_pages = malloc(sd->capacity * sizeof *sd->slot_pages);
+	if (sd->tree == NULL || sd->slot_pages == NULL)
+	{
+		free(sd->tree);
+		free(sd->slot_pages);
+		hash_map_uninitialize(&sd->last_slot);
+		return ALOC_ERROR;
+	}
+
+	sd->next = 0;
+	sd->live = 0;
+	return SUCCESS;
+}
+
+void stack_distance_uninitialize(stack_distance_t *sd)
+{
+	free(sd->slot_pages);
+	free(sd->tree);
+	hash_map_uninitialize(&sd->last_slot);
+}
+
+status_t stack_distance_access(stack_distance_t *sd, uint64_t page, uint64_t *distance)
+{
+	status_t error;
+	if (sd->next == sd->capacity && (error = stack_distance_compact(sd)) != SUCCESS)
+	{
+		return error;
+	}
+
+	size_t slot = sd->next++;
+	uint64_t *last = hash_map_find(&sd->last_slot, page);
+	if (last == NULL)
+	{
+		*distance = STACK_DISTANCE_INFINITE;
+		sd->live++;
+		if ((error = hash_map_put(&sd->last_slot, page, slot)) != SUCCESS)
+		{
+			return error;
+		}
+	}
+	else
+	{
+		//every marked slot after the previous reference belongs to a distinct page referenced since
+		*distance = sd->live - stack_distance_prefix(sd, *last);
+		stack_distance_add(sd, *last, -1);
+		*last = slot;
+	}
+
+	stack_distance_add(sd, slot, 1);
+	sd->slot_pages[slot] = page;
+	return SUCCESS;
+}
+
+static void stack_distance_add(stack_distance_t *sd, size_t slot, int32_t delta)
+{
+	size_t i;
+	for (i = slot + 1; i <= sd->capacity; i += i & -i)
+	{
+		sd->tree[i] += delta;
+	}
+}
+
+static size_t stack_distance_prefix(stack_distance_t *sd, size_t slot)
+{
+	size_t count = 0;
+	size_t i;
+	for (i = slot + 1; i > 0; i -= i & -i)
+	{
+		count += sd->tree[i];
+	}
+	return count;
+}
+
+static status_t stack_distance_compact(stack_distance_t *sd)
+{
+	//the live slots are exactly those whose page still maps back to them
+	size_t live = 0;
+	size_t i;
+	for (i = 0; i < sd->next; i++)
+	{
+		uint64_t *last = hash_map_find(&sd->last_slot, sd->slot_pages[i]);
+		if (*last == i)
+		{
+			*last = live;
+			sd->slot_pages[live++] = sd->slot_pages[i];
+		}
+	}
+
+	if (2 * live > sd->capacity)
+	{
+		size_t capacity = 2 * sd->capacity;
+		uint32_t *tree = realloc(sd->tree, (capacity + 1) * sizeof *tree);
+		if (tree == NULL)
+		{
+			return ALOC_ERROR;
+		}
+		sd->tree = tree;
+
+		uint64_t *slot_pages = realloc(sd->slot_pages, capacity * sizeof *slot_pages);
+		if (slot_pages == NULL)
+		{
+			return ALOC_ERROR;
+		}
+		sd->slot_pages = slot_pages;
+		sd->capacity = capacity;
+	}
+
+	//rebuild the tree with slots 0 to live - 1 marked, in O(capacity)
+	for (i = 1; i <= sd->capacity; i++)
+	{
+		sd->tree[i] = i <= live ? 1 : 0;
+	}
+	for (i = 1; i <= sd->capacity; i++)
+	{
+		size_t parent = i + (i & -i);
+		if (parent <= sd->capacity)
+		{
+			sd->tree[parent] += sd->tree[i];
+		}
+	}
+
+	sd->next = live;
+	return SUCCESS;
+}
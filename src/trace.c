@@ -0,0 +1,673 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "../include/hash_map.h"
+#include "../include/trace.h"
+
+#define EXTRA_CHARS 1
+
+#define ASCII_0 48
+
+#define MIN_CAPACITY 1024
+
+/**
+  * The most hexadecimal digits in the address of a lackey record
+  */
+#define LACKEY_DIGITS 16
+
+/**
+  * The most digits converted at once by the vectorized parser, which is the width of an SSE2
+  * register
+  */
+#define VECTOR_DIGITS 16
+
+/**
+  * The number of bytes searched for newlines at once, one bit for each in a 64-bit mask
+  */
+#define NEWLINE_BLOCK 64
+
+/**
+  * Given a string of a particular length, converts it to an address value
+  * @param line   the string to be converted
+  * @param length the length of the string
+  * @param value  the out parameter which will hold the calculated address
+  * @return an indication of whether an error occurred
+  */
+static status_t convert(const char *line, size_t length, uint64_t *value);
+
+/**
+  * Converts a run of decimal digits to an address value, sixteen digits at a time with SSE2 where
+  * it is available. The vectorized conversion loads the sixteen bytes ending at the last digit, so
+  * the caller must make sure that they can all be read
+  * @param s      the digits to be converted
+  * @param length the number of digits
+  * @param value  the out parameter which will hold the calculated address
+  * @return an indication of whether an error occurred
+  */
+static status_t convert_digits(const char *s, size_t length, uint64_t *value);
+
+/**
+  * Works out the extent of the address in a line of an address file and whether it is a write
+  * @param line     the line, including its line ending
+  * @param length   the length of the line
+  * @param is_write out param which will hold whether the reference is a write
+  * @return the number of characters making up the address, which is 0 or less for a line with no
+  * address
+  */
+static ssize_t trim_line(const char *line, size_t length, uint8_t *is_write);
+
+/**
+  * Converts a line printed by lackey into the references it makes, appending them to the trace.
+  * A record which makes no reference, an instruction fetch or a line of Valgrind's own, appends
+  * nothing
+  * @param trace  the trace to append to
+  * @param line   the line, including its line ending
+  * @param length the length of the line
+  * @return an indication of whether an error occurred, NUMB_ERROR if the line is not of lackey's
+  */
+static status_t append_lackey(trace_t *trace, const char *line, size_t length);
+
+/**
+  * Converts the line of an address file that could not be converted as an address as a record
+  * of lackey's instead, and reports it if it is not one either
+  * @param trace  the trace to append to
+  * @param line   the line, including its line ending
+  * @param length the length of the line
+  * @param chars  the number of characters the address was taken to be made up of
+  * @return an indication of whether an error occurred
+  */
+static status_t append_other(trace_t *trace, const char *line, size_t length, ssize_t chars);
+
+/**
+  * Reports a line of an address file which could not be converted
+  * @param line   the line
+  * @param length the number of characters making up the address
+  */
+static void report_line(const char *line, ssize_t length);
+
+/**
+  * Finds the newlines among the NEWLINE_BLOCK bytes from s, sixteen bytes at a time with SSE2 where
+  * it is available, so that the lines of a whole block are found at once
+  * @param s   the first byte to search
+  * @param end one past the last byte which may be searched
+  * @return a mask with bit i set if s[i] is a newline
+  */
+static uint64_t newline_mask(const char *s, const char *end);
+
+/**
+  * Reads the next references from a mapped text address file, finding and converting whole lines
+  * in place rather than copying each one out through stdio
+  * @param trace the trace to fill
+  * @param fin   the mapped address file
+  * @param max   the most references to read
+  * @return an indication of whether an error occurred
+  */
+static status_t read_mapped_text(trace_t *trace, trace_file_t *fin, size_t max);
+
+/**
+  * Reads the next references from an address file which could not be mapped, through its buffer.
+  * Unless the whole file is to be read, returns as soon as the buffer has no whole line left and
+  * at least one reference was read, rather than waiting for more to arrive
+  * @param trace the trace to fill
+  * @param fin   the address file
+  * @param max   the most references to read
+  * @return an indication of whether an error occurred
+  */
+static status_t read_stream_text(trace_t *trace, trace_file_t *fin, size_t max);
+
+/**
+  * Makes sure the trace has room for at least the given number of references
+  * @param trace    the trace
+  * @param capacity the number of references needed
+  * @return an indication of whether an error occurred
+  */
+static status_t trace_reserve(trace_t *trace, size_t capacity);
+
+status_t trace_open(trace_file_t *fin, const char *path)
+{
+	fin->map = NULL;
+	fin->size = 0;
+	fin->position = 0;
+	fin->binary = 0;
+	fin->count = 0;
+	fin->buffer = NULL;
+	fin->buffered = 0;
+	if ((fin->file = strcmp(path, "-") == 0 ? stdin : fopen(path, "r")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+
+	struct stat info;
+	if (fstat(fileno(fin->file), &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+	{
+		void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fileno(fin->file), 0);
+		if (map != MAP_FAILED)
+		{
+			madvise(map, info.st_size, MADV_SEQUENTIAL);
+			fin->map = map;
+			fin->size = info.st_size;
+		}
+	}
+
+	if (fin->map == NULL)
+	{
+		//a binary trace has to be mapped, since its writes follow all of its addresses. The
+		//stream is read straight from its descriptor, so that whatever has arrived can be had
+		//without waiting for stdio to fill its buffer
+		ssize_t got;
+		if ((fin->buffer = malloc(TRACE_STREAM_BYTES)) == NULL)
+		{
+			fclose(fin->file);
+			return ALOC_ERROR;
+		}
+		while ((got = read(fileno(fin->file), fin->buffer, TRACE_STREAM_BYTES)) < 0 && errno == EINTR);
+		fin->buffered = got > 0 ? got : 0;
+		if (got < 0 || (got > 0 && fin->buffer[0] == TRACE_MAGIC[0]))
+		{
+			trace_close(fin);
+			return got < 0 ? READ_ERROR : FORM_ERROR;
+		}
+		return SUCCESS;
+	}
+
+	const trace_header_t *header = (const trace_header_t *) fin->map;
+	if (fin->size >= sizeof header->magic && memcmp(header->magic, TRACE_MAGIC, sizeof header->magic) == 0)
+	{
+		size_t records = (fin->size - sizeof header->magic) / (sizeof (uint64_t) + sizeof (uint8_t));
+		if (fin->size < sizeof *header || header->version != TRACE_VERSION || header->count > records ||
+			sizeof *header + header->count * (sizeof (uint64_t) + sizeof (uint8_t)) != fin->size)
+		{
+			trace_close(fin);
+			return FORM_ERROR;
+		}
+
+		fin->binary = 1;
+		fin->count = header->count;
+	}
+
+	return SUCCESS;
+}
+
+void trace_close(trace_file_t *fin)
+{
+	if (fin->map != NULL)
+	{
+		munmap((void *) fin->map, fin->size);
+	}
+	free(fin->buffer);
+	fclose(fin->file);
+}
+
+void trace_initialize(trace_t *trace)
+{
+	trace->addresses = NULL;
+	trace->writes = NULL;
+	trace->length = 0;
+	trace->capacity = 0;
+	trace->borrowed = 0;
+}
+
+void trace_uninitialize(trace_t *trace)
+{
+	if (!trace->borrowed)
+	{
+		free(trace->writes);
+		free(trace->addresses);
+	}
+}
+
+status_t trace_read(trace_t *trace, trace_file_t *fin, size_t max)
+{
+	if (!fin->binary)
+	{
+		trace->length = 0;
+		return fin->map != NULL ? read_mapped_text(trace, fin, max) : read_stream_text(trace, fin, max);
+	}
+
+	trace_uninitialize(trace);
+	trace_initialize(trace);
+
+	//the mapping is read-only, so nothing may write through the borrowed arrays
+	size_t remaining = fin->count - fin->position;
+	const char *records = fin->map + sizeof (trace_header_t);
+	trace->addresses = (uint64_t *) records + fin->position;
+	trace->writes = (uint8_t *) (records + fin->count * sizeof (uint64_t)) + fin->position;
+	trace->length = remaining < max ? remaining : max;
+	trace->capacity = trace->length;
+	trace->borrowed = 1;
+	fin->position += trace->length;
+
+	return SUCCESS;
+}
+
+status_t trace_parse_line(const char *line, size_t length, uint64_t *address, uint8_t *is_write)
+{
+	ssize_t chars_read = trim_line(line, length, is_write);
+	if (chars_read <= 0)
+	{
+		return NUMB_ERROR;
+	}
+
+	//convert the string to the address
+	return convert(line, chars_read, address);
+}
+
+status_t trace_save(trace_t *trace, const char *path)
+{
+	FILE *fout;
+	if ((fout = fopen(path, "w")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+
+	trace_header_t header;
+	memset(&header, 0, sizeof header);
+	memcpy(header.magic, TRACE_MAGIC, sizeof header.magic);
+	header.version = TRACE_VERSION;
+	header.count = trace->length;
+
+	if (fwrite(&header, sizeof header, 1, fout) < 1 ||
+		fwrite(trace->addresses, sizeof *trace->addresses, trace->length, fout) < trace->length ||
+		fwrite(trace->writes, sizeof *trace->writes, trace->length, fout) < trace->length)
+	{
+		fclose(fout);
+		return WRIT_ERROR;
+	}
+
+	return fclose(fout) == 0 ? SUCCESS : WRIT_ERROR;
+}
+
+status_t trace_next_use(trace_t *trace, unsigned int offset_bits, uint64_t page_mask, uint32_t **next_use)
+{
+	if (trace->length >= NEVER_USED)
+	{
+		return ALOC_ERROR;
+	}
+
+	uint32_t *next = malloc(trace->length * sizeof *next);
+	if (next == NULL)
+	{
+		return ALOC_ERROR;
+	}
+
+	//walking backwards, the map always holds the earliest reference seen so far to each page,
+	//which is exactly the next use of that page from the current reference
+	status_t error;
+	hash_map_t seen;
+	if ((error = hash_map_initialize(&seen, 0)) != SUCCESS)
+	{
+		free(next);
+		return error;
+	}
+
+	size_t i;
+	for (i = trace->length; i-- > 0; )
+	{
+		uint64_t page = (trace->addresses[i] >> offset_bits) & page_mask;
+		uint64_t *found = hash_map_find(&seen, page);
+		if (found != NULL)
+		{
+			next[i] = *found;
+			*found = i;
+		}
+		else
+		{
+			next[i] = NEVER_USED;
+			if ((error = hash_map_put(&seen, page, i)) != SUCCESS)
+			{
+				hash_map_uninitialize(&seen);
+				free(next);
+				return error;
+			}
+		}
+	}
+
+	hash_map_uninitialize(&seen);
+	*next_use = next;
+	return SUCCESS;
+}
+
+static status_t convert(const char *s, size_t length, uint64_t *value)
+{
+    *value = 0;
+    uint64_t power10;
+    size_t i;
+    for (i = length - 1, power10 = 1; i < SIZE_MAX; i--, power10 *= 10)
+    {
+        if (!isdigit(s[i]))
+        {
+            return NUMB_ERROR;
+        }
+        *value += (s[i] - ASCII_0) * power10;
+    }
+
+    return SUCCESS;
+}
+
+static status_t convert_digits(const char *s, size_t length, uint64_t *value)
+{
+#ifdef __SSE2__
+	if (length <= VECTOR_DIGITS)
+	{
+		//load the sixteen bytes ending at the last digit, so that the digits are right-aligned,
+		//and clear the bytes before the first digit
+		__m128i chunk = _mm_loadu_si128((const __m128i *) (s + length - VECTOR_DIGITS));
+		__m128i lanes = _mm_set_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		__m128i keep = _mm_cmpgt_epi8(lanes, _mm_set1_epi8((char) (VECTOR_DIGITS - 1 - (int) length)));
+		__m128i digits = _mm_and_si128(_mm_sub_epi8(chunk, _mm_set1_epi8(ASCII_0)), keep);
+
+		//anything other than a digit lands above 9, counting as unsigned
+		__m128i nine = _mm_set1_epi8(9);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nine), nine)) != 0xFFFF)
+		{
+			return NUMB_ERROR;
+		}
+
+		//combine neighbouring digits into pairs, pairs into groups of four and groups of four into
+		//groups of eight, each time multiplying the more significant half up and adding
+		__m128i zero = _mm_setzero_si128();
+		__m128i pairs = _mm_packs_epi32(
+			_mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), _mm_set1_epi32(0x0001000A)),
+			_mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), _mm_set1_epi32(0x0001000A)));
+		__m128i fours = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010064));
+		__m128i eights = _mm_madd_epi16(_mm_packs_epi32(fours, fours), _mm_set1_epi32(0x00012710));
+
+		uint32_t high = _mm_cvtsi128_si32(eights);
+		uint32_t low = _mm_cvtsi128_si32(_mm_srli_si128(eights, 4));
+		*value = (uint64_t) high * 100000000 + low;
+		return SUCCESS;
+	}
+#endif
+
+	return convert(s, length, value);
+}
+
+static ssize_t trim_line(const char *line, size_t length, uint8_t *is_write)
+{
+	//eliminate the newline and the carriage return as well as one for the space
+	//and the Read/Write indicator
+	ssize_t chars_read = length - EXTRA_CHARS;
+
+	//sanitize input - it cannot be assumed that the input file has a regular form - make sure
+	//to handle R/W indications and no R/W indications as well as the occasional space at the
+	//end of a line
+	if (chars_read > 0 && line[chars_read - 1] == ' ')
+	{
+		chars_read--;
+	}
+	*is_write = chars_read > 0 && line[chars_read - 1] == 'W';
+	if (chars_read > 0 && (*is_write || line[chars_read - 1] == 'R'))
+	{
+		chars_read -= 2;
+	}
+
+	return chars_read;
+}
+
+static status_t append_lackey(trace_t *trace, const char *line, size_t length)
+{
+	const char *end = line + length;
+	const char *p = line;
+	while (p < end && *p == ' ')
+	{
+		p++;
+	}
+	if (end - p >= 2 && p[0] == '=' && p[1] == '=')
+	{
+		return SUCCESS;
+	}
+
+	//the kind of the record, then its address in hexadecimal up to the comma, then its size
+	if (end - p < 2 || strchr("ILSM", *p) == NULL || p[1] != ' ')
+	{
+		return NUMB_ERROR;
+	}
+	char kind = *p;
+	for (p += 2; p < end && *p == ' '; p++);
+
+	uint64_t address = 0;
+	const char *digits = p;
+	for (; p < end && isxdigit((unsigned char) *p) && p - digits < LACKEY_DIGITS; p++)
+	{
+		address = address << 4 | (isdigit((unsigned char) *p) ? *p - ASCII_0 : tolower((unsigned char) *p) - 'a' + 10);
+	}
+	if (p == digits || p == end || *p++ != ',' || p == end || !isdigit((unsigned char) *p))
+	{
+		return NUMB_ERROR;
+	}
+	for (; p < end && isdigit((unsigned char) *p); p++);
+	for (; p < end && isspace((unsigned char) *p); p++);
+	if (p != end)
+	{
+		return NUMB_ERROR;
+	}
+
+	status_t error = SUCCESS;
+	if (kind == 'L' || kind == 'M')
+	{
+		error = trace_append(trace, address, 0);
+	}
+	if (error == SUCCESS && (kind == 'S' || kind == 'M'))
+	{
+		error = trace_append(trace, address, 1);
+	}
+	return error;
+}
+
+static status_t append_other(trace_t *trace, const char *line, size_t length, ssize_t chars)
+{
+	status_t error = append_lackey(trace, line, length);
+	if (error == NUMB_ERROR)
+	{
+		report_line(line, chars);
+		return SUCCESS;
+	}
+	return error;
+}
+
+static void report_line(const char *line, ssize_t length)
+{
+	fprintf(stderr, "%.*s\n", length > 0 ? (int) length : 0, line);
+	fprintf(stderr, "Error: could not convert string to integer.\n");
+}
+
+static uint64_t newline_mask(const char *s, const char *end)
+{
+	uint64_t mask = 0;
+#ifdef __SSE2__
+	if (end - s >= NEWLINE_BLOCK)
+	{
+		__m128i newline = _mm_set1_epi8('\n');
+		int i;
+		for (i = 0; i < NEWLINE_BLOCK; i += VECTOR_DIGITS)
+		{
+			uint64_t found = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (s + i)), newline));
+			mask |= found << i;
+		}
+		return mask;
+	}
+#endif
+
+	int i;
+	for (i = 0; i < NEWLINE_BLOCK && s + i < end; i++)
+	{
+		mask |= (uint64_t) (s[i] == '\n') << i;
+	}
+	return mask;
+}
+
+static status_t read_mapped_text(trace_t *trace, trace_file_t *fin, size_t max)
+{
+	status_t error = SUCCESS;
+	const char *line = fin->map + fin->position;
+	const char *end = fin->map + fin->size;
+	const char *block = line;
+	uint64_t mask = newline_mask(block, end);
+	while (trace->length < max && line < end)
+	{
+		//a line includes its newline, except for a last line without one, just as with getline
+		while (mask == 0 && end - block > NEWLINE_BLOCK)
+		{
+			block += NEWLINE_BLOCK;
+			mask = newline_mask(block, end);
+		}
+		const char *newline = mask != 0 ? block + __builtin_ctzll(mask) : end;
+		mask &= mask - 1;
+		size_t length = (newline < end ? newline + 1 : end) - line;
+
+		uint64_t address;
+		uint8_t is_write;
+		ssize_t chars_read;
+		if (line >= fin->map + VECTOR_DIGITS)
+		{
+			//past the first few bytes, the bytes before the line can always be read, so the
+			//suffix is stripped with arithmetic rather than with branches that the random mix of
+			//reads and writes would keep mispredicting. Lines too short to hold an address may end
+			//up with a different negative length, but are rejected all the same
+			chars_read = length - EXTRA_CHARS;
+			chars_read -= line[chars_read - 1] == ' ';
+			is_write = line[chars_read - 1] == 'W';
+			chars_read -= 2 * (is_write | (line[chars_read - 1] == 'R'));
+		}
+		else
+		{
+			chars_read = trim_line(line, length, &is_write);
+		}
+
+		if (chars_read <= 0 || (line + chars_read >= fin->map + VECTOR_DIGITS ?
+			convert_digits(line, chars_read, &address) : convert(line, chars_read, &address)) != SUCCESS)
+		{
+			if ((error = append_other(trace, line, length, chars_read)) != SUCCESS)
+			{
+				break;
+			}
+		}
+		else if ((error = trace_append(trace, address, is_write)) != SUCCESS)
+		{
+			break;
+		}
+
+		line += length;
+	}
+
+	fin->position = line - fin->map;
+	return error;
+}
+
+static status_t read_stream_text(trace_t *trace, trace_file_t *fin, size_t max)
+{
+	uint8_t finished = 0;
+	while (trace->length < max)
+	{
+		//make references of the whole lines buffered, and at the end of the file of its last line
+		//even without a newline
+		char *line = fin->buffer;
+		char *end = fin->buffer + fin->buffered;
+		while (trace->length < max && line < end)
+		{
+			char *newline = memchr(line, '\n', end - line);
+			if (newline == NULL && !finished)
+			{
+				break;
+			}
+			size_t length = (newline != NULL ? newline + 1 : end) - line;
+
+			status_t error;
+			uint64_t address;
+			uint8_t is_write;
+			if (trace_parse_line(line, length, &address, &is_write) != SUCCESS)
+			{
+				error = append_other(trace, line, length, trim_line(line, length, &is_write));
+			}
+			else
+			{
+				error = trace_append(trace, address, is_write);
+			}
+			if (error != SUCCESS)
+			{
+				return error;
+			}
+			line += length;
+		}
+		fin->buffered = end - line;
+		memmove(fin->buffer, line, fin->buffered);
+
+		if (finished || trace->length == max || (trace->length > 0 && max != TRACE_ALL))
+		{
+			break;
+		}
+
+		//a line too long for the buffer is reported and dropped
+		if (fin->buffered == TRACE_STREAM_BYTES)
+		{
+			report_line(fin->buffer, fin->buffered);
+			fin->buffered = 0;
+		}
+
+		ssize_t got = read(fileno(fin->file), fin->buffer + fin->buffered, TRACE_STREAM_BYTES - fin->buffered);
+		if (got < 0 && errno != EINTR)
+		{
+			return READ_ERROR;
+		}
+		if (got < 0)
+		{
+			//an interrupted stream ends here, dropping any partial line
+			fin->buffered = 0;
+			break;
+		}
+		finished = got == 0;
+		fin->buffered += got;
+	}
+
+	return SUCCESS;
+}
+
+status_t trace_append(trace_t *trace, uint64_t address, uint8_t is_write)
+{
+	status_t error;
+	if (trace->length == trace->capacity &&
+		(error = trace_reserve(trace, trace->capacity < MIN_CAPACITY ? MIN_CAPACITY : 2 * trace->capacity)) != SUCCESS)
+	{
+		return error;
+	}
+
+	trace->addresses[trace->length] = address;
+	trace->writes[trace->length] = is_write;
+	trace->length++;
+	return SUCCESS;
+}
+
+static status_t trace_reserve(trace_t *trace, size_t capacity)
+{
+	if (capacity <= trace->capacity)
+	{
+		return SUCCESS;
+	}
+
+	uint64_t *addresses = realloc(trace->addresses, capacity * sizeof *addresses);
+	if (addresses == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	trace->addresses = addresses;
+
+	uint8_t *writes = realloc(trace->writes, capacity * sizeof *writes);
+	if (writes == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	trace->writes = writes;
+
+	trace->capacity = capacity;
+	return SUCCESS;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+
+#include "../include/status.h"
+#include "../include/trace.h"
+
+/**
+  * Converts a text address file into a binary trace, which manager reads with no parsing at all.
+  * Lines which cannot be converted are reported and left out, just as manager would skip them
+  */
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <address file> <binary trace>\n", argv[0]);
+		return ARGS_ERROR;
+	}
+
+	status_t error;
+	trace_file_t fin;
+	if ((error = trace_open(&fin, argv[1])) != SUCCESS)
+	{
+		fprintf(stderr, "Error: could not open %s.\n", argv[1]);
+		return error;
+	}
+
+	trace_t trace;
+	trace_initialize(&trace);
+	if ((error = trace_read(&trace, &fin, TRACE_ALL)) != SUCCESS)
+	{
+		fprintf(stderr, "Error: could not read %s.\n", argv[1]);
+	}
+	else if ((error = trace_save(&trace, argv[2])) != SUCCESS)
+	{
+		fprintf(stderr, "Error: could not write %s.\n", argv[2]);
+	}
+	else
+	{
+		fprintf(stdout, "Converted %zu references.\n", trace.length);
+	}
+
+	trace_uninitialize(&trace);
+	trace_close(&fin);
+	return error;
+}
@@ -0,0 +1,642 @@
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/status.h"
+#include "../include/trace.h"
+
+/**
+  * The defaults of the generator: a trace of the default geometry of manager, with a working set of
+  * a quarter of its pages
+  */
+#define DEFAULT_REFERENCES   1000000
+#define DEFAULT_ADDRESS_BITS 16
+#define DEFAULT_PAGE_BYTES   256
+#define DEFAULT_WORKING_SET  64
+#define DEFAULT_PHASE        100000
+#define DEFAULT_ZIPF         0.99
+#define DEFAULT_SEED         1
+
+/**
+  * The number of references generated and written at a time
+  */
+#define GENERATE_BATCH 65536
+
+/**
+  * The widest address space a backing store is written for, 4 GiB
+  */
+#define MAX_STORE_BITS 32
+
+/**
+  * The distributions of the pages referenced:
+  *   DIST_UNIFORM    - any page of the working set, equally likely
+  *   DIST_ZIPF       - page r of the working set with probability proportional to 1 / (r + 1)^s
+  *   DIST_SEQUENTIAL - every page of the address space in turn, wrapping around at the end
+  *   DIST_LOOP       - every page of the working set in turn, over and over
+  *   DIST_PHASE      - any page of the working set, which moves somewhere else in the address
+  *                     space every phase references
+  */
+typedef enum
+{
+	DIST_UNIFORM,
+	DIST_ZIPF,
+	DIST_SEQUENTIAL,
+	DIST_LOOP,
+	DIST_PHASE
+} distribution_t;
+
+static const char *distribution_names[] = { "uniform", "zipf", "sequential", "loop", "phase" };
+
+/**
+  * Everything that can be set from the command line
+  */
+typedef struct
+{
+	size_t references;
+	distribution_t distribution;
+	unsigned int address_bits;
+	size_t page_bytes;
+	size_t working_set;
+	size_t phase;
+	double zipf;
+	double write_ratio;
+	uint64_t seed;
+	uint8_t binary;
+	const char *store;
+	const char *output;
+} generator_options_t;
+
+/**
+  * The state of the generator as it runs: the random number generator, the next page of a scan,
+  * the first page of the working set, and the constants of the Zipfian distribution
+  */
+typedef struct
+{
+	generator_options_t *options;
+	uint64_t random;
+	uint64_t number_pages;
+	uint64_t next_page;
+	uint64_t base_page;
+	double zeta_n;
+	double alpha;
+	double eta;
+} generator_t;
+
+static const struct option long_options[] =
+{
+	{ "references",   required_argument, NULL, 'n' },
+	{ "distribution", required_argument, NULL, 'd' },
+	{ "address-bits", required_argument, NULL, 'a' },
+	{ "page-bytes",   required_argument, NULL, 'p' },
+	{ "working-set",  required_argument, NULL, 'w' },
+	{ "phase",        required_argument, NULL, 'P' },
+	{ "zipf",         required_argument, NULL, 'z' },
+	{ "writes",       required_argument, NULL, 'W' },
+	{ "seed",         required_argument, NULL, 's' },
+	{ "binary",       no_argument,       NULL, 'b' },
+	{ "store",        required_argument, NULL, 'S' },
+	{ "help",         no_argument,       NULL, 'h' },
+	{ NULL,           0,                 NULL,  0  }
+};
+
+/**
+  * Prints a summary of the command line usage
+  * @param program the name the program was run as
+  */
+static void usage(const char *program);
+
+/**
+  * Converts a string to a count, allowing a K, M or G suffix for powers of 1000, as references are
+  * counted rather than sized
+  * @param s     the string to convert
+  * @param value out param which will hold the count
+  * @return an indication of whether an error occurred
+  */
+static status_t parse_count(const char *s, size_t *value);
+
+/**
+  * Parses the command line into the options
+  * @param options the options to fill in
+  * @param argc    the number of command line arguments
+  * @param argv    the command line arguments
+  * @return an indication of whether an error occurred
+  */
+static status_t parse_options(generator_options_t *options, int argc, char *argv[]);
+
+/**
+  * Returns the next value of a xorshift64* generator
+  * @param state the state of the generator, never 0
+  * @return the next value
+  */
+static uint64_t next_random(uint64_t *state);
+
+/**
+  * Returns a random number uniformly distributed in [0, 1)
+  * @param state the state of the generator
+  * @return the number
+  */
+static double next_uniform(uint64_t *state);
+
+/**
+  * Prepares the generator, computing the constants of the Zipfian distribution if it is needed
+  * @param generator the generator
+  * @param options   the options
+  */
+static void generator_initialize(generator_t *generator, generator_options_t *options);
+
+/**
+  * Generates the next reference
+  * @param generator the generator
+  * @param position  the number of references generated before this one
+  * @param is_write  out param which will hold whether the reference is a write
+  * @return the address of the reference
+  */
+static uint64_t generator_next(generator_t *generator, size_t position, uint8_t *is_write);
+
+/**
+  * Writes the references as a text address file, one "address" or "address W" line each
+  * @param generator the generator
+  * @param fout      the file to write to
+  * @return an indication of whether an error occurred
+  */
+static status_t write_text(generator_t *generator, FILE *fout);
+
+/**
+  * Writes the references as a binary trace. The addresses and the write flags are written through
+  * two streams at once, since the flags of every reference come after all of the addresses, so
+  * that a trace of any length is written without being held in memory
+  * @param generator the generator
+  * @param path      the path of the binary trace
+  * @return an indication of whether an error occurred
+  */
+static status_t write_binary(generator_t *generator, const char *path);
+
+/**
+  * Writes a backing store covering the whole address space, whose pages are a mix of what memory
+  * holds and compresses differently: a quarter of them zeros, a quarter text of words from a small
+  * vocabulary, a quarter arrays of records of an index, flags and a pointer, and a quarter random
+  * bytes. The kind of each page is drawn at random from its own generator, so the trace is the same
+  * with or without a store
+  * @param options the options
+  * @param path    the path of the backing store
+  * @return an indication of whether an error occurred
+  */
+static status_t write_store(generator_options_t *options, const char *path);
+
+/**
+  * Generates a synthetic address file of uniform, Zipfian, sequential, looping or phase-changing
+  * references, with a given share of writes, as text or as a binary trace, and optionally a backing
+  * store for it
+  */
+int main(int argc, char *argv[])
+{
+	generator_options_t options;
+	status_t error;
+	if ((error = parse_options(&options, argc, argv)) != SUCCESS)
+	{
+		usage(argv[0]);
+		return error;
+	}
+
+	generator_t generator;
+	generator_initialize(&generator, &options);
+
+	if (options.binary)
+	{
+		error = write_binary(&generator, options.output);
+	}
+	else
+	{
+		FILE *fout = strcmp(options.output, "-") == 0 ? stdout : fopen(options.output, "w");
+		if (fout == NULL)
+		{
+			error = OPEN_ERROR;
+		}
+		else
+		{
+			error = write_text(&generator, fout);
+			if (fout != stdout && fclose(fout) != 0 && error == SUCCESS)
+			{
+				error = WRIT_ERROR;
+			}
+		}
+	}
+
+	if (error != SUCCESS)
+	{
+		fprintf(stderr, "Error: could not write %s.\n", options.output);
+	}
+	else if (options.store != NULL && (error = write_store(&options, options.store)) != SUCCESS)
+	{
+		fprintf(stderr, "Error: could not write %s.\n", options.store);
+	}
+	return error;
+}
+
+static void usage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [options] <output file, or - for stdout>\n", program);
+	fprintf(stderr, "  -n, --references N    number of references, with a K, M or G suffix for thousands (default %d)\n", DEFAULT_REFERENCES);
+	fprintf(stderr, "  -d, --distribution D  uniform, zipf, sequential, loop or phase (default uniform)\n");
+	fprintf(stderr, "  -a, --address-bits N  width of an address in bits (default %d)\n", DEFAULT_ADDRESS_BITS);
+	fprintf(stderr, "  -p, --page-bytes N    bytes per page, a power of two (default %d)\n", DEFAULT_PAGE_BYTES);
+	fprintf(stderr, "  -w, --working-set N   pages in the working set (default %d)\n", DEFAULT_WORKING_SET);
+	fprintf(stderr, "  -P, --phase N         references before a phase moves the working set (default %d)\n", DEFAULT_PHASE);
+	fprintf(stderr, "  -z, --zipf S          exponent of the Zipfian distribution, below 1 (default %.2f)\n", DEFAULT_ZIPF);
+	fprintf(stderr, "  -W, --writes F        share of the references which are writes, from 0 to 1 (default 0)\n");
+	fprintf(stderr, "  -s, --seed N          seed of the random numbers (default %d)\n", DEFAULT_SEED);
+	fprintf(stderr, "  -b, --binary          write a binary trace instead of text\n");
+	fprintf(stderr, "  -S, --store FILE      also write a backing store of zero, text, record and random pages to FILE\n");
+}
+
+static status_t parse_count(const char *s, size_t *value)
+{
+	char *end;
+	unsigned long long parsed = strtoull(s, &end, 10);
+	if (end == s || *s == '-')
+	{
+		return OPTN_ERROR;
+	}
+
+	switch (*end)
+	{
+		case 'G':
+			parsed *= 1000;
+			//fall through
+		case 'M':
+			parsed *= 1000;
+			//fall through
+		case 'K':
+			parsed *= 1000;
+			end++;
+			break;
+	}
+
+	if (*end != '\0')
+	{
+		return OPTN_ERROR;
+	}
+
+	*value = parsed;
+	return SUCCESS;
+}
+
+static status_t parse_options(generator_options_t *options, int argc, char *argv[])
+{
+	options->references = DEFAULT_REFERENCES;
+	options->distribution = DIST_UNIFORM;
+	options->address_bits = DEFAULT_ADDRESS_BITS;
+	options->page_bytes = DEFAULT_PAGE_BYTES;
+	options->working_set = DEFAULT_WORKING_SET;
+	options->phase = DEFAULT_PHASE;
+	options->zipf = DEFAULT_ZIPF;
+	options->write_ratio = 0;
+	options->seed = DEFAULT_SEED;
+	options->binary = 0;
+	options->store = NULL;
+
+	int c;
+	int index;
+	size_t value;
+	while ((c = getopt_long(argc, argv, "n:d:a:p:w:P:z:W:s:bS:h", long_options, &index)) != -1)
+	{
+		status_t error = SUCCESS;
+		switch (c)
+		{
+			case 'n':
+				error = parse_count(optarg, &options->references);
+				break;
+			case 'd':
+				for (value = 0; value < sizeof distribution_names / sizeof *distribution_names && strcmp(optarg, distribution_names[value]) != 0; value++);
+				options->distribution = value;
+				error = value < sizeof distribution_names / sizeof *distribution_names ? SUCCESS : OPTN_ERROR;
+				break;
+			case 'a':
+				error = parse_count(optarg, &value);
+				options->address_bits = value;
+				break;
+			case 'p':
+				error = parse_count(optarg, &options->page_bytes);
+				break;
+			case 'w':
+				error = parse_count(optarg, &options->working_set);
+				break;
+			case 'P':
+				error = parse_count(optarg, &options->phase);
+				break;
+			case 'z':
+				options->zipf = strtod(optarg, NULL);
+				break;
+			case 'W':
+				options->write_ratio = strtod(optarg, NULL);
+				break;
+			case 's':
+				error = parse_count(optarg, &value);
+				options->seed = value;
+				break;
+			case 'b':
+				options->binary = 1;
+				break;
+			case 'S':
+				options->store = optarg;
+				break;
+			default:
+				return ARGS_ERROR;
+		}
+
+		if (error != SUCCESS)
+		{
+			return error;
+		}
+	}
+
+	if (argc - optind != 1)
+	{
+		return ARGS_ERROR;
+	}
+	options->output = argv[optind];
+
+	//the working set must fit in the address space, a page in an address, and the exponent must
+	//keep the Zipfian constants finite. A store is written whole, so its address space is limited
+	if (options->address_bits == 0 || options->address_bits > 64 || options->page_bytes == 0 ||
+		(options->store != NULL && options->address_bits > MAX_STORE_BITS) ||
+		(options->page_bytes & (options->page_bytes - 1)) != 0 || options->phase == 0 ||
+		options->zipf <= 0 || options->zipf >= 1 || options->write_ratio < 0 || options->write_ratio > 1 ||
+		(options->binary && strcmp(options->output, "-") == 0))
+	{
+		return OPTN_ERROR;
+	}
+	unsigned int offset_bits = 0;
+	while (((size_t) 1 << offset_bits) < options->page_bytes)
+	{
+		offset_bits++;
+	}
+	if (offset_bits > options->address_bits || options->working_set == 0 ||
+		(options->address_bits - offset_bits < 64 && options->working_set > (uint64_t) 1 << (options->address_bits - offset_bits)))
+	{
+		return OPTN_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static double next_uniform(uint64_t *state)
+{
+	return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void generator_initialize(generator_t *generator, generator_options_t *options)
+{
+	generator->options = options;
+	generator->random = options->seed == 0 ? DEFAULT_SEED : options->seed;
+	generator->next_page = 0;
+	generator->base_page = 0;
+
+	unsigned int offset_bits = 0;
+	while (((size_t) 1 << offset_bits) < options->page_bytes)
+	{
+		offset_bits++;
+	}
+	unsigned int page_bits = options->address_bits - offset_bits;
+	generator->number_pages = page_bits >= 64 ? UINT64_MAX : (uint64_t) 1 << page_bits;
+
+	//the constants of Gray et al.'s method, which draws a Zipfian rank in constant time once the
+	//zeta function of the working set has been summed
+	if (options->distribution == DIST_ZIPF)
+	{
+		double theta = options->zipf;
+		size_t n = options->working_set;
+		double zeta_n = 0;
+		size_t i;
+		for (i = 1; i <= n; i++)
+		{
+			zeta_n += 1.0 / pow((double) i, theta);
+		}
+		double zeta_2 = 1.0 + 1.0 / pow(2.0, theta);
+		generator->zeta_n = zeta_n;
+		generator->alpha = 1.0 / (1.0 - theta);
+		generator->eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta_2 / zeta_n);
+	}
+}
+
+static uint64_t generator_next(generator_t *generator, size_t position, uint8_t *is_write)
+{
+	generator_options_t *options = generator->options;
+	uint64_t page;
+	switch (options->distribution)
+	{
+		case DIST_ZIPF:
+		{
+			double u = next_uniform(&generator->random);
+			double uz = u * generator->zeta_n;
+			if (uz < 1.0)
+			{
+				page = 0;
+			}
+			else if (uz < 1.0 + pow(0.5, options->zipf))
+			{
+				page = 1;
+			}
+			else
+			{
+				page = (uint64_t) (options->working_set * pow(generator->eta * u - generator->eta + 1.0, generator->alpha));
+			}
+			if (page >= options->working_set)
+			{
+				page = options->working_set - 1;
+			}
+			break;
+		}
+		case DIST_SEQUENTIAL:
+			page = generator->next_page++;
+			if (generator->next_page == generator->number_pages)
+			{
+				generator->next_page = 0;
+			}
+			break;
+		case DIST_LOOP:
+			page = generator->next_page++;
+			if (generator->next_page == options->working_set)
+			{
+				generator->next_page = 0;
+			}
+			break;
+		case DIST_PHASE:
+			//each phase puts the working set somewhere new, wholly inside the address space
+			if (position % options->phase == 0 && position > 0)
+			{
+				uint64_t room = generator->number_pages - options->working_set;
+				generator->base_page = room == UINT64_MAX ? next_random(&generator->random) : next_random(&generator->random) % (room + 1);
+			}
+			page = generator->base_page + next_random(&generator->random) % options->working_set;
+			break;
+		default:
+			page = next_random(&generator->random) % options->working_set;
+			break;
+	}
+
+	*is_write = options->write_ratio > 0 && next_uniform(&generator->random) < options->write_ratio;
+	uint64_t offset = next_random(&generator->random) & (options->page_bytes - 1);
+	return page * options->page_bytes + offset;
+}
+
+static status_t write_text(generator_t *generator, FILE *fout)
+{
+	size_t position;
+	for (position = 0; position < generator->options->references; position++)
+	{
+		uint8_t is_write;
+		uint64_t address = generator_next(generator, position, &is_write);
+		if (fprintf(fout, is_write ? "%" PRIu64 " W\n" : "%" PRIu64 "\n", address) < 0)
+		{
+			return WRIT_ERROR;
+		}
+	}
+
+	return SUCCESS;
+}
+
+static status_t write_binary(generator_t *generator, const char *path)
+{
+	FILE *addresses;
+	FILE *writes;
+	if ((addresses = fopen(path, "w")) == NULL)
+	{
+		return OPEN_ERROR;
+	}
+	if ((writes = fopen(path, "r+")) == NULL)
+	{
+		fclose(addresses);
+		return OPEN_ERROR;
+	}
+
+	size_t count = generator->options->references;
+	trace_header_t header;
+	memset(&header, 0, sizeof header);
+	memcpy(header.magic, TRACE_MAGIC, sizeof header.magic);
+	header.version = TRACE_VERSION;
+	header.count = count;
+
+	status_t error = SUCCESS;
+	if (fwrite(&header, sizeof header, 1, addresses) < 1 ||
+		fseeko(writes, sizeof header + (off_t) count * sizeof (uint64_t), SEEK_SET) < 0)
+	{
+		error = WRIT_ERROR;
+	}
+
+	uint64_t batch_addresses[GENERATE_BATCH];
+	uint8_t batch_writes[GENERATE_BATCH];
+	size_t position = 0;
+	while (error == SUCCESS && position < count)
+	{
+		size_t length = count - position < GENERATE_BATCH ? count - position : GENERATE_BATCH;
+		size_t i;
+		for (i = 0; i < length; i++)
+		{
+			batch_addresses[i] = generator_next(generator, position + i, &batch_writes[i]);
+		}
+		if (fwrite(batch_addresses, sizeof *batch_addresses, length, addresses) < length ||
+			fwrite(batch_writes, sizeof *batch_writes, length, writes) < length)
+		{
+			error = WRIT_ERROR;
+		}
+		position += length;
+	}
+
+	if (fclose(writes) != 0 && error == SUCCESS)
+	{
+		error = WRIT_ERROR;
+	}
+	if (fclose(addresses) != 0 && error == SUCCESS)
+	{
+		error = WRIT_ERROR;
+	}
+	return error;
+}
+
+static status_t write_store(generator_options_t *options, const char *path)
+{
+	static const char *words[] = { "the ", "page ", "frame ", "of ", "a ", "memory ", "table ", "and ", "to ", "fault ",
+		"is ", "in ", "process ", "swap ", "which ", "cache " };
+
+	FILE *fout;
+	uint8_t *page;
+	if ((page = malloc(options->page_bytes)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	if ((fout = fopen(path, "w")) == NULL)
+	{
+		free(page);
+		return OPEN_ERROR;
+	}
+
+	uint64_t random = ~(options->seed == 0 ? DEFAULT_SEED : options->seed);
+	uint64_t number_pages = ((uint64_t) 1 << options->address_bits) / options->page_bytes;
+	status_t error = SUCCESS;
+	uint64_t p;
+	for (p = 0; p < number_pages && error == SUCCESS; p++)
+	{
+		size_t i;
+		switch (next_random(&random) % 4)
+		{
+			case 0:
+				memset(page, 0, options->page_bytes);
+				break;
+			case 1:
+				for (i = 0; i < options->page_bytes; )
+				{
+					const char *word = words[next_random(&random) % (sizeof words / sizeof *words)];
+					while (*word != '\0' && i < options->page_bytes)
+					{
+						page[i++] = *word++;
+					}
+				}
+				break;
+			case 2:
+			{
+				//records of a little-endian index, flags which are mostly the same and a pointer
+				//into a heap which grows by a record at a time
+				uint64_t heap = 0x7f0000000000ULL + (next_random(&random) & 0xFFFFFF0ULL);
+				uint32_t flags = next_random(&random) % 4;
+				for (i = 0; i < options->page_bytes; i++)
+				{
+					size_t record = (p * options->page_bytes + i) / 16;
+					size_t field = i % 16;
+					uint64_t value = field < 4 ? record : field < 8 ? flags : heap + record * 16;
+					page[i] = value >> (8 * (field % (field < 8 ? 4 : 8))) & 0xFF;
+				}
+				break;
+			}
+			default:
+				for (i = 0; i < options->page_bytes; i++)
+				{
+					page[i] = next_random(&random);
+				}
+				break;
+		}
+
+		if (fwrite(page, 1, options->page_bytes, fout) < options->page_bytes)
+		{
+			error = WRIT_ERROR;
+		}
+	}
+
+	if (fclose(fout) != 0 && error == SUCCESS)
+	{
+		error = WRIT_ERROR;
+	}
+	free(page);
+	return error;
+}
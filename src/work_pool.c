@@ -0,0 +1,173 @@
+#include <stdlib.h>
+
+#include "../include/work_pool.h"
+
+/**
+  * A thread of the pool. Runs its own tasks from the front, then steals from the others until
+  * there are none left anywhere or a task has failed
+  * @param argument the thread
+  * @return NULL
+  */
+static void *work_pool_work(void *argument);
+
+/**
+  * Takes the next task of a thread from the front of its own
+  * @param thread the thread
+  * @param task   out param which will hold the task
+  * @return whether the thread had a task left
+  */
+static uint8_t work_pool_take(work_thread_t *thread, size_t *task);
+
+/**
+  * Moves the back half of the tasks of the first other thread which has any onto a thread which
+  * has run out
+  * @param thread the thread which has run out
+  * @return whether any tasks were stolen
+  */
+static uint8_t work_pool_steal(work_thread_t *thread);
+
+/**
+  * Checks whether a task has failed
+  * @param pool the pool
+  * @return whether a task has failed
+  */
+static uint8_t work_pool_failed(work_pool_t *pool);
+
+status_t work_pool_run(size_t number_tasks, size_t number_threads, work_pool_task_t run, void *context, size_t *steals)
+{
+	if (number_threads == 0 || number_threads > MAX_WORK_THREADS)
+	{
+		return OPTN_ERROR;
+	}
+
+	work_pool_t pool;
+	if ((pool.threads = malloc(number_threads * sizeof *pool.threads)) == NULL)
+	{
+		return ALOC_ERROR;
+	}
+	pool.number_threads = number_threads;
+	pool.run = run;
+	pool.context = context;
+	pool.error = SUCCESS;
+	pthread_mutex_init(&pool.error_lock, NULL);
+
+	//each thread starts with a run of consecutive tasks, the first few one longer than the rest
+	size_t index;
+	size_t start = 0;
+	for (index = 0; index < number_threads; index++)
+	{
+		work_thread_t *thread = &pool.threads[index];
+		thread->next = start;
+		thread->end = start + number_tasks / number_threads + (index < number_tasks % number_threads);
+		thread->steals = 0;
+		thread->pool = &pool;
+		pthread_mutex_init(&thread->lock, NULL);
+		start = thread->end;
+	}
+
+	//a thread which cannot be started leaves its tasks to be stolen by the rest
+	size_t started;
+	for (started = 1; started < number_threads; started++)
+	{
+		if (pthread_create(&pool.threads[started].thread, NULL, work_pool_work, &pool.threads[started]) != 0)
+		{
+			break;
+		}
+	}
+	work_pool_work(&pool.threads[0]);
+
+	size_t stolen = pool.threads[0].steals;
+	for (index = 1; index < started; index++)
+	{
+		pthread_join(pool.threads[index].thread, NULL);
+		stolen += pool.threads[index].steals;
+	}
+	if (steals != NULL)
+	{
+		*steals = stolen;
+	}
+
+	for (index = 0; index < number_threads; index++)
+	{
+		pthread_mutex_destroy(&pool.threads[index].lock);
+	}
+	pthread_mutex_destroy(&pool.error_lock);
+	free(pool.threads);
+	return pool.error;
+}
+
+static void *work_pool_work(void *argument)
+{
+	work_thread_t *thread = argument;
+	work_pool_t *pool = thread->pool;
+
+	size_t task;
+	while (!work_pool_failed(pool) && (work_pool_take(thread, &task) || (work_pool_steal(thread) && work_pool_take(thread, &task))))
+	{
+		status_t error = pool->run(pool->context, task);
+		if (error != SUCCESS)
+		{
+			pthread_mutex_lock(&pool->error_lock);
+			if (pool->error == SUCCESS)
+			{
+				pool->error = error;
+			}
+			pthread_mutex_unlock(&pool->error_lock);
+		}
+	}
+
+	return NULL;
+}
+
+static uint8_t work_pool_take(work_thread_t *thread, size_t *task)
+{
+	pthread_mutex_lock(&thread->lock);
+	uint8_t taken = thread->next < thread->end;
+	if (taken)
+	{
+		*task = thread->next++;
+	}
+	pthread_mutex_unlock(&thread->lock);
+	return taken;
+}
+
+static uint8_t work_pool_steal(work_thread_t *thread)
+{
+	//a thread is only ever given tasks by itself, so once every other has run out there is nothing
+	//left to steal. Each lock is let go before the next is taken, so that two threads stealing from
+	//each other cannot deadlock
+	work_pool_t *pool = thread->pool;
+	size_t self = thread - pool->threads;
+	size_t offset;
+	for (offset = 1; offset < pool->number_threads; offset++)
+	{
+		work_thread_t *victim = &pool->threads[(self + offset) % pool->number_threads];
+		pthread_mutex_lock(&victim->lock);
+		size_t remaining = victim->end - victim->next;
+		size_t count = (remaining + 1) / 2;
+		victim->end -= count;
+		size_t first = victim->end;
+		pthread_mutex_unlock(&victim->lock);
+
+		//the back half is rounded up so that a last task left is taken as well
+		if (count > 0)
+		{
+			pthread_mutex_lock(&thread->lock);
+			thread->next = first;
+			thread->end = first + count;
+			thread->steals++;
+			pthread_mutex_unlock(&thread->lock);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static uint8_t work_pool_failed(work_pool_t *pool)
+{
+	pthread_mutex_lock(&pool->error_lock);
+	uint8_t failed = pool->error != SUCCESS;
+	pthread_mutex_unlock(&pool->error_lock);
+	return failed;
+}
@@ -0,0 +1,288 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/write_back.h"
+
+/**
+  * The states of a slot of the queue
+  */
+#define SLOT_FREE    0
+#define SLOT_QUEUED  1
+#define SLOT_WRITING 2
+
+/**
+  * A page taken by the flusher, and the slot holding its contents
+  */
+typedef struct
+{
+	uint64_t page;
+	size_t slot;
+} flush_entry_t;
+
+/**
+  * The flusher thread. Takes every queued page at once, writes them out in runs of consecutive
+  * pages, and frees their slots, until it is stopped with nothing left queued
+  * @param argument the write-back
+  * @return NULL
+  */
+static void *write_back_flush(void *argument);
+
+/**
+  * Orders flush entries by page number, for qsort
+  */
+static int compare_entries(const void *a, const void *b);
+
+status_t write_back_mode_find(const char *name, write_back_mode_t *mode)
+{
+	if (strcmp(name, "none") == 0)
+	{
+		*mode = WRITE_BACK_NONE;
+	}
+	else if (strcmp(name, "sync") == 0)
+	{
+		*mode = WRITE_BACK_SYNC;
+	}
+	else if (strcmp(name, "async") == 0)
+	{
+		*mode = WRITE_BACK_ASYNC;
+	}
+	else
+	{
+		return OPTN_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+status_t write_back_initialize(write_back_t *write_back, backing_store_t *store, write_back_mode_t mode)
+{
+	write_back->mode = mode;
+	write_back->store = store;
+	write_back->buffers = NULL;
+	write_back->queued = 0;
+	write_back->free_slots = WRITE_BACK_SLOTS;
+	write_back->stopping = 0;
+	write_back->error = SUCCESS;
+	write_back->written = 0;
+	write_back->coalesced = 0;
+	write_back->batches = 0;
+	memset(write_back->states, SLOT_FREE, sizeof write_back->states);
+	pthread_mutex_init(&write_back->lock, NULL);
+	if (mode != WRITE_BACK_ASYNC)
+	{
+		return SUCCESS;
+	}
+
+	if ((write_back->buffers = malloc(WRITE_BACK_SLOTS * store->page_bytes)) == NULL)
+	{
+		pthread_mutex_destroy(&write_back->lock);
+		return ALOC_ERROR;
+	}
+
+	pthread_cond_init(&write_back->work, NULL);
+	pthread_cond_init(&write_back->space, NULL);
+	if (pthread_create(&write_back->flusher, NULL, write_back_flush, write_back) != 0)
+	{
+		pthread_cond_destroy(&write_back->space);
+		pthread_cond_destroy(&write_back->work);
+		pthread_mutex_destroy(&write_back->lock);
+		free(write_back->buffers);
+		return ALOC_ERROR;
+	}
+
+	return SUCCESS;
+}
+
+status_t write_back_uninitialize(write_back_t *write_back)
+{
+	if (write_back->mode != WRITE_BACK_ASYNC)
+	{
+		pthread_mutex_destroy(&write_back->lock);
+		return write_back->error;
+	}
+
+	pthread_mutex_lock(&write_back->lock);
+	write_back->stopping = 1;
+	pthread_cond_signal(&write_back->work);
+	pthread_mutex_unlock(&write_back->lock);
+	pthread_join(write_back->flusher, NULL);
+
+	pthread_cond_destroy(&write_back->space);
+	pthread_cond_destroy(&write_back->work);
+	pthread_mutex_destroy(&write_back->lock);
+	free(write_back->buffers);
+	return write_back->error;
+}
+
+status_t write_back_page(write_back_t *write_back, uint64_t page, const int8_t *contents)
+{
+	size_t page_bytes = write_back->store->page_bytes;
+	if (write_back->mode == WRITE_BACK_SYNC)
+	{
+		struct iovec single = { (void *) contents, page_bytes };
+		status_t error;
+		if ((error = backing_store_write(write_back->store, page, &single, 1)) != SUCCESS)
+		{
+			return error;
+		}
+		pthread_mutex_lock(&write_back->lock);
+		write_back->written++;
+		write_back->batches++;
+		pthread_mutex_unlock(&write_back->lock);
+		return SUCCESS;
+	}
+
+	pthread_mutex_lock(&write_back->lock);
+	status_t error = write_back->error;
+	size_t slot;
+	for (slot = 0; slot < WRITE_BACK_SLOTS; slot++)
+	{
+		if (write_back->states[slot] == SLOT_QUEUED && write_back->pages[slot] == page)
+		{
+			break;
+		}
+	}
+
+	if (error == SUCCESS && slot < WRITE_BACK_SLOTS)
+	{
+		write_back->coalesced++;
+	}
+	else if (error == SUCCESS)
+	{
+		while (write_back->free_slots == 0)
+		{
+			pthread_cond_signal(&write_back->work);
+			pthread_cond_wait(&write_back->space, &write_back->lock);
+		}
+		for (slot = 0; write_back->states[slot] != SLOT_FREE; slot++);
+
+		write_back->states[slot] = SLOT_QUEUED;
+		write_back->pages[slot] = page;
+		write_back->free_slots--;
+		//the flusher is woken for a batch at a time rather than for every page, so that it writes
+		//more pages per system call and takes the processor from the faulting thread less often
+		if (++write_back->queued == WRITE_BACK_BATCH)
+		{
+			pthread_cond_signal(&write_back->work);
+		}
+	}
+
+	if (error == SUCCESS)
+	{
+		memcpy(write_back->buffers + slot * page_bytes, contents, page_bytes);
+	}
+	pthread_mutex_unlock(&write_back->lock);
+	return error;
+}
+
+status_t write_back_read(write_back_t *write_back, uint64_t page, int8_t *dest)
+{
+	if (write_back->mode == WRITE_BACK_ASYNC)
+	{
+		//a queued copy of the page is newer than one being written, which is newer than the store
+		pthread_mutex_lock(&write_back->lock);
+		size_t found = WRITE_BACK_SLOTS;
+		size_t slot;
+		for (slot = 0; slot < WRITE_BACK_SLOTS; slot++)
+		{
+			if (write_back->states[slot] != SLOT_FREE && write_back->pages[slot] == page &&
+				(found == WRITE_BACK_SLOTS || write_back->states[slot] == SLOT_QUEUED))
+			{
+				found = slot;
+			}
+		}
+
+		if (found < WRITE_BACK_SLOTS)
+		{
+			memcpy(dest, write_back->buffers + found * write_back->store->page_bytes, write_back->store->page_bytes);
+			pthread_mutex_unlock(&write_back->lock);
+			return SUCCESS;
+		}
+		pthread_mutex_unlock(&write_back->lock);
+	}
+
+	return backing_store_read(write_back->store, page, dest);
+}
+
+static void *write_back_flush(void *argument)
+{
+	write_back_t *write_back = argument;
+	size_t page_bytes = write_back->store->page_bytes;
+	flush_entry_t batch[WRITE_BACK_SLOTS];
+	struct iovec run[WRITE_BACK_SLOTS];
+
+	pthread_mutex_lock(&write_back->lock);
+	while (1)
+	{
+		while (write_back->queued == 0 && !write_back->stopping)
+		{
+			pthread_cond_wait(&write_back->work, &write_back->lock);
+		}
+		if (write_back->queued == 0)
+		{
+			break;
+		}
+
+		//take everything queued so far; faults may queue more while this batch is written
+		size_t count = 0;
+		size_t slot;
+		for (slot = 0; slot < WRITE_BACK_SLOTS; slot++)
+		{
+			if (write_back->states[slot] == SLOT_QUEUED)
+			{
+				write_back->states[slot] = SLOT_WRITING;
+				batch[count].page = write_back->pages[slot];
+				batch[count].slot = slot;
+				count++;
+			}
+		}
+		write_back->queued = 0;
+		pthread_mutex_unlock(&write_back->lock);
+
+		qsort(batch, count, sizeof *batch, compare_entries);
+
+		status_t error = SUCCESS;
+		size_t start = 0;
+		while (start < count)
+		{
+			size_t end = start;
+			do
+			{
+				run[end - start].iov_base = write_back->buffers + batch[end].slot * page_bytes;
+				run[end - start].iov_len = page_bytes;
+				end++;
+			}
+			while (end < count && batch[end].page == batch[end - 1].page + 1);
+
+			if (error == SUCCESS)
+			{
+				error = backing_store_write(write_back->store, batch[start].page, run, end - start);
+			}
+			start = end;
+		}
+
+		pthread_mutex_lock(&write_back->lock);
+		for (slot = 0; slot < count; slot++)
+		{
+			write_back->states[batch[slot].slot] = SLOT_FREE;
+		}
+		write_back->free_slots += count;
+		write_back->written += count;
+		write_back->batches++;
+		if (write_back->error == SUCCESS)
+		{
+			write_back->error = error;
+		}
+		pthread_cond_broadcast(&write_back->space);
+	}
+	pthread_mutex_unlock(&write_back->lock);
+
+	return NULL;
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+	uint64_t first = ((const flush_entry_t *) a)->page;
+	uint64_t second = ((const flush_entry_t *) b)->page;
+	return (first > second) - (first < second);
+}
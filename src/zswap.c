@@ -0,0 +1,435 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/zswap.h"
+
+/**
+  * The entries the pool starts out with room for
+  */
+#define MIN_ENTRIES 64
+
+/**
+  * Reads the monotonic clock
+  * @return the time in nanoseconds
+  */
+static uint64_t now_ns(void);
+
+/**
+  * Takes a free object of a size class from a slab of the class which has one, or else cuts a free
+  * slab into objects of the class
+  * @param zswap  the pool
+  * @param class  the size class
+  * @param object out param which will hold the first grain of the object
+  * @return whether there was an object or a free slab
+  */
+static uint8_t take_object(zswap_t *zswap, uint8_t class, uint32_t *object);
+
+/**
+  * Returns an object to its slab, and the slab to the free slabs if it is left empty
+  * @param zswap  the pool
+  * @param object the first grain of the object
+  */
+static void free_object(zswap_t *zswap, uint32_t object);
+
+/**
+  * Links a slab into the list of the slabs of its class with free objects
+  * @param zswap the pool
+  * @param slab  the slab
+  */
+static void link_slab(zswap_t *zswap, int32_t slab);
+
+/**
+  * Unlinks a slab from the list of the slabs of its class with free objects
+  * @param zswap the pool
+  * @param slab  the slab
+  */
+static void unlink_slab(zswap_t *zswap, int32_t slab);
+
+/**
+  * Takes an entry out of the pool, freeing its object
+  * @param zswap the pool
+  * @param index the entry
+  */
+static void remove_entry(zswap_t *zswap, int32_t index);
+
+/**
+  * Decompresses the page of an entry
+  * @param zswap    the pool
+  * @param entry    the entry
+  * @param contents where to decompress the page to
+  * @return an indication of whether an error occurred
+  */
+static status_t decompress_entry(zswap_t *zswap, zswap_entry_t *entry, int8_t *contents);
+
+status_t zswap_initialize(zswap_t *zswap, const codec_ops_t *codec, size_t pool_bytes, size_t page_bytes)
+{
+	zswap->codec = codec;
+	zswap->page_bytes = page_bytes;
+	zswap->grain = page_bytes / ZSWAP_CLASSES;
+	zswap->number_classes = ZSWAP_CLASSES - 1;
+	zswap->slab_bytes = ZSWAP_SLAB_PAGES * page_bytes;
+	zswap->slab_grains = ZSWAP_SLAB_PAGES * ZSWAP_CLASSES;
+	zswap->number_slabs = pool_bytes / zswap->slab_bytes;
+	zswap->used_slabs = 0;
+	zswap->oldest = ZSWAP_NONE;
+	zswap->newest = ZSWAP_NONE;
+	zswap->capacity = MIN_ENTRIES;
+	zswap->number_entries = 0;
+	zswap->free_entries = ZSWAP_NONE;
+	zswap->used_bytes = 0;
+	memset(&zswap->statistics, 0, sizeof zswap->statistics);
+
+	size_t class;
+	for (class = 0; class < ZSWAP_CLASSES; class++)
+	{
+		zswap->partial[class] = ZSWAP_NONE;
+	}
+
+	//grains are numbered in 32 bits, and an arena with no slab at all could hold nothing
+	if (page_bytes < ZSWAP_MIN_PAGE_BYTES || zswap->number_slabs == 0 || zswap->number_slabs * zswap->slab_grains > INT32_MAX)
+	{
+		return OPTN_ERROR;
+	}
+
+	status_t error;
+	if ((error = hash_map_initialize(&zswap->index, MIN_ENTRIES)) != SUCCESS)
+	{
+		return error;
+	}
+	zswap->arena = malloc(zswap->number_slabs * zswap->slab_bytes);
+	zswap->slab_class = malloc(zswap->number_slabs * sizeof *zswap->slab_class);
+	zswap->live = malloc(zswap->number_slabs * sizeof *zswap->live);
+	zswap->slab_free = malloc(zswap->number_slabs * sizeof *zswap->slab_free);
+	zswap->next_slab = malloc(zswap->number_slabs * sizeof *zswap->next_slab);
+	zswap->prev_slab = malloc(zswap->number_slabs * sizeof *zswap->prev_slab);
+	zswap->free_slabs = malloc(zswap->number_slabs * sizeof *zswap->free_slabs);
+	zswap->entries = malloc(zswap->capacity * sizeof *zswap->entries);
+	zswap->scratch = malloc(page_bytes);
+	zswap->victim = malloc(page_bytes);
+	if (zswap->arena == NULL || zswap->slab_class == NULL || zswap->live == NULL || zswap->slab_free == NULL ||
+		zswap->next_slab == NULL || zswap->prev_slab == NULL || zswap->free_slabs == NULL || zswap->entries == NULL ||
+		zswap->scratch == NULL || zswap->victim == NULL)
+	{
+		zswap_uninitialize(zswap);
+		return ALOC_ERROR;
+	}
+
+	//the slabs are handed out from the start of the arena
+	size_t slab;
+	for (slab = 0; slab < zswap->number_slabs; slab++)
+	{
+		zswap->slab_class[slab] = ZSWAP_NO_CLASS;
+		zswap->free_slabs[slab] = zswap->number_slabs - 1 - slab;
+	}
+	zswap->number_free_slabs = zswap->number_slabs;
+
+	return SUCCESS;
+}
+
+void zswap_uninitialize(zswap_t *zswap)
+{
+	free(zswap->victim);
+	free(zswap->scratch);
+	free(zswap->entries);
+	free(zswap->free_slabs);
+	free(zswap->prev_slab);
+	free(zswap->next_slab);
+	free(zswap->slab_free);
+	free(zswap->live);
+	free(zswap->slab_class);
+	free(zswap->arena);
+	hash_map_uninitialize(&zswap->index);
+}
+
+status_t zswap_store(zswap_t *zswap, uint64_t tag, const int8_t *contents, uint8_t dirty, uint8_t *stored, zswap_write_t write, void *context)
+{
+	*stored = 0;
+	zswap->statistics.offered++;
+
+	//a stale copy of the page would only be found instead of this one
+	uint64_t *found = hash_map_find(&zswap->index, tag);
+	if (found != NULL)
+	{
+		remove_entry(zswap, *found);
+	}
+
+	//a page filled with one value is kept as that value, and never reaches the codec
+	uint8_t value;
+	uint8_t class;
+	uint32_t object;
+	size_t length = 0;
+	status_t error;
+	if (codec_same_filled((const uint8_t *) contents, zswap->page_bytes, &value))
+	{
+		class = ZSWAP_NO_CLASS;
+		object = value;
+		zswap->statistics.same_filled++;
+	}
+	else
+	{
+		uint64_t start = now_ns();
+		length = zswap->codec->compress((const uint8_t *) contents, zswap->page_bytes, zswap->scratch, zswap->number_classes * zswap->grain);
+		zswap->statistics.compress_ns += now_ns() - start;
+		if (length == 0)
+		{
+			zswap->statistics.incompressible++;
+			return SUCCESS;
+		}
+
+		//push out the least recently stored pages until one leaves room; since every slab holds
+		//an object of any class, the pool always has room once it is empty
+		class = (length + zswap->grain - 1) / zswap->grain - 1;
+		while (!take_object(zswap, class, &object))
+		{
+			int32_t oldest = zswap->oldest;
+			zswap_entry_t *entry = &zswap->entries[oldest];
+			if (entry->dirty)
+			{
+				if ((error = decompress_entry(zswap, entry, zswap->victim)) != SUCCESS ||
+					(error = write(context, entry->tag, zswap->victim)) != SUCCESS)
+				{
+					return error;
+				}
+				zswap->statistics.dirty_evictions++;
+			}
+			remove_entry(zswap, oldest);
+			zswap->statistics.evictions++;
+		}
+		memcpy(zswap->arena + (size_t) object * zswap->grain, zswap->scratch, length);
+		zswap->used_bytes += length;
+		zswap->statistics.raw_bytes += zswap->page_bytes;
+		zswap->statistics.compressed_bytes += length;
+	}
+
+	int32_t index;
+	if (zswap->free_entries != ZSWAP_NONE)
+	{
+		index = zswap->free_entries;
+		zswap->free_entries = zswap->entries[index].next;
+	}
+	else
+	{
+		if (zswap->number_entries == zswap->capacity)
+		{
+			zswap_entry_t *entries = realloc(zswap->entries, 2 * zswap->capacity * sizeof *entries);
+			if (entries == NULL)
+			{
+				return ALOC_ERROR;
+			}
+			zswap->entries = entries;
+			zswap->capacity *= 2;
+		}
+		index = zswap->number_entries++;
+	}
+
+	zswap_entry_t *entry = &zswap->entries[index];
+	entry->tag = tag;
+	entry->object = object;
+	entry->length = length;
+	entry->class = class;
+	entry->dirty = dirty;
+	entry->prev = ZSWAP_NONE;
+	entry->next = ZSWAP_NONE;
+	if (class != ZSWAP_NO_CLASS)
+	{
+		entry->prev = zswap->newest;
+		if (entry->prev != ZSWAP_NONE)
+		{
+			zswap->entries[entry->prev].next = index;
+		}
+		else
+		{
+			zswap->oldest = index;
+		}
+		zswap->newest = index;
+	}
+
+	if ((error = hash_map_put(&zswap->index, tag, index)) != SUCCESS)
+	{
+		return error;
+	}
+	zswap->statistics.stored++;
+	*stored = 1;
+	return SUCCESS;
+}
+
+status_t zswap_load(zswap_t *zswap, uint64_t tag, int8_t *contents, uint8_t *found, uint8_t *dirty)
+{
+	uint64_t *index = hash_map_find(&zswap->index, tag);
+	*found = index != NULL;
+	if (index == NULL)
+	{
+		return SUCCESS;
+	}
+
+	int32_t i = *index;
+	zswap_entry_t *entry = &zswap->entries[i];
+	status_t error;
+	if ((error = decompress_entry(zswap, entry, contents)) != SUCCESS)
+	{
+		return error;
+	}
+	*dirty = entry->dirty;
+	remove_entry(zswap, i);
+	zswap->statistics.loads++;
+	return SUCCESS;
+}
+
+status_t zswap_flush(zswap_t *zswap, zswap_write_t write, void *context)
+{
+	size_t i;
+	for (i = 0; i < zswap->index.capacity; i++)
+	{
+		if (zswap->index.keys[i] == HASH_MAP_EMPTY)
+		{
+			continue;
+		}
+
+		zswap_entry_t *entry = &zswap->entries[zswap->index.values[i]];
+		status_t error;
+		if (entry->dirty && ((error = decompress_entry(zswap, entry, zswap->victim)) != SUCCESS ||
+			(error = write(context, entry->tag, zswap->victim)) != SUCCESS))
+		{
+			return error;
+		}
+	}
+
+	return SUCCESS;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint8_t take_object(zswap_t *zswap, uint8_t class, uint32_t *object)
+{
+	int32_t slab = zswap->partial[class];
+	if (slab == ZSWAP_NONE)
+	{
+		if (zswap->number_free_slabs == 0)
+		{
+			return 0;
+		}
+
+		//cut the slab into as many objects of the class as fit, the first of them on top
+		slab = zswap->free_slabs[--zswap->number_free_slabs];
+		zswap->used_slabs++;
+		zswap->slab_class[slab] = class;
+		zswap->live[slab] = 0;
+		zswap->slab_free[slab] = ZSWAP_NONE;
+		size_t object_grains = class + 1;
+		size_t count = zswap->slab_grains / object_grains;
+		while (count-- > 0)
+		{
+			int32_t free_object = slab * zswap->slab_grains + count * object_grains;
+			memcpy(zswap->arena + (size_t) free_object * zswap->grain, &zswap->slab_free[slab], sizeof zswap->slab_free[slab]);
+			zswap->slab_free[slab] = free_object;
+		}
+		link_slab(zswap, slab);
+	}
+
+	*object = zswap->slab_free[slab];
+	memcpy(&zswap->slab_free[slab], zswap->arena + (size_t) *object * zswap->grain, sizeof zswap->slab_free[slab]);
+	zswap->live[slab]++;
+	if (zswap->slab_free[slab] == ZSWAP_NONE)
+	{
+		unlink_slab(zswap, slab);
+	}
+	return 1;
+}
+
+static void free_object(zswap_t *zswap, uint32_t object)
+{
+	int32_t slab = object / zswap->slab_grains;
+	if (zswap->slab_free[slab] == ZSWAP_NONE)
+	{
+		link_slab(zswap, slab);
+	}
+	memcpy(zswap->arena + (size_t) object * zswap->grain, &zswap->slab_free[slab], sizeof zswap->slab_free[slab]);
+	zswap->slab_free[slab] = object;
+
+	if (--zswap->live[slab] == 0)
+	{
+		unlink_slab(zswap, slab);
+		zswap->slab_class[slab] = ZSWAP_NO_CLASS;
+		zswap->free_slabs[zswap->number_free_slabs++] = slab;
+		zswap->used_slabs--;
+	}
+}
+
+static void link_slab(zswap_t *zswap, int32_t slab)
+{
+	uint8_t class = zswap->slab_class[slab];
+	zswap->prev_slab[slab] = ZSWAP_NONE;
+	zswap->next_slab[slab] = zswap->partial[class];
+	if (zswap->partial[class] != ZSWAP_NONE)
+	{
+		zswap->prev_slab[zswap->partial[class]] = slab;
+	}
+	zswap->partial[class] = slab;
+}
+
+static void unlink_slab(zswap_t *zswap, int32_t slab)
+{
+	if (zswap->prev_slab[slab] != ZSWAP_NONE)
+	{
+		zswap->next_slab[zswap->prev_slab[slab]] = zswap->next_slab[slab];
+	}
+	else
+	{
+		zswap->partial[zswap->slab_class[slab]] = zswap->next_slab[slab];
+	}
+	if (zswap->next_slab[slab] != ZSWAP_NONE)
+	{
+		zswap->prev_slab[zswap->next_slab[slab]] = zswap->prev_slab[slab];
+	}
+}
+
+static void remove_entry(zswap_t *zswap, int32_t index)
+{
+	zswap_entry_t *entry = &zswap->entries[index];
+	if (entry->class != ZSWAP_NO_CLASS)
+	{
+		if (entry->prev != ZSWAP_NONE)
+		{
+			zswap->entries[entry->prev].next = entry->next;
+		}
+		else
+		{
+			zswap->oldest = entry->next;
+		}
+		if (entry->next != ZSWAP_NONE)
+		{
+			zswap->entries[entry->next].prev = entry->prev;
+		}
+		else
+		{
+			zswap->newest = entry->prev;
+		}
+		free_object(zswap, entry->object);
+		zswap->used_bytes -= entry->length;
+	}
+
+	hash_map_remove(&zswap->index, entry->tag);
+	entry->next = zswap->free_entries;
+	zswap->free_entries = index;
+}
+
+static status_t decompress_entry(zswap_t *zswap, zswap_entry_t *entry, int8_t *contents)
+{
+	if (entry->class == ZSWAP_NO_CLASS)
+	{
+		memset(contents, entry->object, zswap->page_bytes);
+		return SUCCESS;
+	}
+
+	zswap->statistics.decompressions++;
+	uint64_t start = now_ns();
+	status_t error = zswap->codec->decompress(zswap->arena + (size_t) entry->object * zswap->grain, entry->length, (uint8_t *) contents, zswap->page_bytes);
+	zswap->statistics.decompress_ns += now_ns() - start;
+	return error;
+}